@@ -13,3 +13,27 @@ DEFINE_string(protection_scheme,
               "Specify a protection scheme, 'cenc' or 'cbc1' or pattern-based "
               "protection schemes 'cens' or 'cbcs'.");
 DEFINE_bool(vp9_subsample_encryption, true, "Enable VP9 subsample encryption.");
+DEFINE_int32(num_encryption_workers,
+             0,
+             "Number of threads, shared by all the streams, the 'cenc' "
+             "encryption of large samples, e.g. 4K video key frames, is split "
+             "across. The output is the same as without workers. Samples are "
+             "encrypted on the threads processing the streams only if it is "
+             "0.");
+DEFINE_int32(num_prefetched_crypto_periods,
+             0,
+             "Number of crypto periods after the current one whose keys are "
+             "fetched in the background if key rotation is enabled, so the "
+             "keys are ready when the crypto periods start. Does not apply to "
+             "Widevine key server, which always fetches the keys ahead.");
+DEFINE_string(key_cache_file,
+              "",
+              "File the crypto period keys are saved to if key rotation is "
+              "enabled, and loaded from on start, so a restarted job does "
+              "not fetch them again. The keys are saved in the clear, in a "
+              "file only readable by its owner, and ignored if the key "
+              "source configuration has changed.");
+DEFINE_double(key_cache_ttl,
+              0,
+              "Time in seconds a crypto period key is served from the cache "
+              "after it has been fetched. The keys do not expire if it is 0.");
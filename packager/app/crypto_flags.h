@@ -14,5 +14,9 @@
 
 DECLARE_string(protection_scheme);
 DECLARE_bool(vp9_subsample_encryption);
+DECLARE_int32(num_encryption_workers);
+DECLARE_int32(num_prefetched_crypto_periods);
+DECLARE_string(key_cache_file);
+DECLARE_double(key_cache_ttl);
 
 #endif  // PACKAGER_APP_CRYPTO_FLAGS_H_
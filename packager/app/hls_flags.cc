@@ -24,3 +24,10 @@ DEFINE_string(hls_playlist_type,
               "VOD, EVENT, or LIVE. This defines the EXT-X-PLAYLIST-TYPE in "
               "the HLS specification. For hls_playlist_type of LIVE, "
               "EXT-X-PLAYLIST-TYPE tag is omitted.");
+DEFINE_double(hls_playlist_write_delay,
+              0,
+              "If positive, LIVE and EVENT playlists are written on a "
+              "dedicated thread, coalescing the updates arriving within this "
+              "delay in seconds. Useful with many streams, as the muxers then "
+              "do not wait for the playlists to be written. The playlists are "
+              "written as soon as they are updated if zero.");
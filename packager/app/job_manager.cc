@@ -6,7 +6,11 @@
 
 #include "packager/app/job_manager.h"
 
+#include <algorithm>
+
 #include "packager/app/libcrypto_threading.h"
+#include "packager/app/work_stealing_executor.h"
+#include "packager/base/logging.h"
 #include "packager/media/chunking/sync_point_queue.h"
 #include "packager/media/origin/origin_handler.h"
 
@@ -14,7 +18,7 @@ namespace shaka {
 namespace media {
 
 Job::Job(const std::string& name, std::shared_ptr<OriginHandler> work)
-    : SimpleThread(name),
+    : name_(name),
       work_(std::move(work)),
       wait_(base::WaitableEvent::ResetPolicy::MANUAL,
             base::WaitableEvent::InitialState::NOT_SIGNALED) {
@@ -25,19 +29,26 @@ void Job::Cancel() {
   work_->Cancel();
 }
 
-void Job::Run() {
-  status_ = work_->Run();
-  wait_.Signal();
+bool Job::RunSlice() {
+  bool done = false;
+  status_ = work_->RunSlice(&done);
+  if (!status_.ok())
+    done = true;
+  if (done)
+    wait_.Signal();
+  return done;
 }
 
-JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points)
-    : sync_points_(std::move(sync_points)) {}
+JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points,
+                       size_t max_num_workers)
+    : sync_points_(std::move(sync_points)), max_num_workers_(max_num_workers) {}
+
+JobManager::~JobManager() {}
 
 void JobManager::Add(const std::string& name,
                      std::shared_ptr<OriginHandler> handler) {
   // Stores Job entries for delayed construction of Job objects, to avoid
-  // setting up SimpleThread until we know all workers can be initialized
-  // successfully.
+  // setting up jobs until we know all workers can be initialized successfully.
   job_entries_.push_back({name, std::move(handler)});
 }
 
@@ -55,18 +66,29 @@ Status JobManager::InitializeJobs() {
 }
 
 Status JobManager::RunJobs() {
+  if (jobs_.empty())
+    return Status::OK;
+
+  size_t num_workers = jobs_.size();
+  if (!sync_points_ && max_num_workers_ > 0)
+    num_workers = std::min(num_workers, max_num_workers_);
+  VLOG(1) << "Running " << jobs_.size() << " jobs on " << num_workers
+          << " workers.";
+  executor_.reset(new WorkStealingExecutor(num_workers));
+  executor_->Start();
+
   // We need to store the jobs and the waits separately in order to use the
   // |WaitMany| function. |WaitMany| takes an array of WaitableEvents but we
-  // need to access the jobs in order to join the thread and check the status.
-  // The indexes needs to be check in sync or else we won't be able to relate a
-  // WaitableEvent back to the job.
+  // need to access the jobs in order to check the status. The indexes needs to
+  // be check in sync or else we won't be able to relate a WaitableEvent back
+  // to the job.
   std::vector<Job*> active_jobs;
   std::vector<base::WaitableEvent*> active_waits;
 
-  // Start every job and add it to the active jobs list so that we can wait
+  // Schedule every job and add it to the active jobs list so that we can wait
   // on each one.
   for (auto& job : jobs_) {
-    job->Start();
+    ScheduleJob(job.get());
 
     active_jobs.push_back(job.get());
     active_waits.push_back(job->wait());
@@ -80,8 +102,6 @@ Status JobManager::RunJobs() {
     const size_t done =
         base::WaitableEvent::WaitMany(active_waits.data(), active_waits.size());
     Job* job = active_jobs[done];
-
-    job->Join();
     status.Update(job->status());
 
     // Remove the job and the wait from our tracking.
@@ -98,12 +118,24 @@ Status JobManager::RunJobs() {
   }
 
   for (auto& job : active_jobs) {
-    job->Join();
+    job->wait()->Wait();
   }
 
+  // All jobs are done, so no more slices are posted.
+  executor_->Shutdown();
+  executor_.reset();
   return status;
 }
 
+void JobManager::ScheduleJob(Job* job) {
+  // A job that is not done yet re-posts itself, so other jobs get their turn
+  // on the worker in between its slices.
+  executor_->PostTask([this, job]() {
+    if (!job->RunSlice())
+      ScheduleJob(job);
+  });
+}
+
 void JobManager::CancelJobs() {
   if (sync_points_)
     sync_points_->Cancel();
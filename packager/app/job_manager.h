@@ -8,9 +8,10 @@
 #define PACKAGER_APP_JOB_MANAGER_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
-#include "packager/base/threading/simple_thread.h"
+#include "packager/base/synchronization/waitable_event.h"
 #include "packager/status.h"
 
 namespace shaka {
@@ -18,10 +19,11 @@ namespace media {
 
 class OriginHandler;
 class SyncPointQueue;
+class WorkStealingExecutor;
 
 // A job is a single line of work that is expected to run in parallel with
-// other jobs.
-class Job : public base::SimpleThread {
+// other jobs. It is run in slices, so many jobs can share a few threads.
+class Job {
  public:
   Job(const std::string& name, std::shared_ptr<OriginHandler> work);
 
@@ -38,12 +40,17 @@ class Job : public base::SimpleThread {
   // WaitableEvent you can wait on.
   base::WaitableEvent* wait() { return &wait_; }
 
+  // Run the next slice of the job. Returns true if the job is done, in which
+  // case |wait| is signaled.
+  bool RunSlice();
+
+  const std::string& name() const { return name_; }
+
  private:
   Job(const Job&) = delete;
   Job& operator=(const Job&) = delete;
 
-  void Run() override;
-
+  std::string name_;
   std::shared_ptr<OriginHandler> work_;
   Status status_;
 
@@ -52,13 +59,19 @@ class Job : public base::SimpleThread {
 
 // Similar to a thread pool, JobManager manages multiple jobs that are expected
 // to run in parallel. It can be used to register, run, and stop a batch of
-// jobs.
+// jobs. The jobs are run in slices on a bounded number of worker threads.
 class JobManager {
  public:
   // @param sync_points is an optional SyncPointQueue used to synchronize and
   //        align cue points. JobManager cancels @a sync_points when any job
   //        fails or is cancelled. It can be NULL.
-  explicit JobManager(std::unique_ptr<SyncPointQueue> sync_points);
+  // @param max_num_workers is the maximum number of worker threads running
+  //        the jobs. Jobs blocking on each other, e.g. through @a sync_points,
+  //        need a worker each to make progress, so every job gets its own
+  //        worker if @a sync_points is not NULL or if @a max_num_workers is 0.
+  JobManager(std::unique_ptr<SyncPointQueue> sync_points,
+             size_t max_num_workers);
+  ~JobManager();
 
   // Create a new job entry by specifying the origin handler at the top of the
   // chain and a name for the thread. This will only register the job. To start
@@ -85,6 +98,9 @@ class JobManager {
   JobManager(const JobManager&) = delete;
   JobManager& operator=(const JobManager&) = delete;
 
+  // Post the next slice of |job| to the executor.
+  void ScheduleJob(Job* job);
+
   struct JobEntry {
     std::string name;
     std::shared_ptr<OriginHandler> worker;
@@ -95,6 +111,8 @@ class JobManager {
   // Stored in JobManager so JobManager can cancel |sync_points| when any job
   // fails or is cancelled.
   std::unique_ptr<SyncPointQueue> sync_points_;
+  size_t max_num_workers_;
+  std::unique_ptr<WorkStealingExecutor> executor_;
 };
 
 }  // namespace media
@@ -34,6 +34,7 @@ std::shared_ptr<Muxer> MuxerFactory::CreateMuxer(
   options.temp_dir = temp_dir_;
   options.output_file_name = stream.output;
   options.segment_template = stream.segment_template;
+  options.udp_output = stream.udp_output;
   options.bandwidth = stream.bandwidth;
 
   std::shared_ptr<Muxer> muxer;
@@ -44,6 +44,25 @@ DEFINE_bool(use_fake_clock_for_muxer,
             "Set to true to use a fake clock for muxer. With this flag set, "
             "creation time and modification time in outputs are set to 0. "
             "Should only be used for testing.");
+DEFINE_bool(async_pipeline,
+            false,
+            "Process every stream, and every output of a stream, on its own "
+            "thread, connected through bounded queues. Improves parallelism "
+            "when many outputs are generated from the same input.");
+DEFINE_bool(parallel_demuxing,
+            false,
+            "Demux every stream selected from a local input on its own, so "
+            "the streams of one input are processed in parallel. Each stream "
+            "of a non-fragmented MP4 input then only reads its own chunks, "
+            "while other inputs are read once per stream.");
+DEFINE_int32(max_num_workers,
+             0,
+             "Maximum number of threads running the packaging jobs. Every "
+             "job runs on its own thread if it is 0, which is the default. "
+             "Should not be set below the number of live inputs, e.g. UDP, "
+             "as a job waiting for live data blocks its thread. Does not "
+             "apply with --ad_cues or --async_pipeline, in which case every "
+             "job runs on its own thread.");
 DEFINE_string(test_packager_version,
               "",
               "Packager version for testing. Should be used for testing only.");
@@ -79,6 +98,10 @@ const char kUsage[] =
     "  - output_format (format): Optional value which specifies the format\n"
     "    of the output files (MP4 or WebM).  If not specified, it will be\n"
     "    derived from the file extension of the output file.\n"
+    "  - udp_output (udp): Optional UDP destination, of the form\n"
+    "    udp://ip:port[?options], to which the stream is also sent, paced in\n"
+    "    real time. Only supported for MPEG2-TS output, in addition to the\n"
+    "    segments.\n"
     "  - skip_encryption=0|1: Optional. Defaults to 0 if not specified. If\n"
     "    it is set to 1, no encryption of the stream will be made.\n"
     "  - drm_label: Optional value for custom DRM label, which defines the\n"
@@ -289,6 +312,13 @@ base::Optional<PackagingParams> GetPackagingParams() {
   PackagingParams packaging_params;
 
   packaging_params.temp_dir = FLAGS_temp_dir;
+  packaging_params.async_pipeline = FLAGS_async_pipeline;
+  packaging_params.parallel_demuxing = FLAGS_parallel_demuxing;
+  if (FLAGS_max_num_workers < 0) {
+    LOG(ERROR) << "--max_num_workers should not be negative.";
+    return base::nullopt;
+  }
+  packaging_params.max_num_workers = FLAGS_max_num_workers;
 
   AdCueGeneratorParams& ad_cue_generator_params =
       packaging_params.ad_cue_generator_params;
@@ -335,6 +365,19 @@ base::Optional<PackagingParams> GetPackagingParams() {
     encryption_params.crypto_period_duration_in_seconds =
         FLAGS_crypto_period_duration;
     encryption_params.vp9_subsample_encryption = FLAGS_vp9_subsample_encryption;
+    if (FLAGS_num_encryption_workers < 0) {
+      LOG(ERROR) << "--num_encryption_workers should not be negative.";
+      return base::nullopt;
+    }
+    encryption_params.num_encryption_workers = FLAGS_num_encryption_workers;
+    if (FLAGS_num_prefetched_crypto_periods < 0) {
+      LOG(ERROR) << "--num_prefetched_crypto_periods should not be negative.";
+      return base::nullopt;
+    }
+    encryption_params.num_prefetched_crypto_periods =
+        FLAGS_num_prefetched_crypto_periods;
+    encryption_params.key_cache_file = FLAGS_key_cache_file;
+    encryption_params.key_cache_ttl_in_seconds = FLAGS_key_cache_ttl;
     encryption_params.stream_label_func = std::bind(
         &Packager::DefaultStreamLabelFunction, FLAGS_max_sd_pixels,
         FLAGS_max_hd_pixels, FLAGS_max_uhd1_pixels, std::placeholders::_1);
@@ -457,6 +500,7 @@ base::Optional<PackagingParams> GetPackagingParams() {
   hls_params.preserved_segments_outside_live_window =
       FLAGS_preserved_segments_outside_live_window;
   hls_params.default_language = FLAGS_default_language;
+  hls_params.playlist_write_delay_in_seconds = FLAGS_hls_playlist_write_delay;
 
   TestParams& test_params = packaging_params.test_params;
   test_params.dump_stream_info = FLAGS_dump_stream_info;
@@ -9,10 +9,12 @@
 #include "packager/base/logging.h"
 #include "packager/base/strings/string_number_conversions.h"
 #include "packager/base/strings/string_split.h"
+#include "packager/base/strings/stringprintf.h"
 #include "packager/file/file.h"
 #include "packager/media/base/media_handler.h"
 #include "packager/media/base/muxer_options.h"
 #include "packager/media/base/playready_key_source.h"
+#include "packager/media/base/prefetching_key_source.h"
 #include "packager/media/base/raw_key_source.h"
 #include "packager/media/base/request_signer.h"
 #include "packager/media/base/widevine_key_source.h"
@@ -67,6 +69,56 @@ int GetProtectionSystemsFlag(
   return protection_systems_flags;
 }
 
+// Describes the encryption parameters the crypto period keys depend on, so
+// keys cached with a different configuration are not reused.
+std::string GetKeySourceConfig(FourCC protection_scheme,
+                               int protection_systems_flags,
+                               const EncryptionParams& encryption_params) {
+  std::string config = base::StringPrintf(
+      "provider=%d\nscheme=%u\nsystems=%d\nperiod=%.17g\n",
+      static_cast<int>(encryption_params.key_provider),
+      static_cast<uint32_t>(protection_scheme), protection_systems_flags,
+      encryption_params.crypto_period_duration_in_seconds);
+  switch (encryption_params.key_provider) {
+    case KeyProvider::kWidevine: {
+      const WidevineEncryptionParams& widevine = encryption_params.widevine;
+      config += "server=" + widevine.key_server_url + "\n";
+      config += "content_id=" + base::HexEncode(widevine.content_id.data(),
+                                                widevine.content_id.size());
+      config += "\npolicy=" + widevine.policy + "\n";
+      config += "group_id=" + base::HexEncode(widevine.group_id.data(),
+                                              widevine.group_id.size());
+      config += "\n";
+      break;
+    }
+    case KeyProvider::kPlayReady: {
+      const PlayReadyEncryptionParams& playready = encryption_params.playready;
+      config += "server=" + playready.key_server_url + "\n";
+      config += "program=" + playready.program_identifier + "\n";
+      break;
+    }
+    case KeyProvider::kRawKey: {
+      const RawKeyParams& raw_key = encryption_params.raw_key;
+      for (const auto& entry : raw_key.key_map) {
+        config += "label=" + entry.first + "\n";
+        config += "key_id=" + base::HexEncode(entry.second.key_id.data(),
+                                              entry.second.key_id.size());
+        config += "\nkey=" + base::HexEncode(entry.second.key.data(),
+                                              entry.second.key.size());
+        config += "\n";
+      }
+      config += "iv=" + base::HexEncode(raw_key.iv.data(), raw_key.iv.size());
+      config += "\npssh=" +
+                base::HexEncode(raw_key.pssh.data(), raw_key.pssh.size());
+      config += "\n";
+      break;
+    }
+    case KeyProvider::kNone:
+      break;
+  }
+  return config;
+}
+
 }  // namespace
 
 std::unique_ptr<KeySource> CreateEncryptionKeySource(
@@ -167,6 +219,34 @@ std::unique_ptr<KeySource> CreateEncryptionKeySource(
     case KeyProvider::kNone:
       break;
   }
+  if (encryption_key_source &&
+      encryption_params.crypto_period_duration_in_seconds > 0 &&
+      (encryption_params.num_prefetched_crypto_periods > 0 ||
+       !encryption_params.key_cache_file.empty())) {
+    // WidevineKeySource fetches the crypto period keys ahead itself.
+    const uint32_t num_prefetched_periods =
+        encryption_params.key_provider == KeyProvider::kWidevine
+            ? 0
+            : encryption_params.num_prefetched_crypto_periods;
+    std::unique_ptr<PrefetchingKeySource> prefetching_key_source(
+        new PrefetchingKeySource(std::move(encryption_key_source),
+                                 num_prefetched_periods));
+    if (encryption_params.key_cache_ttl_in_seconds > 0) {
+      prefetching_key_source->set_key_ttl(base::TimeDelta::FromSecondsD(
+          encryption_params.key_cache_ttl_in_seconds));
+    }
+    if (!encryption_params.key_cache_file.empty()) {
+      Status status = prefetching_key_source->SetCacheFile(
+          encryption_params.key_cache_file,
+          GetKeySourceConfig(protection_scheme, protection_systems_flags,
+                             encryption_params));
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to load the key cache: " << status.ToString();
+        return nullptr;
+      }
+    }
+    encryption_key_source = std::move(prefetching_key_source);
+  }
   return encryption_key_source;
 }
 
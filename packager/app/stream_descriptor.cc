@@ -30,6 +30,7 @@ enum FieldType {
   kTrickPlayFactorField,
   kSkipEncryptionField,
   kDrmStreamLabelField,
+  kUdpOutputField,
 };
 
 struct FieldNameToTypeMapping {
@@ -63,6 +64,8 @@ const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
     {"skip_encryption", kSkipEncryptionField},
     {"drm_stream_label", kDrmStreamLabelField},
     {"drm_label", kDrmStreamLabelField},
+    {"udp_output", kUdpOutputField},
+    {"udp", kUdpOutputField},
 };
 
 FieldType GetFieldType(const std::string& field_name) {
@@ -168,6 +171,10 @@ base::Optional<StreamDescriptor> ParseStreamDescriptor(
         descriptor.drm_label = iter->second;
         break;
       }
+      case kUdpOutputField: {
+        descriptor.udp_output = iter->second;
+        break;
+      }
       default:
         LOG(ERROR) << "Unknown field in stream descriptor (\"" << iter->first
                    << "\").";
@@ -0,0 +1,151 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/app/work_stealing_executor.h"
+
+#include "packager/base/logging.h"
+#include "packager/base/strings/stringprintf.h"
+#include "packager/base/threading/simple_thread.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+// The executor and the worker index of the current thread, if it is a worker.
+thread_local const WorkStealingExecutor* g_current_executor = nullptr;
+thread_local size_t g_current_worker_index = 0;
+
+}  // namespace
+
+class WorkStealingExecutor::Worker : public base::SimpleThread {
+ public:
+  Worker(WorkStealingExecutor* executor, size_t worker_index)
+      : SimpleThread(base::StringPrintf("Worker %zu", worker_index)),
+        executor_(executor),
+        worker_index_(worker_index) {}
+
+ private:
+  Worker(const Worker&) = delete;
+  Worker& operator=(const Worker&) = delete;
+
+  void Run() override {
+    g_current_executor = executor_;
+    g_current_worker_index = worker_index_;
+    executor_->RunWorker(worker_index_);
+    g_current_executor = nullptr;
+  }
+
+  WorkStealingExecutor* executor_;
+  size_t worker_index_;
+};
+
+WorkStealingExecutor::WorkStealingExecutor(size_t num_workers)
+    : task_available_(&idle_lock_), next_queue_index_(0) {
+  CHECK_GT(num_workers, 0u);
+  for (size_t i = 0; i < num_workers; ++i) {
+    task_queues_.emplace_back(new TaskQueue);
+    workers_.emplace_back(new Worker(this, i));
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  Shutdown();
+}
+
+void WorkStealingExecutor::Start() {
+  DCHECK(!started_);
+  started_ = true;
+  for (auto& worker : workers_)
+    worker->Start();
+}
+
+void WorkStealingExecutor::PostTask(const Task& task) {
+  size_t queue_index = 0;
+  if (g_current_executor == this) {
+    queue_index = g_current_worker_index;
+  } else {
+    queue_index = next_queue_index_++ % task_queues_.size();
+  }
+
+  TaskQueue* task_queue = task_queues_[queue_index].get();
+  {
+    base::AutoLock auto_lock(task_queue->lock);
+    task_queue->tasks.push_back(task);
+  }
+
+  base::AutoLock auto_lock(idle_lock_);
+  ++num_pending_tasks_;
+  if (num_idle_workers_ > 0)
+    task_available_.Signal();
+}
+
+void WorkStealingExecutor::Shutdown() {
+  {
+    base::AutoLock auto_lock(idle_lock_);
+    if (shutting_down_)
+      return;
+    shutting_down_ = true;
+    task_available_.Broadcast();
+  }
+  if (!started_)
+    return;
+  for (auto& worker : workers_)
+    worker->Join();
+}
+
+void WorkStealingExecutor::RunWorker(size_t worker_index) {
+  while (true) {
+    Task task;
+    if (TakeTask(worker_index, &task)) {
+      {
+        base::AutoLock auto_lock(idle_lock_);
+        --num_pending_tasks_;
+      }
+      task();
+      continue;
+    }
+
+    base::AutoLock auto_lock(idle_lock_);
+    while (num_pending_tasks_ <= 0 && !shutting_down_) {
+      ++num_idle_workers_;
+      task_available_.Wait();
+      --num_idle_workers_;
+    }
+    // The tasks are drained before exiting. A task still running on another
+    // worker posts its follow-up tasks to its own queue, which that worker
+    // picks up itself.
+    if (num_pending_tasks_ <= 0 && shutting_down_)
+      return;
+  }
+}
+
+bool WorkStealingExecutor::TakeTask(size_t worker_index, Task* task) {
+  DCHECK(task);
+  {
+    TaskQueue* own_queue = task_queues_[worker_index].get();
+    base::AutoLock auto_lock(own_queue->lock);
+    if (!own_queue->tasks.empty()) {
+      *task = std::move(own_queue->tasks.front());
+      own_queue->tasks.pop_front();
+      return true;
+    }
+  }
+  const size_t num_queues = task_queues_.size();
+  for (size_t i = 1; i < num_queues; ++i) {
+    TaskQueue* victim_queue =
+        task_queues_[(worker_index + i) % num_queues].get();
+    base::AutoLock auto_lock(victim_queue->lock);
+    if (!victim_queue->tasks.empty()) {
+      *task = std::move(victim_queue->tasks.back());
+      victim_queue->tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace media
+}  // namespace shaka
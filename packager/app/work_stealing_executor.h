@@ -0,0 +1,89 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_WORK_STEALING_EXECUTOR_H_
+#define PACKAGER_APP_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+
+namespace shaka {
+namespace media {
+
+// Runs tasks on a fixed number of worker threads. Every worker has its own
+// task queue. Tasks posted from a worker go to that worker's queue, other
+// tasks are distributed to the workers round robin. A worker takes tasks from
+// the front of its own queue, so tasks that re-post themselves are interleaved
+// fairly, and steals from the back of the other workers' queues when its own
+// queue is empty.
+class WorkStealingExecutor {
+ public:
+  typedef std::function<void()> Task;
+
+  // @param num_workers is the number of worker threads. It must be positive.
+  explicit WorkStealingExecutor(size_t num_workers);
+  // Waits for all posted tasks to complete, see |Shutdown|.
+  ~WorkStealingExecutor();
+
+  // Start the worker threads.
+  void Start();
+
+  // Schedule |task| to run on one of the workers. Can be called from any
+  // thread, including from a running task.
+  void PostTask(const Task& task);
+
+  // Wait for all posted tasks, including the tasks posted by running tasks,
+  // to complete and then join the worker threads. Tasks must not be posted
+  // from outside the workers once this is called.
+  void Shutdown();
+
+  size_t num_workers() const { return workers_.size(); }
+
+ private:
+  WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+  WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+  class Worker;
+
+  struct TaskQueue {
+    base::Lock lock;
+    std::deque<Task> tasks;
+  };
+
+  // The main loop of the worker at |worker_index|.
+  void RunWorker(size_t worker_index);
+  // Take a task from the worker's own queue or steal one from the other
+  // workers. Returns false if all queues are empty.
+  bool TakeTask(size_t worker_index, Task* task);
+
+  std::vector<std::unique_ptr<TaskQueue>> task_queues_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Protects the members below, which are used to put idle workers to sleep
+  // and to wake them up.
+  base::Lock idle_lock_;
+  base::ConditionVariable task_available_;
+  // Number of tasks posted but not taken. It can be transiently negative, as
+  // a task can be taken before the poster accounts for it.
+  int64_t num_pending_tasks_ = 0;
+  size_t num_idle_workers_ = 0;
+  bool started_ = false;
+  bool shutting_down_ = false;
+
+  // The queue for the next task posted from outside the workers.
+  std::atomic<size_t> next_queue_index_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,79 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/app/work_stealing_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+
+#include "packager/base/synchronization/waitable_event.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kNumWorkers = 4;
+
+}  // namespace
+
+TEST(WorkStealingExecutorTest, RunsAllTasks) {
+  const int kNumTasks = 1000;
+  std::atomic<int> num_tasks_run(0);
+
+  WorkStealingExecutor executor(kNumWorkers);
+  executor.Start();
+  for (int i = 0; i < kNumTasks; ++i)
+    executor.PostTask([&num_tasks_run]() { ++num_tasks_run; });
+  executor.Shutdown();
+
+  EXPECT_EQ(kNumTasks, num_tasks_run.load());
+}
+
+// Tasks re-posting themselves, like the sliced jobs in JobManager, run to
+// completion before Shutdown returns.
+TEST(WorkStealingExecutorTest, RunsTasksPostedFromTasks) {
+  const int kNumChains = 10;
+  const int kNumSlicesPerChain = 100;
+  std::atomic<int> num_slices_run(0);
+
+  WorkStealingExecutor executor(kNumWorkers);
+  std::function<void(int)> run_slice = [&](int remaining_slices) {
+    ++num_slices_run;
+    if (remaining_slices > 1)
+      executor.PostTask(std::bind(run_slice, remaining_slices - 1));
+  };
+  executor.Start();
+  for (int i = 0; i < kNumChains; ++i)
+    executor.PostTask(std::bind(run_slice, kNumSlicesPerChain));
+  executor.Shutdown();
+
+  EXPECT_EQ(kNumChains * kNumSlicesPerChain, num_slices_run.load());
+}
+
+// An idle worker steals a task queued behind a blocked task.
+TEST(WorkStealingExecutorTest, StealsFromBlockedWorker) {
+  base::WaitableEvent unblock(base::WaitableEvent::ResetPolicy::MANUAL,
+                              base::WaitableEvent::InitialState::NOT_SIGNALED);
+  base::WaitableEvent stolen(base::WaitableEvent::ResetPolicy::MANUAL,
+                             base::WaitableEvent::InitialState::NOT_SIGNALED);
+
+  WorkStealingExecutor executor(2);
+  executor.Start();
+  executor.PostTask([&]() {
+    // Queued on the same worker as this task, which does not take it until
+    // the other worker has run it.
+    executor.PostTask([&stolen]() { stolen.Signal(); });
+    unblock.Wait();
+  });
+  stolen.Wait();
+  unblock.Signal();
+  executor.Shutdown();
+}
+
+}  // namespace media
+}  // namespace shaka
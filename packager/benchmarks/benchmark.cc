@@ -0,0 +1,180 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/benchmarks/benchmark.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+
+#include "packager/base/logging.h"
+#include "packager/base/strings/stringprintf.h"
+#include "packager/base/sys_info.h"
+
+namespace shaka {
+namespace benchmark {
+namespace {
+
+struct RegisteredBenchmark {
+  std::string name;
+  BenchmarkFunction function;
+};
+
+std::vector<RegisteredBenchmark>* GetRegisteredBenchmarks() {
+  static std::vector<RegisteredBenchmark>* benchmarks =
+      new std::vector<RegisteredBenchmark>;
+  return benchmarks;
+}
+
+std::string EscapeJsonString(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += base::StringPrintf("\\u%04x", c);
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+State::State(base::TimeDelta min_time) : min_time_(min_time) {}
+
+bool State::KeepRunning() {
+  if (!running_) {
+    if (iterations_ > 0 || !error_.empty())
+      return false;
+    running_ = true;
+    start_time_ = base::TimeTicks::Now();
+    iterations_ = 1;
+    return true;
+  }
+  elapsed_ = base::TimeTicks::Now() - start_time_;
+  if (elapsed_ >= min_time_ || !error_.empty()) {
+    running_ = false;
+    return false;
+  }
+  ++iterations_;
+  return true;
+}
+
+void State::SkipWithError(const std::string& error) {
+  error_ = error;
+  running_ = false;
+}
+
+BenchmarkRegistrar::BenchmarkRegistrar(const char* name,
+                                       BenchmarkFunction function) {
+  GetRegisteredBenchmarks()->push_back({name, function});
+}
+
+std::vector<BenchmarkResult> RunBenchmarks(const std::string& filter,
+                                           base::TimeDelta min_time) {
+  std::vector<RegisteredBenchmark> benchmarks = *GetRegisteredBenchmarks();
+  std::sort(benchmarks.begin(), benchmarks.end(),
+            [](const RegisteredBenchmark& a, const RegisteredBenchmark& b) {
+              return a.name < b.name;
+            });
+
+  std::vector<BenchmarkResult> results;
+  for (const RegisteredBenchmark& benchmark : benchmarks) {
+    if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+      continue;
+    VLOG(1) << "Running " << benchmark.name;
+
+    State state(min_time);
+    benchmark.function(&state);
+
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.iterations = state.iterations();
+    result.error = state.error();
+    if (result.error.empty() && state.iterations() == 0)
+      result.error = "The benchmark did not run any iteration.";
+    const double seconds = state.elapsed().InSecondsF();
+    if (result.error.empty() && seconds > 0) {
+      result.nanoseconds_per_iteration =
+          seconds * base::Time::kNanosecondsPerSecond / state.iterations();
+      result.bytes_per_second = state.bytes_processed() / seconds;
+      result.items_per_second = state.items_processed() / seconds;
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
+std::string ResultsToJson(const std::vector<BenchmarkResult>& results) {
+  std::string json = "{\n";
+  base::StringAppendF(&json,
+                      "  \"context\": {\n"
+                      "    \"num_cpus\": %d,\n"
+                      "    \"library_build_type\": \"%s\"\n"
+                      "  },\n",
+                      base::SysInfo::NumberOfProcessors(),
+#if defined(NDEBUG)
+                      "release"
+#else
+                      "debug"
+#endif
+                      );
+  json += "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    json += i == 0 ? "\n" : ",\n";
+    base::StringAppendF(&json, "    {\n      \"name\": \"%s\",\n",
+                        EscapeJsonString(result.name).c_str());
+    if (!result.error.empty()) {
+      base::StringAppendF(&json,
+                          "      \"error_occurred\": true,\n"
+                          "      \"error_message\": \"%s\"\n    }",
+                          EscapeJsonString(result.error).c_str());
+      continue;
+    }
+    base::StringAppendF(
+        &json,
+        "      \"iterations\": %" PRId64 ",\n"
+        "      \"real_time\": %.1f,\n"
+        "      \"time_unit\": \"ns\",\n"
+        "      \"bytes_per_second\": %.1f,\n"
+        "      \"items_per_second\": %.1f\n    }",
+        result.iterations, result.nanoseconds_per_iteration,
+        result.bytes_per_second, result.items_per_second);
+  }
+  json += "\n  ]\n}\n";
+  return json;
+}
+
+std::string ResultsToText(const std::vector<BenchmarkResult>& results) {
+  size_t name_width = 10;
+  for (const BenchmarkResult& result : results)
+    name_width = std::max(name_width, result.name.size());
+
+  std::string text = base::StringPrintf(
+      "%-*s %14s %12s %12s %14s\n", static_cast<int>(name_width), "Benchmark",
+      "Time (ns)", "Iterations", "MB/s", "Items/s");
+  for (const BenchmarkResult& result : results) {
+    if (!result.error.empty()) {
+      base::StringAppendF(&text, "%-*s ERROR: %s\n",
+                          static_cast<int>(name_width), result.name.c_str(),
+                          result.error.c_str());
+      continue;
+    }
+    base::StringAppendF(&text, "%-*s %14.0f %12" PRId64 " %12.1f %14.0f\n",
+                        static_cast<int>(name_width), result.name.c_str(),
+                        result.nanoseconds_per_iteration, result.iterations,
+                        result.bytes_per_second / (1 << 20),
+                        result.items_per_second);
+  }
+  return text;
+}
+
+}  // namespace benchmark
+}  // namespace shaka
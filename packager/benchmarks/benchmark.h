@@ -0,0 +1,106 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_BENCHMARKS_BENCHMARK_H_
+#define PACKAGER_BENCHMARKS_BENCHMARK_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "packager/base/time/time.h"
+
+namespace shaka {
+namespace benchmark {
+
+/// Timing state of a running benchmark. A benchmark function does its setup,
+/// runs the measured code in a `while (state->KeepRunning())` loop and then
+/// reports the amount of work done, e.g.
+///
+///   void BM_Foo(State* state) {
+///     std::vector<uint8_t> data = CreateData();
+///     while (state->KeepRunning())
+///       Foo(data);
+///     state->SetBytesProcessed(state->iterations() * data.size());
+///   }
+///   BENCHMARK(BM_Foo);
+class State {
+ public:
+  explicit State(base::TimeDelta min_time);
+
+  /// @return true if the measured code should run one more iteration. The
+  ///         clock starts on the first call and stops once it returns false.
+  bool KeepRunning();
+
+  /// Report an error, which fails the benchmark. The benchmark function
+  /// should return after calling it.
+  void SkipWithError(const std::string& error);
+
+  /// @name Work done in all the iterations, used to compute the throughput.
+  /// @{
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+  void SetItemsProcessed(int64_t items) { items_processed_ = items; }
+  /// @}
+
+  int64_t iterations() const { return iterations_; }
+  base::TimeDelta elapsed() const { return elapsed_; }
+  int64_t bytes_processed() const { return bytes_processed_; }
+  int64_t items_processed() const { return items_processed_; }
+  const std::string& error() const { return error_; }
+
+ private:
+  State(const State&) = delete;
+  State& operator=(const State&) = delete;
+
+  const base::TimeDelta min_time_;
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int64_t iterations_ = 0;
+  bool running_ = false;
+  int64_t bytes_processed_ = 0;
+  int64_t items_processed_ = 0;
+  std::string error_;
+};
+
+typedef void (*BenchmarkFunction)(State* state);
+
+/// Registers a benchmark function at static initialization time. Use the
+/// BENCHMARK macro instead of instantiating it directly.
+class BenchmarkRegistrar {
+ public:
+  BenchmarkRegistrar(const char* name, BenchmarkFunction function);
+};
+
+/// Result of a benchmark run.
+struct BenchmarkResult {
+  std::string name;
+  int64_t iterations = 0;
+  double nanoseconds_per_iteration = 0;
+  /// Throughput, or 0 if the benchmark did not report the work done.
+  double bytes_per_second = 0;
+  double items_per_second = 0;
+  std::string error;
+};
+
+/// Run the registered benchmarks with a name containing |filter|, or all of
+/// them if |filter| is empty, each for at least |min_time|.
+std::vector<BenchmarkResult> RunBenchmarks(const std::string& filter,
+                                           base::TimeDelta min_time);
+
+/// @return |results| formatted as a JSON document.
+std::string ResultsToJson(const std::vector<BenchmarkResult>& results);
+/// @return |results| formatted as a human readable table.
+std::string ResultsToText(const std::vector<BenchmarkResult>& results);
+
+}  // namespace benchmark
+}  // namespace shaka
+
+#define BENCHMARK(function)                                            \
+  static ::shaka::benchmark::BenchmarkRegistrar function##_registrar( \
+      #function, function)
+
+#endif  // PACKAGER_BENCHMARKS_BENCHMARK_H_
@@ -0,0 +1,81 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <gflags/gflags.h>
+
+#include <iostream>
+
+#include "packager/base/command_line.h"
+#include "packager/base/logging.h"
+#include "packager/benchmarks/benchmark.h"
+#include "packager/file/file.h"
+
+DEFINE_string(benchmark_filter,
+              "",
+              "Only run the benchmarks with a name containing this string.");
+DEFINE_double(benchmark_min_time,
+              0.5,
+              "Minimum time in seconds to run each benchmark for.");
+DEFINE_string(benchmark_format,
+              "console",
+              "Format of the results printed to stdout: 'console' or 'json'.");
+DEFINE_string(benchmark_out,
+              "",
+              "If set, the results are also written to this file in JSON.");
+
+namespace shaka {
+namespace benchmark {
+namespace {
+
+const char kUsage[] =
+    "Runs the packager benchmarks.\n\n"
+    "Usage: %s [flags]\n\n"
+    "The end-to-end benchmarks read the test media in packager/media/test/data "
+    "and are expected to run from the packager repository root.";
+
+int BenchmarkMain(int argc, char** argv) {
+  base::CommandLine::Init(argc, argv);
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LOG_TO_SYSTEM_DEBUG_LOG;
+  CHECK(logging::InitLogging(log_settings));
+
+  google::SetUsageMessage(kUsage);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_benchmark_format != "console" && FLAGS_benchmark_format != "json") {
+    LOG(ERROR) << "--benchmark_format should be 'console' or 'json'.";
+    return 1;
+  }
+  if (FLAGS_benchmark_min_time <= 0) {
+    LOG(ERROR) << "--benchmark_min_time should be positive.";
+    return 1;
+  }
+
+  const std::vector<BenchmarkResult> results = RunBenchmarks(
+      FLAGS_benchmark_filter,
+      base::TimeDelta::FromSecondsD(FLAGS_benchmark_min_time));
+  const std::string json = ResultsToJson(results);
+  std::cout << (FLAGS_benchmark_format == "json" ? json
+                                                  : ResultsToText(results));
+  if (!FLAGS_benchmark_out.empty() &&
+      !File::WriteStringToFile(FLAGS_benchmark_out.c_str(), json)) {
+    LOG(ERROR) << "Failed to write " << FLAGS_benchmark_out;
+    return 1;
+  }
+
+  for (const BenchmarkResult& result : results) {
+    if (!result.error.empty())
+      return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace shaka
+
+int main(int argc, char** argv) {
+  return shaka::benchmark::BenchmarkMain(argc, argv);
+}
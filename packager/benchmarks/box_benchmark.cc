@@ -0,0 +1,90 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/benchmarks/benchmark.h"
+#include "packager/media/base/buffer_writer.h"
+#include "packager/media/formats/mp4/box_definitions.h"
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+using benchmark::State;
+
+// Two seconds of 60 fps video.
+const uint32_t kNumSamples = 120;
+// An hour of two-second subsegments.
+const uint32_t kNumReferences = 1800;
+
+MovieFragment CreateMovieFragment() {
+  MovieFragment moof;
+  moof.header.sequence_number = 1;
+  moof.tracks.resize(1);
+  TrackFragment& traf = moof.tracks[0];
+  traf.header.track_id = 1;
+  traf.header.flags = TrackFragmentHeader::kDefaultBaseIsMoofMask;
+  traf.decode_time.decode_time = 90000;
+  traf.runs.resize(1);
+  TrackFragmentRun& trun = traf.runs[0];
+  trun.flags = TrackFragmentRun::kDataOffsetPresentMask |
+               TrackFragmentRun::kSampleDurationPresentMask |
+               TrackFragmentRun::kSampleSizePresentMask |
+               TrackFragmentRun::kSampleFlagsPresentMask |
+               TrackFragmentRun::kSampleCompTimeOffsetsPresentMask;
+  trun.sample_count = kNumSamples;
+  for (uint32_t i = 0; i < kNumSamples; ++i) {
+    trun.sample_durations.push_back(1500);
+    trun.sample_sizes.push_back(i == 0 ? 60000 : 8000 + i);
+    trun.sample_flags.push_back(
+        i == 0 ? 0 : TrackFragmentHeader::kNonKeySampleMask);
+    trun.sample_composition_time_offsets.push_back((i % 3) * 1500);
+  }
+  return moof;
+}
+
+SegmentIndex CreateSegmentIndex() {
+  SegmentIndex sidx;
+  sidx.reference_id = 1;
+  sidx.timescale = 90000;
+  sidx.references.resize(kNumReferences);
+  for (SegmentReference& reference : sidx.references) {
+    reference.referenced_size = 1000000;
+    reference.subsegment_duration = 180000;
+    reference.starts_with_sap = true;
+    reference.sap_type = SegmentReference::Type1;
+  }
+  return sidx;
+}
+
+void BM_MovieFragmentWrite(State* state) {
+  MovieFragment moof = CreateMovieFragment();
+  BufferWriter writer;
+  while (state->KeepRunning()) {
+    writer.Clear();
+    moof.Write(&writer);
+  }
+  state->SetBytesProcessed(state->iterations() * writer.Size());
+  state->SetItemsProcessed(state->iterations() * kNumSamples);
+}
+BENCHMARK(BM_MovieFragmentWrite);
+
+void BM_SegmentIndexWrite(State* state) {
+  SegmentIndex sidx = CreateSegmentIndex();
+  BufferWriter writer;
+  while (state->KeepRunning()) {
+    writer.Clear();
+    sidx.Write(&writer);
+  }
+  state->SetBytesProcessed(state->iterations() * writer.Size());
+  state->SetItemsProcessed(state->iterations() * kNumReferences);
+}
+BENCHMARK(BM_SegmentIndexWrite);
+
+}  // namespace
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,122 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <vector>
+
+#include "packager/benchmarks/benchmark.h"
+#include "packager/media/base/bit_reader.h"
+#include "packager/media/codecs/h26x_bit_reader.h"
+#include "packager/media/codecs/nalu_reader.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+using benchmark::State;
+
+const size_t kBufferSize = 4 << 20;
+
+// Creates a buffer of pseudo-random non-zero bytes with a four-byte start code
+// every |nalu_size| bytes, or none if |nalu_size| is 0.
+std::vector<uint8_t> CreateAnnexBBuffer(size_t nalu_size) {
+  std::vector<uint8_t> buffer(kBufferSize);
+  uint32_t seed = 1;
+  for (uint8_t& byte : buffer) {
+    seed = seed * 1103515245 + 12345;
+    byte = static_cast<uint8_t>((seed >> 16) % 255 + 1);
+  }
+  if (nalu_size > 0) {
+    for (size_t i = 0; i + 5 <= buffer.size(); i += nalu_size) {
+      buffer[i] = buffer[i + 1] = buffer[i + 2] = 0x00;
+      buffer[i + 3] = 0x01;
+      // A non-IDR slice NAL unit header.
+      buffer[i + 4] = 0x41;
+    }
+  }
+  return buffer;
+}
+
+void BM_BitReaderReadBits(State* state) {
+  const std::vector<uint8_t> buffer = CreateAnnexBBuffer(0);
+  uint64_t sum = 0;
+  while (state->KeepRunning()) {
+    BitReader reader(buffer.data(), buffer.size());
+    uint32_t value = 0;
+    while (reader.ReadBits(13, &value))
+      sum += value;
+  }
+  state->SetBytesProcessed(state->iterations() * buffer.size());
+  if (sum == 0)
+    state->SkipWithError("Unexpected data.");
+}
+BENCHMARK(BM_BitReaderReadBits);
+
+void BM_H26xBitReaderReadUE(State* state) {
+  const std::vector<uint8_t> buffer = CreateAnnexBBuffer(0);
+  int64_t num_codes = 0;
+  while (state->KeepRunning()) {
+    H26xBitReader reader;
+    if (!reader.Initialize(buffer.data(), buffer.size())) {
+      state->SkipWithError("Failed to initialize the reader.");
+      return;
+    }
+    int value = 0;
+    while (reader.ReadUE(&value))
+      ++num_codes;
+  }
+  state->SetBytesProcessed(state->iterations() * buffer.size());
+  state->SetItemsProcessed(num_codes);
+}
+BENCHMARK(BM_H26xBitReaderReadUE);
+
+// Scans for start codes the way EsParserH26x does.
+void RunFindStartCode(size_t nalu_size, State* state) {
+  const std::vector<uint8_t> buffer = CreateAnnexBBuffer(nalu_size);
+  int64_t num_start_codes = 0;
+  while (state->KeepRunning()) {
+    const uint8_t* data = buffer.data();
+    uint64_t data_size = buffer.size();
+    uint64_t offset = 0;
+    uint8_t start_code_size = 0;
+    while (NaluReader::FindStartCode(data, data_size, &offset,
+                                     &start_code_size)) {
+      ++num_start_codes;
+      data += offset + start_code_size;
+      data_size -= offset + start_code_size;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * buffer.size());
+  state->SetItemsProcessed(num_start_codes);
+}
+
+void BM_FindStartCodeNoStartCode(State* state) {
+  RunFindStartCode(0, state);
+}
+BENCHMARK(BM_FindStartCodeNoStartCode);
+
+void BM_FindStartCodeSmallNalus(State* state) {
+  RunFindStartCode(188, state);
+}
+BENCHMARK(BM_FindStartCodeSmallNalus);
+
+void BM_NaluReaderAdvanceAnnexB(State* state) {
+  const std::vector<uint8_t> buffer = CreateAnnexBBuffer(16 * 1024);
+  int64_t num_nalus = 0;
+  while (state->KeepRunning()) {
+    NaluReader reader(Nalu::kH264, kIsAnnexbByteStream, buffer.data(),
+                      buffer.size());
+    Nalu nalu;
+    while (reader.Advance(&nalu) == NaluReader::kOk)
+      ++num_nalus;
+  }
+  state->SetBytesProcessed(state->iterations() * buffer.size());
+  state->SetItemsProcessed(num_nalus);
+}
+BENCHMARK(BM_NaluReaderAdvanceAnnexB);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
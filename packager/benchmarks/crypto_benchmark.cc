@@ -0,0 +1,75 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "packager/benchmarks/benchmark.h"
+#include "packager/media/base/aes_encryptor.h"
+#include "packager/media/base/aes_pattern_cryptor.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+using benchmark::State;
+
+// A typical video sample size.
+const size_t kSampleSize = 64 * 1024;
+const uint8_t kKey[] = {
+    0x6f, 0xc9, 0x6f, 0xe6, 0x28, 0xa2, 0x65, 0xb1,
+    0x3a, 0xed, 0xde, 0xc0, 0xbc, 0x42, 0x1f, 0x4d,
+};
+const uint8_t kIv[] = {
+    0x3b, 0x9f, 0x4d, 0x60, 0x6e, 0x17, 0x5a, 0x02,
+    0x95, 0x20, 0x2e, 0xd3, 0x75, 0x83, 0x82, 0xcd,
+};
+
+// Encrypts |kSampleSize| bytes in place per iteration.
+void RunCryptor(AesCryptor* cryptor, State* state) {
+  if (!cryptor->InitializeWithIv(
+          std::vector<uint8_t>(std::begin(kKey), std::end(kKey)),
+          std::vector<uint8_t>(std::begin(kIv), std::end(kIv)))) {
+    state->SkipWithError("Failed to initialize the cryptor.");
+    return;
+  }
+  std::vector<uint8_t> sample(kSampleSize, 0x5a);
+  while (state->KeepRunning()) {
+    if (!cryptor->Crypt(sample.data(), sample.size(), sample.data())) {
+      state->SkipWithError("Failed to encrypt.");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * kSampleSize);
+  state->SetItemsProcessed(state->iterations());
+}
+
+void BM_AesCtrEncryptor(State* state) {
+  AesCtrEncryptor encryptor;
+  RunCryptor(&encryptor, state);
+}
+BENCHMARK(BM_AesCtrEncryptor);
+
+void BM_AesCbcEncryptor(State* state) {
+  AesCbcEncryptor encryptor(kNoPadding);
+  RunCryptor(&encryptor, state);
+}
+BENCHMARK(BM_AesCbcEncryptor);
+
+// 'cbcs' pattern encryption, 1 of every 10 blocks encrypted.
+void BM_AesPatternCbcsEncryptor(State* state) {
+  AesPatternCryptor encryptor(
+      1, 9, AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCbcEncryptor(kNoPadding)));
+  RunCryptor(&encryptor, state);
+}
+BENCHMARK(BM_AesPatternCbcsEncryptor);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,122 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <string>
+
+#include "packager/base/strings/stringprintf.h"
+#include "packager/benchmarks/benchmark.h"
+#include "packager/file/file.h"
+#include "packager/hls/base/media_playlist.h"
+#include "packager/mpd/base/adaptation_set.h"
+#include "packager/mpd/base/media_info.pb.h"
+#include "packager/mpd/base/mpd_builder.h"
+#include "packager/mpd/base/mpd_options.h"
+#include "packager/mpd/base/period.h"
+#include "packager/mpd/base/representation.h"
+
+namespace shaka {
+namespace {
+
+using benchmark::State;
+
+const uint32_t kTimeScale = 90000;
+const int kNumRepresentations = 4;
+// An hour of two-second segments.
+const int kNumSegments = 1800;
+const uint64_t kSegmentSize = 1000000;
+
+MediaInfo CreateVideoMediaInfo(int representation_index) {
+  MediaInfo media_info;
+  media_info.set_bandwidth(1000000 * (representation_index + 1));
+  media_info.set_reference_time_scale(kTimeScale);
+  media_info.set_container_type(MediaInfo::CONTAINER_MP4);
+  media_info.set_init_segment_url(
+      base::StringPrintf("video_%d_init.mp4", representation_index));
+  media_info.set_segment_template_url(
+      base::StringPrintf("video_%d_$Number$.m4s", representation_index));
+  MediaInfo::VideoInfo* video_info = media_info.mutable_video_info();
+  video_info->set_codec("avc1.64001f");
+  video_info->set_width(640 * (representation_index + 1));
+  video_info->set_height(360 * (representation_index + 1));
+  video_info->set_time_scale(kTimeScale);
+  video_info->set_frame_duration(3000);
+  video_info->set_pixel_width(1);
+  video_info->set_pixel_height(1);
+  return media_info;
+}
+
+// Every tenth segment is a bit shorter so the SegmentTimeline does not
+// collapse into a single entry.
+int64_t GetSegmentDuration(int segment_index) {
+  return segment_index % 10 == 9 ? 2 * kTimeScale - 3000 : 2 * kTimeScale;
+}
+
+void BM_MpdBuilderLiveToString(State* state) {
+  MpdOptions mpd_options;
+  mpd_options.dash_profile = DashProfile::kLive;
+  mpd_options.mpd_type = MpdType::kDynamic;
+  MpdBuilder mpd_builder(mpd_options);
+  Period* period = mpd_builder.GetOrCreatePeriod(0);
+  for (int i = 0; i < kNumRepresentations; ++i) {
+    const MediaInfo media_info = CreateVideoMediaInfo(i);
+    AdaptationSet* adaptation_set = period->GetOrCreateAdaptationSet(
+        media_info, true /* content_protection_in_adaptation_set */);
+    Representation* representation =
+        adaptation_set->AddRepresentation(media_info);
+    int64_t start_time = 0;
+    for (int j = 0; j < kNumSegments; ++j) {
+      representation->AddNewSegment(start_time, GetSegmentDuration(j),
+                                    kSegmentSize);
+      start_time += GetSegmentDuration(j);
+    }
+  }
+
+  std::string mpd;
+  while (state->KeepRunning()) {
+    if (!mpd_builder.ToString(&mpd)) {
+      state->SkipWithError("Failed to generate the MPD.");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * mpd.size());
+  state->SetItemsProcessed(state->iterations() * kNumRepresentations *
+                           kNumSegments);
+}
+BENCHMARK(BM_MpdBuilderLiveToString);
+
+void BM_HlsMediaPlaylistWriteToFile(State* state) {
+  const char kPlaylistFileName[] = "memory://benchmark/video.m3u8";
+  HlsParams hls_params;
+  hls_params.playlist_type = HlsPlaylistType::kVod;
+  hls::MediaPlaylist media_playlist(hls_params, "video.m3u8", "video",
+                                    "group");
+  if (!media_playlist.SetMediaInfo(CreateVideoMediaInfo(0))) {
+    state->SkipWithError("Failed to set the MediaInfo.");
+    return;
+  }
+  int64_t start_time = 0;
+  for (int i = 0; i < kNumSegments; ++i) {
+    media_playlist.AddSegment(base::StringPrintf("video_0_%d.m4s", i + 1),
+                              start_time, GetSegmentDuration(i), 0,
+                              kSegmentSize);
+    start_time += GetSegmentDuration(i);
+  }
+
+  while (state->KeepRunning()) {
+    if (!media_playlist.WriteToFile(kPlaylistFileName)) {
+      state->SkipWithError("Failed to write the playlist.");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() *
+                           File::GetFileSize(kPlaylistFileName));
+  state->SetItemsProcessed(state->iterations() * kNumSegments);
+  File::Delete(kPlaylistFileName);
+}
+BENCHMARK(BM_HlsMediaPlaylistWriteToFile);
+
+}  // namespace
+}  // namespace shaka
@@ -0,0 +1,268 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// End-to-end benchmarks running the test media through the packager. The
+// input is copied to a memory file first and all the outputs are memory files,
+// so the results do not depend on the disk.
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "packager/benchmarks/benchmark.h"
+#include "packager/file/file.h"
+#include "packager/media/base/media_handler.h"
+#include "packager/media/demuxer/demuxer.h"
+#include "packager/packager.h"
+
+namespace shaka {
+namespace {
+
+using benchmark::State;
+
+const char kTestDataDir[] = "packager/media/test/data/";
+const char kMemoryDir[] = "memory://benchmark/";
+
+const uint8_t kKeyId[] = {
+    0xe5, 0x00, 0x7e, 0x6e, 0x9d, 0xcd, 0x5a, 0xc0,
+    0x95, 0x20, 0x2e, 0xd3, 0x75, 0x83, 0x82, 0xcd,
+};
+const uint8_t kKey[] = {
+    0x6f, 0xc9, 0x6f, 0xe6, 0x28, 0xa2, 0x65, 0xb1,
+    0x3a, 0xed, 0xde, 0xc0, 0xbc, 0x42, 0x1f, 0x4d,
+};
+
+// Counts the media samples of a stream.
+class SampleCounter : public media::MediaHandler {
+ public:
+  SampleCounter() = default;
+
+  int64_t num_samples() const { return num_samples_; }
+
+ protected:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<media::StreamData> stream_data) override {
+    if (stream_data->stream_data_type == media::StreamDataType::kMediaSample)
+      ++num_samples_;
+    return Status::OK;
+  }
+
+ private:
+  SampleCounter(const SampleCounter&) = delete;
+  SampleCounter& operator=(const SampleCounter&) = delete;
+
+  int64_t num_samples_ = 0;
+};
+
+// Input media copied to a memory file.
+class Input {
+ public:
+  // |file_name| is a file in the test data directory with |num_streams|
+  // streams.
+  Input(const std::string& file_name, int num_streams)
+      : source_file_name_(kTestDataDir + file_name),
+        file_name_(kMemoryDir + file_name),
+        num_streams_(num_streams) {}
+
+  ~Input() { File::Delete(file_name_.c_str()); }
+
+  // Copies the file to memory. Must be called before the other methods.
+  bool Load() {
+    if (!File::Copy(source_file_name_.c_str(), file_name_.c_str()))
+      return false;
+    size_ = File::GetFileSize(file_name_.c_str());
+    return size_ > 0;
+  }
+
+  // Demuxes the input and counts the samples of all the streams.
+  Status Demux(int64_t* num_samples) const {
+    media::Demuxer demuxer(file_name_);
+    std::vector<std::shared_ptr<SampleCounter>> counters;
+    for (int i = 0; i < num_streams_; ++i) {
+      counters.emplace_back(new SampleCounter);
+      Status status = demuxer.SetHandler(std::to_string(i), counters.back());
+      if (!status.ok())
+        return status;
+    }
+    Status status = demuxer.Run();
+    *num_samples = 0;
+    for (const auto& counter : counters)
+      *num_samples += counter->num_samples();
+    return status;
+  }
+
+  const std::string& file_name() const { return file_name_; }
+  int64_t size() const { return size_; }
+
+ private:
+  Input(const Input&) = delete;
+  Input& operator=(const Input&) = delete;
+
+  const std::string source_file_name_;
+  const std::string file_name_;
+  const int num_streams_;
+  int64_t size_ = 0;
+};
+
+// Loads |input| and counts its samples. Returns false and fails the benchmark
+// on error.
+bool LoadInput(Input* input, int64_t* num_samples, State* state) {
+  if (!input->Load()) {
+    state->SkipWithError("Failed to load " + input->file_name() +
+                         ". The benchmarks are expected to run from the "
+                         "packager repository root.");
+    return false;
+  }
+  Status status = input->Demux(num_samples);
+  if (!status.ok()) {
+    state->SkipWithError(status.ToString());
+    return false;
+  }
+  return true;
+}
+
+void RunDemuxer(const std::string& file_name, int num_streams, State* state) {
+  Input input(file_name, num_streams);
+  int64_t num_samples = 0;
+  if (!LoadInput(&input, &num_samples, state))
+    return;
+
+  while (state->KeepRunning()) {
+    Status status = input.Demux(&num_samples);
+    if (!status.ok()) {
+      state->SkipWithError(status.ToString());
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * input.size());
+  state->SetItemsProcessed(state->iterations() * num_samples);
+}
+
+void BM_DemuxMp4(State* state) {
+  RunDemuxer("bear-640x360.mp4", 2, state);
+}
+BENCHMARK(BM_DemuxMp4);
+
+void BM_DemuxTs(State* state) {
+  RunDemuxer("bear-640x360.ts", 2, state);
+}
+BENCHMARK(BM_DemuxTs);
+
+void BM_DemuxWebM(State* state) {
+  RunDemuxer("bear-640x360.webm", 2, state);
+}
+BENCHMARK(BM_DemuxWebM);
+
+enum class Output {
+  kDashOnDemand,
+  kDashLive,
+  kHls,
+};
+
+PackagingParams CreatePackagingParams(Output output, bool encrypted) {
+  PackagingParams packaging_params;
+  packaging_params.temp_dir = kMemoryDir;
+  packaging_params.chunking_params.segment_duration_in_seconds = 1.0;
+  if (output == Output::kHls) {
+    packaging_params.hls_params.master_playlist_output =
+        std::string(kMemoryDir) + "master.m3u8";
+  } else {
+    packaging_params.mpd_params.mpd_output =
+        std::string(kMemoryDir) + "output.mpd";
+  }
+  if (encrypted) {
+    EncryptionParams& encryption_params = packaging_params.encryption_params;
+    encryption_params.key_provider = KeyProvider::kRawKey;
+    encryption_params.raw_key.key_map[""].key_id.assign(std::begin(kKeyId),
+                                                        std::end(kKeyId));
+    encryption_params.raw_key.key_map[""].key.assign(std::begin(kKey),
+                                                     std::end(kKey));
+    if (output == Output::kHls) {
+      encryption_params.protection_scheme =
+          EncryptionParams::kProtectionSchemeCbcs;
+    }
+  }
+  return packaging_params;
+}
+
+std::vector<StreamDescriptor> CreateStreamDescriptors(const Input& input,
+                                                      Output output) {
+  std::vector<StreamDescriptor> stream_descriptors;
+  for (const char* stream_selector : {"audio", "video"}) {
+    const std::string prefix = kMemoryDir + std::string(stream_selector);
+    StreamDescriptor stream_descriptor;
+    stream_descriptor.input = input.file_name();
+    stream_descriptor.stream_selector = stream_selector;
+    switch (output) {
+      case Output::kDashOnDemand:
+        stream_descriptor.output = prefix + ".mp4";
+        break;
+      case Output::kDashLive:
+        stream_descriptor.output = prefix + "_init.mp4";
+        stream_descriptor.segment_template = prefix + "_$Number$.m4s";
+        break;
+      case Output::kHls:
+        stream_descriptor.segment_template = prefix + "_$Number$.ts";
+        stream_descriptor.hls_playlist_name =
+            std::string(stream_selector) + ".m3u8";
+        break;
+    }
+    stream_descriptors.push_back(stream_descriptor);
+  }
+  return stream_descriptors;
+}
+
+void RunPackager(const std::string& file_name,
+                 Output output,
+                 bool encrypted,
+                 State* state) {
+  Input input(file_name, 2);
+  int64_t num_samples = 0;
+  if (!LoadInput(&input, &num_samples, state))
+    return;
+  const PackagingParams packaging_params =
+      CreatePackagingParams(output, encrypted);
+  const std::vector<StreamDescriptor> stream_descriptors =
+      CreateStreamDescriptors(input, output);
+
+  while (state->KeepRunning()) {
+    Packager packager;
+    Status status = packager.Initialize(packaging_params, stream_descriptors);
+    if (status.ok())
+      status = packager.Run();
+    if (!status.ok()) {
+      state->SkipWithError(status.ToString());
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * input.size());
+  state->SetItemsProcessed(state->iterations() * num_samples);
+}
+
+void BM_PackageMp4ToDashOnDemand(State* state) {
+  RunPackager("bear-640x360.mp4", Output::kDashOnDemand, false, state);
+}
+BENCHMARK(BM_PackageMp4ToDashOnDemand);
+
+void BM_PackageMp4ToDashLiveEncrypted(State* state) {
+  RunPackager("bear-640x360.mp4", Output::kDashLive, true, state);
+}
+BENCHMARK(BM_PackageMp4ToDashLiveEncrypted);
+
+void BM_PackageTsToHls(State* state) {
+  RunPackager("bear-640x360.ts", Output::kHls, false, state);
+}
+BENCHMARK(BM_PackageTsToHls);
+
+void BM_PackageTsToHlsEncrypted(State* state) {
+  RunPackager("bear-640x360.ts", Output::kHls, true, state);
+}
+BENCHMARK(BM_PackageTsToHlsEncrypted);
+
+}  // namespace
+}  // namespace shaka
@@ -57,8 +57,10 @@ bool CallbackFile::Tell(uint64_t* position) {
 }
 
 bool CallbackFile::Open() {
-  if (file_mode_ != "r" && file_mode_ != "w" && file_mode_ != "rb" &&
-      file_mode_ != "wb") {
+  // Appending is the same as writing, as the data is passed to the write
+  // callback as a stream.
+  if (file_mode_ != "r" && file_mode_ != "w" && file_mode_ != "a" &&
+      file_mode_ != "rb" && file_mode_ != "wb" && file_mode_ != "ab") {
     LOG(ERROR) << "CallbackFile does not support file mode " << file_mode_;
     return false;
   }
@@ -18,6 +18,9 @@
 #include "packager/file/callback_file.h"
 #include "packager/file/file_util.h"
 #include "packager/file/local_file.h"
+#if !defined(OS_WIN)
+#include "packager/file/mapped_file.h"
+#endif  // !defined(OS_WIN)
 #include "packager/file/memory_file.h"
 #include "packager/file/threaded_io_file.h"
 #include "packager/file/udp_file.h"
@@ -39,6 +42,7 @@ namespace shaka {
 
 const char* kCallbackFilePrefix = "callback://";
 const char* kLocalFilePrefix = "file://";
+const char* kMappedFilePrefix = "mmap://";
 const char* kMemoryFilePrefix = "memory://";
 const char* kUdpFilePrefix = "udp://";
 
@@ -68,13 +72,28 @@ bool DeleteLocalFile(const char* file_name) {
   return LocalFile::Delete(file_name);
 }
 
-bool WriteLocalFileAtomically(const char* file_name,
-                              const std::string& contents) {
+bool WriteLocalFileAtomicallyInternal(const char* file_name,
+                                      const std::string& contents,
+                                      bool owner_only) {
   const base::FilePath file_path = base::FilePath::FromUTF8Unsafe(file_name);
   const std::string dir_name = file_path.DirName().AsUTF8Unsafe();
   std::string temp_file_name;
   if (!TempFilePath(dir_name, &temp_file_name))
     return false;
+#if defined(OS_POSIX)
+  // Restrict the temporary file before any content lands in it. The mode
+  // carries over to |file_name| on replace.
+  if (owner_only &&
+      (!File::WriteStringToFile(temp_file_name.c_str(), "") ||
+       !base::SetPosixFilePermissions(
+           base::FilePath::FromUTF8Unsafe(temp_file_name),
+           base::FILE_PERMISSION_READ_BY_USER |
+               base::FILE_PERMISSION_WRITE_BY_USER))) {
+    LOG(ERROR) << "Failed to restrict permissions of '" << temp_file_name
+               << "'.";
+    return false;
+  }
+#endif  // defined(OS_POSIX)
   if (!File::WriteStringToFile(temp_file_name.c_str(), contents))
     return false;
   base::File::Error replace_file_error = base::File::FILE_OK;
@@ -87,12 +106,27 @@ bool WriteLocalFileAtomically(const char* file_name,
   return true;
 }
 
+bool WriteLocalFileAtomically(const char* file_name,
+                              const std::string& contents) {
+  return WriteLocalFileAtomicallyInternal(file_name, contents, false);
+}
+
+File* CreateMappedFile(const char* file_name, const char* mode) {
+#if defined(OS_WIN)
+  // Memory mapping is not supported on Windows. Read the file normally.
+  return new LocalFile(file_name, mode);
+#else
+  return new MappedFile(file_name, mode);
+#endif  // defined(OS_WIN)
+}
+
 File* CreateUdpFile(const char* file_name, const char* mode) {
-  if (strcmp(mode, "r")) {
-    NOTIMPLEMENTED() << "UdpFile only supports read (receive) mode.";
+  if (strcmp(mode, "r") && strcmp(mode, "w")) {
+    NOTIMPLEMENTED() << "UdpFile only supports read (receive) and write (send) "
+                        "modes.";
     return NULL;
   }
-  return new UdpFile(file_name);
+  return new UdpFile(file_name, mode);
 }
 
 File* CreateMemoryFile(const char* file_name, const char* mode) {
@@ -111,6 +145,7 @@ static const FileTypeInfo kFileTypeInfo[] = {
         &DeleteLocalFile,
         &WriteLocalFileAtomically,
     },
+    {kMappedFilePrefix, &CreateMappedFile, &DeleteLocalFile, nullptr},
     {kUdpFilePrefix, &CreateUdpFile, nullptr, nullptr},
     {kMemoryFilePrefix, &CreateMemoryFile, &DeleteMemoryFile, nullptr},
     {kCallbackFilePrefix, &CreateCallbackFile, nullptr, nullptr},
@@ -143,8 +178,13 @@ File* File::Create(const char* file_name, const char* mode) {
 
   base::StringPiece file_type_prefix = GetFileTypePrefix(file_name);
   if (file_type_prefix == kMemoryFilePrefix ||
-      file_type_prefix == kCallbackFilePrefix) {
-    // Disable caching for memory and callback files.
+      file_type_prefix == kCallbackFilePrefix ||
+      file_type_prefix == kMappedFilePrefix) {
+    // Disable caching for memory, callback and mapped files.
+    return internal_file.release();
+  }
+  if (internal_file && internal_file->SupportsReadInPlace()) {
+    // The file buffers the data by itself, e.g. UdpFile with a receive ring.
     return internal_file.release();
   }
 
@@ -204,6 +244,49 @@ bool File::Delete(const char* file_name) {
              : false;
 }
 
+bool File::IsLocalRegularFile(const char* file_name) {
+  base::StringPiece real_file_name;
+  const FileTypeInfo* file_type = GetFileTypeInfo(file_name, &real_file_name);
+  DCHECK(file_type);
+  if (file_type->factory_function != &CreateLocalFile)
+    return false;
+  base::File::Info file_info;
+  return base::GetFileInfo(
+             base::FilePath::FromUTF8Unsafe(real_file_name.as_string()),
+             &file_info) &&
+         !file_info.is_directory;
+}
+
+int64_t File::WriteGathered(const std::vector<GatherBuffer>& buffers) {
+  int64_t total_bytes_written = 0;
+  for (const GatherBuffer& buffer : buffers) {
+    const uint8_t* data = static_cast<const uint8_t*>(buffer.data);
+    uint64_t remaining_size = buffer.size;
+    while (remaining_size > 0) {
+      const int64_t bytes_written = Write(data, remaining_size);
+      if (bytes_written <= 0)
+        return -1;
+      data += bytes_written;
+      remaining_size -= bytes_written;
+      total_bytes_written += bytes_written;
+    }
+  }
+  return total_bytes_written;
+}
+
+bool File::SupportsReadInPlace() const {
+  return false;
+}
+
+int64_t File::ReadInPlace(const uint8_t** data, uint64_t length) {
+  NOTIMPLEMENTED() << "ReadInPlace is not supported by " << file_name();
+  return -1;
+}
+
+bool File::ReadInPlaceDataStaysValid() const {
+  return true;
+}
+
 int64_t File::GetFileSize(const char* file_name) {
   File* file = File::Open(file_name, "r");
   if (!file)
@@ -278,6 +361,18 @@ bool File::WriteFileAtomically(const char* file_name,
   return WriteStringToFile(file_name, contents);
 }
 
+bool File::WritePrivateFileAtomically(const char* file_name,
+                                      const std::string& contents) {
+  base::StringPiece real_file_name;
+  const FileTypeInfo* file_type = GetFileTypeInfo(file_name, &real_file_name);
+  DCHECK(file_type);
+  if (file_type->atomic_write_function == &WriteLocalFileAtomically) {
+    return WriteLocalFileAtomicallyInternal(real_file_name.data(), contents,
+                                            true);
+  }
+  return WriteFileAtomically(file_name, contents);
+}
+
 bool File::Copy(const char* from_file_name, const char* to_file_name) {
   std::string content;
   if (!ReadFileToString(from_file_name, &content)) {
@@ -351,6 +446,40 @@ int64_t File::CopyFile(File* source, File* destination, int64_t max_copy) {
   return bytes_copied;
 }
 
+int64_t File::AppendFile(const char* from_file_name,
+                         const char* to_file_name) {
+  base::StringPiece real_from_file_name;
+  base::StringPiece real_to_file_name;
+  const FileTypeInfo* from_file_type =
+      GetFileTypeInfo(from_file_name, &real_from_file_name);
+  const FileTypeInfo* to_file_type =
+      GetFileTypeInfo(to_file_name, &real_to_file_name);
+  if (from_file_type->factory_function == &CreateLocalFile &&
+      to_file_type->factory_function == &CreateLocalFile) {
+    return LocalFile::AppendFile(real_from_file_name.as_string().c_str(),
+                                 real_to_file_name.as_string().c_str());
+  }
+
+  std::unique_ptr<File, FileCloser> source(File::Open(from_file_name, "r"));
+  if (!source) {
+    LOG(ERROR) << "Failed to open file " << from_file_name;
+    return -1;
+  }
+  std::unique_ptr<File, FileCloser> destination(File::Open(to_file_name, "a"));
+  if (!destination) {
+    LOG(ERROR) << "Failed to open file " << to_file_name << " for appending.";
+    return -1;
+  }
+  const int64_t bytes_copied = CopyFile(source.get(), destination.get());
+  if (!destination.release()->Close()) {
+    LOG(ERROR)
+        << "Failed to close file '" << to_file_name
+        << "', possibly file permission issue or running out of disk space.";
+    return -1;
+  }
+  return bytes_copied;
+}
+
 std::string File::MakeCallbackFileName(
     const BufferCallbackParams& callback_params,
     const std::string& name) {
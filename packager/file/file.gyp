@@ -24,6 +24,8 @@
         'io_cache.h',
         'local_file.cc',
         'local_file.h',
+        'mapped_file.cc',
+        'mapped_file.h',
         'memory_file.cc',
         'memory_file.h',
         'public/buffer_callback_params.h',
@@ -33,11 +35,27 @@
         'udp_file.h',
         'udp_options.cc',
         'udp_options.h',
+        'udp_receive_ring.cc',
+        'udp_receive_ring.h',
       ],
       'dependencies': [
         '../base/base.gyp:base',
         '../third_party/gflags/gflags.gyp:gflags',
       ],
+      'conditions': [
+        ['OS == "win"', {
+          'sources!': [
+            'mapped_file.cc',
+            'mapped_file.h',
+          ],
+        }],
+        ['OS != "linux"', {
+          'sources!': [
+            'udp_receive_ring.cc',
+            'udp_receive_ring.h',
+          ],
+        }],
+      ],
     },
     {
       'target_name': 'file_unittest',
@@ -49,6 +67,7 @@
         'io_cache_unittest.cc',
         'memory_file_unittest.cc',
         'udp_options_unittest.cc',
+        'udp_receive_ring_unittest.cc',
       ],
       'dependencies': [
         '../media/test/media_test.gyp:run_tests_with_atexit_manager',
@@ -57,6 +76,13 @@
         '../third_party/gflags/gflags.gyp:gflags',
         'file',
       ],
+      'conditions': [
+        ['OS != "linux"', {
+          'sources!': [
+            'udp_receive_ring_unittest.cc',
+          ],
+        }],
+      ],
     },
   ],
 }
@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include <string>
+#include <vector>
 
 #include "packager/base/macros.h"
 #include "packager/file/public/buffer_callback_params.h"
@@ -18,6 +19,7 @@ namespace shaka {
 
 extern const char* kCallbackFilePrefix;
 extern const char* kLocalFilePrefix;
+extern const char* kMappedFilePrefix;
 extern const char* kMemoryFilePrefix;
 extern const char* kUdpFilePrefix;
 const int64_t kWholeFile = -1;
@@ -46,6 +48,11 @@ class File {
   /// @return true if successful, false otherwise.
   static bool Delete(const char* file_name);
 
+  /// @param file_name is the name of the file to be checked.
+  /// @return true if @a file_name is an existing local file, which is not a
+  ///         directory, false otherwise.
+  static bool IsLocalRegularFile(const char* file_name);
+
   /// Flush() and de-allocate resources associated with this file, and
   /// delete this File object.  THIS IS THE ONE TRUE WAY TO DEALLOCATE
   /// THIS OBJECT.
@@ -67,6 +74,20 @@ class File {
   /// @return Number of bytes written, or a value < 0 on error.
   virtual int64_t Write(const void* buffer, uint64_t length) = 0;
 
+  /// A block of data written by WriteGathered().
+  struct GatherBuffer {
+    const void* data;
+    uint64_t size;
+  };
+
+  /// Write several blocks of data, in order. The default implementation
+  /// writes them one at a time with Write(). File types which can write them
+  /// at once without copying them, e.g. with writev, override it.
+  /// @param buffers are the blocks of data to write.
+  /// @return Number of bytes written, which is the total size of the blocks,
+  ///         or a value < 0 on error.
+  virtual int64_t WriteGathered(const std::vector<GatherBuffer>& buffers);
+
   /// @return Size of the file in bytes. A return value less than zero
   ///         indicates a problem getting the size.
   virtual int64_t Size() = 0;
@@ -89,6 +110,24 @@ class File {
   /// @return true on succcess, false otherwise.
   virtual bool Tell(uint64_t* position) = 0;
 
+  /// @return true if the file supports ReadInPlace, i.e. its contents are in
+  ///         memory, false otherwise.
+  virtual bool SupportsReadInPlace() const;
+
+  /// Read data without copying it. Only supported if SupportsReadInPlace()
+  /// returns true.
+  /// @param[out] data is set to point to the data read, which stays valid
+  ///             until the file is closed, or only until the next read if
+  ///             ReadInPlaceDataStaysValid() returns false.
+  /// @param length indicates the maximum number of bytes to be read.
+  /// @return Number of bytes read, or a value < 0 on error.
+  ///         Zero on end-of-file, or if 'length' is zero.
+  virtual int64_t ReadInPlace(const uint8_t** data, uint64_t length);
+
+  /// @return true if the data read in place stays valid until the file is
+  ///         closed, false if it only stays valid until the next read.
+  virtual bool ReadInPlaceDataStaysValid() const;
+
   /// @return The file name. Note that the file type prefix has been stripped
   ///         off.
   const std::string& file_name() const { return file_name_; }
@@ -121,6 +160,15 @@ class File {
   static bool WriteFileAtomically(const char* file_name,
                                   const std::string& contents);
 
+  /// Same as WriteFileAtomically, but a local destination file is only
+  /// readable and writable by its owner. Other file types are written with
+  /// WriteFileAtomically.
+  /// @param file_name is the destination file name.
+  /// @param contents is the data to be saved.
+  /// @return true on success, false otherwise.
+  static bool WritePrivateFileAtomically(const char* file_name,
+                                         const std::string& contents);
+
   /// Copies files. This is not good for copying huge files. Although not
   /// recommended, it is safe to have source file and destination file name be
   /// the same.
@@ -142,6 +190,17 @@ class File {
   /// @return Number of bytes written, or a value < 0 on error.
   static int64_t CopyFile(File* source, File* destination, int64_t max_copy);
 
+  /// Appends the contents of a file to the end of another file. If both are
+  /// local files, the contents are copied by the kernel where supported, i.e.
+  /// without a round trip through user space, and may even share the data
+  /// blocks on file systems supporting reflinks.
+  /// @param from_file_name is the source file name.
+  /// @param to_file_name is the destination file name. It is created if it
+  ///        does not exist.
+  /// @return Number of bytes appended, or a value < 0 on error.
+  static int64_t AppendFile(const char* from_file_name,
+                            const char* to_file_name);
+
   /// Generate callback file name.
   /// NOTE: THE GENERATED NAME IS ONLY VAID WHILE @a callback_params IS VALID.
   /// @param callback_params references BufferCallbackParams, which will be
@@ -66,6 +66,17 @@ TEST_F(LocalFileTest, Size) {
   ASSERT_EQ(kDataSize, File::GetFileSize(local_file_name_.c_str()));
 }
 
+TEST_F(LocalFileTest, IsLocalRegularFile) {
+  EXPECT_TRUE(File::IsLocalRegularFile(local_file_name_.c_str()));
+  EXPECT_TRUE(File::IsLocalRegularFile(local_file_name_no_prefix_.c_str()));
+  EXPECT_FALSE(File::IsLocalRegularFile(
+      test_file_path_.DirName().AsUTF8Unsafe().c_str()));
+
+  base::DeleteFile(test_file_path_, false);
+  EXPECT_FALSE(File::IsLocalRegularFile(local_file_name_.c_str()));
+  EXPECT_FALSE(File::IsLocalRegularFile("memory://file"));
+}
+
 TEST_F(LocalFileTest, Copy) {
   ASSERT_EQ(kDataSize,
             base::WriteFile(test_file_path_, data_.data(), kDataSize));
@@ -90,6 +101,28 @@ TEST_F(LocalFileTest, Copy) {
   base::DeleteFile(temp_dir, true);
 }
 
+TEST_F(LocalFileTest, AppendFile) {
+  ASSERT_EQ(kDataSize,
+            base::WriteFile(test_file_path_, data_.data(), kDataSize));
+
+  FilePath temp_dir;
+  ASSERT_TRUE(base::CreateNewTempDirectory(FilePath::StringType(), &temp_dir));
+  FilePath destination = temp_dir.Append(FilePath::FromUTF8Unsafe("a"));
+  const std::string kHeader = "header";
+  ASSERT_TRUE(File::WriteStringToFile(destination.AsUTF8Unsafe().c_str(),
+                                      kHeader));
+
+  ASSERT_EQ(kDataSize,
+            File::AppendFile(local_file_name_.c_str(),
+                             destination.AsUTF8Unsafe().c_str()));
+
+  std::string appended_file_content;
+  ASSERT_TRUE(base::ReadFileToString(destination, &appended_file_content));
+  EXPECT_EQ(kHeader + data_, appended_file_content);
+
+  base::DeleteFile(temp_dir, true);
+}
+
 TEST_F(LocalFileTest, Write) {
   // Write file using File API.
   File* file = File::Open(local_file_name_.c_str(), "w");
@@ -154,6 +187,31 @@ TEST_F(LocalFileTest, WriteRead) {
   EXPECT_EQ(data_, read_data);
 }
 
+// The blocks are written in order after the data written before, both with
+// and without the threaded I/O cache.
+TEST_F(LocalFileTest, WriteGathered) {
+  for (const bool buffered : {true, false}) {
+    File* file =
+        buffered ? File::Open(local_file_name_.c_str(), "w")
+                 : File::OpenWithNoBuffering(local_file_name_.c_str(), "w");
+    ASSERT_TRUE(file != NULL);
+    const int kPrefixSize = 10;
+    EXPECT_EQ(kPrefixSize, file->Write(&data_[0], kPrefixSize));
+    const std::vector<File::GatherBuffer> buffers = {
+        {&data_[kPrefixSize], 100},
+        {&data_[kPrefixSize + 100], 0},
+        {&data_[kPrefixSize + 100], kDataSize - kPrefixSize - 200},
+    };
+    EXPECT_EQ(kDataSize - kPrefixSize - 100, file->WriteGathered(buffers));
+    EXPECT_EQ(100, file->Write(&data_[kDataSize - 100], 100));
+    EXPECT_TRUE(file->Close());
+
+    std::string read_data;
+    ASSERT_TRUE(File::ReadFileToString(local_file_name_.c_str(), &read_data));
+    EXPECT_EQ(data_, read_data);
+  }
+}
+
 TEST_F(LocalFileTest, WriteStringReadString) {
   ASSERT_TRUE(
       File::WriteStringToFile(local_file_name_no_prefix_.c_str(), data_));
@@ -174,6 +232,23 @@ TEST_F(LocalFileTest, AtomicWriteRead) {
   EXPECT_EQ(data_, read_data);
 }
 
+#if defined(OS_POSIX)
+TEST_F(LocalFileTest, PrivateAtomicWriteIsOwnerOnly) {
+  ASSERT_TRUE(File::WritePrivateFileAtomically(
+      local_file_name_no_prefix_.c_str(), data_));
+  std::string read_data;
+  ASSERT_TRUE(
+      File::ReadFileToString(local_file_name_no_prefix_.c_str(), &read_data));
+  EXPECT_EQ(data_, read_data);
+
+  int mode = 0;
+  ASSERT_TRUE(base::GetPosixFilePermissions(test_file_path_, &mode));
+  EXPECT_EQ(base::FILE_PERMISSION_READ_BY_USER |
+                base::FILE_PERMISSION_WRITE_BY_USER,
+            mode);
+}
+#endif  // defined(OS_POSIX)
+
 TEST_F(LocalFileTest, WriteFlushCheckSize) {
   const uint32_t kNumCycles(10);
   const uint32_t kNumWrites(10);
@@ -195,6 +270,49 @@ TEST_F(LocalFileTest, WriteFlushCheckSize) {
   }
 }
 
+#if !defined(OS_WIN)
+TEST_F(LocalFileTest, MappedFileRead) {
+  ASSERT_EQ(kDataSize,
+            base::WriteFile(test_file_path_, data_.data(), kDataSize));
+
+  const std::string mapped_file_name =
+      kMappedFilePrefix + local_file_name_no_prefix_;
+  File* file = File::Open(mapped_file_name.c_str(), "r");
+  ASSERT_TRUE(file != NULL);
+  EXPECT_TRUE(file->SupportsReadInPlace());
+  EXPECT_EQ(kDataSize, file->Size());
+
+  const int kFirstReadBytes = kDataSize / 4;
+  std::string read_data(kFirstReadBytes, 0);
+  EXPECT_EQ(kFirstReadBytes, file->Read(&read_data[0], kFirstReadBytes));
+  EXPECT_EQ(data_.substr(0, kFirstReadBytes), read_data);
+
+  // The remaining data is read in place, without copying it.
+  const uint8_t* data = nullptr;
+  EXPECT_EQ(kDataSize - kFirstReadBytes, file->ReadInPlace(&data, kDataSize));
+  EXPECT_EQ(data_.substr(kFirstReadBytes),
+            std::string(data, data + kDataSize - kFirstReadBytes));
+  EXPECT_EQ(0, file->ReadInPlace(&data, kDataSize));
+
+  uint64_t position = 0;
+  ASSERT_TRUE(file->Seek(kFirstReadBytes));
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(static_cast<uint64_t>(kFirstReadBytes), position);
+  EXPECT_EQ(1, file->ReadInPlace(&data, 1));
+  EXPECT_EQ(data_[kFirstReadBytes], static_cast<char>(data[0]));
+  EXPECT_FALSE(file->Seek(kDataSize + 1));
+
+  EXPECT_EQ(-1, file->Write(data_.data(), kDataSize));
+  EXPECT_TRUE(file->Close());
+}
+
+TEST_F(LocalFileTest, MappedFileReadOnly) {
+  const std::string mapped_file_name =
+      kMappedFilePrefix + local_file_name_no_prefix_;
+  EXPECT_TRUE(File::Open(mapped_file_name.c_str(), "w") == NULL);
+}
+#endif  // !defined(OS_WIN)
+
 class ParamLocalFileTest : public LocalFileTest,
                            public ::testing::WithParamInterface<uint8_t> {};
 
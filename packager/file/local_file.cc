@@ -10,14 +10,130 @@
 #if defined(OS_WIN)
 #include <windows.h>
 #endif  // defined(OS_WIN)
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif  // defined(OS_LINUX)
+#if !defined(OS_WIN)
+#include <sys/uio.h>
+#include <unistd.h>
+#endif  // !defined(OS_WIN)
+#include <algorithm>
+#include <memory>
 #include "packager/base/files/file_util.h"
 #include "packager/base/logging.h"
+#include "packager/base/posix/eintr_wrapper.h"
+#if defined(OS_LINUX)
+#include "packager/base/files/scoped_file.h"
+#endif  // defined(OS_LINUX)
+#include "packager/file/file_closer.h"
 
 namespace shaka {
 
 // Always open files in binary mode.
 const char kAdditionalFileMode[] = "b";
 
+namespace {
+
+#if !defined(OS_WIN)
+// Maximum number of blocks written with one writev call, which is IOV_MAX on
+// Linux and Mac.
+const size_t kMaxWritevBlocks = 1024;
+#endif  // !defined(OS_WIN)
+
+#if defined(OS_LINUX)
+
+// Ways to copy data between two files, from the most to the least efficient.
+enum class CopyMethod {
+  kCopyFileRange,
+  kSendFile,
+  kReadWrite,
+};
+
+// Maximum number of bytes copied by the kernel in a single call, which keeps
+// sendfile within its limits.
+const size_t kMaxKernelCopySize = 0x40000000;  // 1GB.
+// Size of the buffer used if the data has to go through user space.
+const size_t kReadWriteBufferSize = 0x200000;  // 2MB.
+
+// Copies up to |length| bytes from |source_offset| in |source_fd| to
+// |destination_offset| in |destination_fd|. Switches |method| to the next
+// method if the current one is not supported for the two files.
+// Returns the number of bytes copied, 0 at the end of the source file, or -1
+// on error with errno set.
+ssize_t CopyRange(int source_fd,
+                  off_t source_offset,
+                  int destination_fd,
+                  off_t destination_offset,
+                  size_t length,
+                  CopyMethod* method,
+                  std::unique_ptr<uint8_t[]>* buffer) {
+  while (true) {
+    ssize_t result = -1;
+    switch (*method) {
+      case CopyMethod::kCopyFileRange: {
+#if defined(__NR_copy_file_range)
+        loff_t in_offset = source_offset;
+        loff_t out_offset = destination_offset;
+        result = HANDLE_EINTR(syscall(__NR_copy_file_range, source_fd,
+                                      &in_offset, destination_fd, &out_offset,
+                                      length, 0u));
+#else
+        errno = ENOSYS;
+#endif  // defined(__NR_copy_file_range)
+        break;
+      }
+      case CopyMethod::kSendFile: {
+        // sendfile writes at the current offset of the destination file.
+        if (lseek(destination_fd, destination_offset, SEEK_SET) < 0)
+          return -1;
+        off_t in_offset = source_offset;
+        result = HANDLE_EINTR(
+            sendfile(destination_fd, source_fd, &in_offset, length));
+        break;
+      }
+      case CopyMethod::kReadWrite: {
+        if (!*buffer)
+          buffer->reset(new uint8_t[kReadWriteBufferSize]);
+        length = std::min(length, kReadWriteBufferSize);
+        result = HANDLE_EINTR(
+            pread(source_fd, buffer->get(), length, source_offset));
+        if (result <= 0)
+          return result;
+        ssize_t bytes_written = 0;
+        while (bytes_written < result) {
+          const ssize_t write_result = HANDLE_EINTR(pwrite(
+              destination_fd, buffer->get() + bytes_written,
+              result - bytes_written, destination_offset + bytes_written));
+          if (write_result < 0)
+            return -1;
+          bytes_written += write_result;
+        }
+        return result;
+      }
+    }
+    if (result >= 0)
+      return result;
+    // These errors indicate that the method is not supported by the kernel or
+    // for the file systems of the two files.
+    if (errno != ENOSYS && errno != EXDEV && errno != EINVAL &&
+        errno != EOPNOTSUPP) {
+      return -1;
+    }
+    VLOG(1) << "Copy method " << static_cast<int>(*method)
+            << " is not supported: " << strerror(errno);
+    *method = static_cast<CopyMethod>(static_cast<int>(*method) + 1);
+  }
+}
+
+#endif  // defined(OS_LINUX)
+
+}  // namespace
+
 LocalFile::LocalFile(const char* file_name, const char* mode)
     : File(file_name), file_mode_(mode), internal_file_(NULL) {
   if (file_mode_.find(kAdditionalFileMode) == std::string::npos)
@@ -58,6 +174,58 @@ int64_t LocalFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t LocalFile::WriteGathered(const std::vector<GatherBuffer>& buffers) {
+#if defined(OS_WIN)
+  return File::WriteGathered(buffers);
+#else
+  DCHECK(internal_file_ != NULL);
+  // The data buffered by stdio goes first.
+  if (fflush(internal_file_) != 0)
+    return -1;
+  const int fd = fileno(internal_file_);
+
+  std::vector<struct iovec> iovecs;
+  iovecs.reserve(buffers.size());
+  for (const GatherBuffer& buffer : buffers) {
+    if (buffer.size == 0)
+      continue;
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(buffer.data);
+    iov.iov_len = static_cast<size_t>(buffer.size);
+    iovecs.push_back(iov);
+  }
+
+  int64_t total_bytes_written = 0;
+  size_t index = 0;
+  while (index < iovecs.size()) {
+    const int num_blocks =
+        static_cast<int>(std::min(iovecs.size() - index, kMaxWritevBlocks));
+    const ssize_t bytes_written =
+        HANDLE_EINTR(writev(fd, &iovecs[index], num_blocks));
+    if (bytes_written <= 0) {
+      PLOG(ERROR) << "Failed to write to " << file_name();
+      return -1;
+    }
+    total_bytes_written += bytes_written;
+    // Skip the blocks written, then the part written of a partial block.
+    size_t remaining_bytes = bytes_written;
+    while (index < iovecs.size() && remaining_bytes >= iovecs[index].iov_len) {
+      remaining_bytes -= iovecs[index].iov_len;
+      ++index;
+    }
+    if (remaining_bytes > 0) {
+      iovecs[index].iov_base =
+          static_cast<uint8_t*>(iovecs[index].iov_base) + remaining_bytes;
+      iovecs[index].iov_len -= remaining_bytes;
+    }
+  }
+  // stdio may cache the file position, which the writes above moved.
+  if (fseeko(internal_file_, 0, SEEK_CUR) < 0)
+    return -1;
+  return total_bytes_written;
+#endif  // defined(OS_WIN)
+}
+
 int64_t LocalFile::Size() {
   DCHECK(internal_file_ != NULL);
 
@@ -127,4 +295,75 @@ bool LocalFile::Delete(const char* file_name) {
   return base::DeleteFile(base::FilePath::FromUTF8Unsafe(file_name), false);
 }
 
+int64_t LocalFile::AppendFile(const char* from_file_name,
+                              const char* to_file_name) {
+#if defined(OS_LINUX)
+  base::ScopedFD source(
+      HANDLE_EINTR(open(from_file_name, O_RDONLY | O_CLOEXEC)));
+  if (!source.is_valid()) {
+    PLOG(ERROR) << "Failed to open file " << from_file_name;
+    return -1;
+  }
+  base::ScopedFD destination(HANDLE_EINTR(
+      open(to_file_name, O_WRONLY | O_CREAT | O_CLOEXEC, 0666)));
+  if (!destination.is_valid()) {
+    PLOG(ERROR) << "Failed to open file " << to_file_name;
+    return -1;
+  }
+  struct stat source_stat;
+  if (fstat(source.get(), &source_stat) != 0) {
+    PLOG(ERROR) << "Failed to get the size of file " << from_file_name;
+    return -1;
+  }
+  const off_t destination_size = lseek(destination.get(), 0, SEEK_END);
+  if (destination_size < 0) {
+    PLOG(ERROR) << "Failed to seek file " << to_file_name;
+    return -1;
+  }
+
+  CopyMethod method = CopyMethod::kCopyFileRange;
+  std::unique_ptr<uint8_t[]> buffer;
+  int64_t bytes_copied = 0;
+  while (bytes_copied < source_stat.st_size) {
+    const size_t length = static_cast<size_t>(std::min<int64_t>(
+        source_stat.st_size - bytes_copied, kMaxKernelCopySize));
+    const ssize_t result =
+        CopyRange(source.get(), bytes_copied, destination.get(),
+                  destination_size + bytes_copied, length, &method, &buffer);
+    if (result < 0) {
+      PLOG(ERROR) << "Failed to copy file " << from_file_name << " to "
+                  << to_file_name;
+      return -1;
+    }
+    // The source file is shorter than reported by fstat.
+    if (result == 0)
+      break;
+    bytes_copied += result;
+  }
+  if (IGNORE_EINTR(close(destination.release())) != 0) {
+    PLOG(ERROR) << "Failed to close file " << to_file_name;
+    return -1;
+  }
+  return bytes_copied;
+#else
+  std::unique_ptr<File, FileCloser> source(new LocalFile(from_file_name, "r"));
+  if (!source->Open()) {
+    LOG(ERROR) << "Failed to open file " << from_file_name;
+    return -1;
+  }
+  std::unique_ptr<File, FileCloser> destination(
+      new LocalFile(to_file_name, "a"));
+  if (!destination->Open()) {
+    LOG(ERROR) << "Failed to open file " << to_file_name;
+    return -1;
+  }
+  const int64_t bytes_copied = File::CopyFile(source.get(), destination.get());
+  if (!destination.release()->Close()) {
+    LOG(ERROR) << "Failed to close file " << to_file_name;
+    return -1;
+  }
+  return bytes_copied;
+#endif  // defined(OS_LINUX)
+}
+
 }  // namespace shaka
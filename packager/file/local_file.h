@@ -29,6 +29,7 @@ class LocalFile : public File {
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteGathered(const std::vector<GatherBuffer>& buffers) override;
   int64_t Size() override;
   bool Flush() override;
   bool Seek(uint64_t position) override;
@@ -40,6 +41,16 @@ class LocalFile : public File {
   /// @return true if successful, or false otherwise.
   static bool Delete(const char* file_name);
 
+  /// Append the contents of a local file to another local file. On Linux, the
+  /// contents are copied with copy_file_range or sendfile where supported by
+  /// the file systems, so the data does not go through user space.
+  /// @param from_file_name is the path of the source file.
+  /// @param to_file_name is the path of the destination file, which is created
+  ///        if it does not exist.
+  /// @return Number of bytes appended, or a value < 0 on error.
+  static int64_t AppendFile(const char* from_file_name,
+                            const char* to_file_name);
+
  protected:
   ~LocalFile() override;
 
@@ -0,0 +1,151 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/file/mapped_file.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "packager/base/files/scoped_file.h"
+#include "packager/base/logging.h"
+#include "packager/base/posix/eintr_wrapper.h"
+
+namespace shaka {
+namespace {
+
+// The kernel is asked to prefetch this many bytes ahead of the current
+// position, in addition to its own sequential readahead.
+const uint64_t kPrefetchSize = 16 << 20;
+
+}  // namespace
+
+MappedFile::MappedFile(const char* file_name, const char* mode)
+    : File(file_name), file_mode_(mode) {}
+
+bool MappedFile::Close() {
+  bool result = true;
+  if (data_ && munmap(data_, size_) != 0) {
+    PLOG(ERROR) << "Failed to unmap " << file_name();
+    result = false;
+  }
+  data_ = nullptr;
+  delete this;
+  return result;
+}
+
+int64_t MappedFile::Read(void* buffer, uint64_t length) {
+  DCHECK(buffer);
+  const uint8_t* data = nullptr;
+  const uint64_t bytes_read = Consume(&data, length);
+  if (bytes_read > 0)
+    memcpy(buffer, data, bytes_read);
+  return bytes_read;
+}
+
+int64_t MappedFile::Write(const void* buffer, uint64_t length) {
+  NOTIMPLEMENTED() << "MappedFile is read only.";
+  return -1;
+}
+
+int64_t MappedFile::Size() {
+  return size_;
+}
+
+bool MappedFile::Flush() {
+  // Nothing to flush for a read-only file.
+  return true;
+}
+
+bool MappedFile::Seek(uint64_t position) {
+  if (position > size_)
+    return false;
+  position_ = position;
+  // Restart the prefetching from the new position.
+  prefetched_end_ = position;
+  return true;
+}
+
+bool MappedFile::Tell(uint64_t* position) {
+  DCHECK(position);
+  *position = position_;
+  return true;
+}
+
+bool MappedFile::SupportsReadInPlace() const {
+  return true;
+}
+
+int64_t MappedFile::ReadInPlace(const uint8_t** data, uint64_t length) {
+  DCHECK(data);
+  return Consume(data, length);
+}
+
+MappedFile::~MappedFile() {}
+
+bool MappedFile::Open() {
+  if (file_mode_ != "r" && file_mode_ != "rb") {
+    LOG(ERROR) << "MappedFile only supports read mode, got '" << file_mode_
+               << "'.";
+    return false;
+  }
+
+  base::ScopedFD fd(HANDLE_EINTR(open(file_name().c_str(), O_RDONLY)));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << "Failed to open " << file_name();
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd.get(), &file_stat) != 0) {
+    PLOG(ERROR) << "Failed to stat " << file_name();
+    return false;
+  }
+  if (!S_ISREG(file_stat.st_mode)) {
+    LOG(WARNING) << file_name() << " is not a regular file and cannot be "
+                 << "mapped.";
+    return false;
+  }
+  size_ = file_stat.st_size;
+  // An empty file cannot be mapped, but it has nothing to read either.
+  if (size_ == 0)
+    return true;
+
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    PLOG(ERROR) << "Failed to map " << file_name();
+    return false;
+  }
+  data_ = static_cast<uint8_t*>(data);
+  // The mapping stays valid after the file descriptor is closed.
+  if (madvise(data_, size_, MADV_SEQUENTIAL) != 0)
+    PLOG(WARNING) << "madvise(MADV_SEQUENTIAL) failed for " << file_name();
+  return true;
+}
+
+uint64_t MappedFile::Consume(const uint8_t** data, uint64_t length) {
+  DCHECK_LE(position_, size_);
+  const uint64_t bytes_consumed = std::min(length, size_ - position_);
+  *data = data_ + position_;
+  position_ += bytes_consumed;
+
+  // Keep the pages ahead of the position prefetched, a window at a time.
+  if (position_ + kPrefetchSize / 2 > prefetched_end_ &&
+      prefetched_end_ < size_) {
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    const uint64_t start = std::max(position_, prefetched_end_) &
+                           ~(page_size - 1);
+    prefetched_end_ = std::min(size_, start + kPrefetchSize);
+    // Failure is harmless, the pages are then read on demand.
+    madvise(data_ + start, prefetched_end_ - start, MADV_WILLNEED);
+  }
+  return bytes_consumed;
+}
+
+}  // namespace shaka
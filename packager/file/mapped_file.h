@@ -0,0 +1,66 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_MAPPED_FILE_H_
+#define PACKAGER_FILE_MAPPED_FILE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "packager/file/file.h"
+
+namespace shaka {
+
+/// Implement MappedFile which maps a local file into memory for reading. The
+/// data can be read without copying it with ReadInPlace. The kernel is
+/// advised that the file is read sequentially and the pages ahead of the
+/// current position are prefetched.
+/// It is read only and not available on Windows.
+class MappedFile : public File {
+ public:
+  /// @param file_name C string containing the name of the file to be accessed.
+  /// @param mode C string containing a file access mode. Only "r" and "rb" are
+  ///        supported.
+  MappedFile(const char* file_name, const char* mode);
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t Size() override;
+  bool Flush() override;
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  bool SupportsReadInPlace() const override;
+  int64_t ReadInPlace(const uint8_t** data, uint64_t length) override;
+  /// @}
+
+ protected:
+  ~MappedFile() override;
+
+  bool Open() override;
+
+ private:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Consumes up to |length| bytes from the current position and returns the
+  // number of bytes consumed. |*data| is set to the first byte consumed.
+  uint64_t Consume(const uint8_t** data, uint64_t length);
+
+  std::string file_mode_;
+  uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+  uint64_t position_ = 0;
+  // The end of the range the kernel has been asked to prefetch.
+  uint64_t prefetched_end_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_MAPPED_FILE_H_
@@ -70,7 +70,7 @@ class FileSystem {
     } else if (mode == "w") {
       if (iter != files_.end())
         iter->second.clear();
-    } else {
+    } else if (mode != "a") {
       NOTIMPLEMENTED() << "File mode '" << mode
                        << "' not supported by MemoryFile";
       return nullptr;
@@ -179,7 +179,7 @@ bool MemoryFile::Open() {
   if (!file_)
     return false;
 
-  position_ = 0;
+  position_ = mode_ == "a" ? file_->size() : 0;
   return true;
 }
 
@@ -98,6 +98,18 @@ TEST_F(MemoryFileTest, ReadMissingFileFails) {
   EXPECT_FALSE(file);
 }
 
+TEST_F(MemoryFileTest, AppendToExistingFile) {
+  std::unique_ptr<File, FileCloser> file1(File::Open("memory://file1", "w"));
+  ASSERT_TRUE(file1);
+  ASSERT_EQ(kWriteBufferSize, file1->Write(kWriteBuffer, kWriteBufferSize));
+  file1.release()->Close();
+
+  std::unique_ptr<File, FileCloser> file2(File::Open("memory://file1", "a"));
+  ASSERT_TRUE(file2);
+  ASSERT_EQ(kWriteBufferSize, file2->Write(kWriteBuffer, kWriteBufferSize));
+  EXPECT_EQ(2 * kWriteBufferSize, file2->Size());
+}
+
 TEST_F(MemoryFileTest, WriteExistingFileDeletes) {
   std::unique_ptr<File, FileCloser> file1(File::Open("memory://file1", "w"));
   ASSERT_TRUE(file1);
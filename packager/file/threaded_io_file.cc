@@ -98,6 +98,27 @@ int64_t ThreadedIoFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t ThreadedIoFile::WriteGathered(
+    const std::vector<GatherBuffer>& buffers) {
+  DCHECK(internal_file_);
+  DCHECK_EQ(kOutputMode, mode_);
+
+  // Write the blocks directly to the internal file, which saves copying them
+  // to the cache, once the data already in the cache has been written. The
+  // writer task is then idle until more data is cached.
+  if (!Flush()) {
+    const int64_t error = internal_file_error_.load(std::memory_order_relaxed);
+    return error < 0 ? error : -1;
+  }
+  const int64_t bytes_written = internal_file_->WriteGathered(buffers);
+  if (bytes_written < 0)
+    return bytes_written;
+  position_ += bytes_written;
+  if (position_ > size_)
+    size_ = position_;
+  return bytes_written;
+}
+
 int64_t ThreadedIoFile::Size() {
   DCHECK(internal_file_);
 
@@ -31,6 +31,7 @@ class ThreadedIoFile : public File {
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteGathered(const std::vector<GatherBuffer>& buffers) override;
   int64_t Size() override;
   bool Flush() override;
   bool Seek(uint64_t position) override;
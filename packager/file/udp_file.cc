@@ -30,27 +30,117 @@
 
 #endif  // defined(OS_WIN)
 
+#include <string.h>
+
+#include <algorithm>
 #include <limits>
 
 #include "packager/base/logging.h"
 #include "packager/file/udp_options.h"
+#if defined(__linux__)
+#include "packager/base/posix/eintr_wrapper.h"
+#include "packager/file/udp_receive_ring.h"
+#endif  // defined(__linux__)
 
 namespace shaka {
 
 namespace {
 
+#if defined(__linux__)
+// Maximum number of datagrams sent with one sendmmsg call.
+const size_t kMaxSendBatchSize = 64;
+#endif  // defined(__linux__)
+
 bool IsIpv4MulticastAddress(const struct in_addr& addr) {
   return (ntohl(addr.s_addr) & 0xf0000000) == 0xe0000000;
 }
 
+// Sets up |sock_fd| to send datagrams to |dest_in_addr|.
+bool SetUpSendSocket(SOCKET sock_fd,
+                     const UdpOptions& options,
+                     const struct in_addr& dest_in_addr) {
+  const bool is_multicast = IsIpv4MulticastAddress(dest_in_addr);
+  if (is_multicast) {
+    struct in_addr interface_in_addr = {0};
+    if (inet_pton(AF_INET, options.interface_address().c_str(),
+                  &interface_in_addr) != 1) {
+      LOG(ERROR) << "Malformed IPv4 interface address "
+                 << options.interface_address();
+      return false;
+    }
+    if (interface_in_addr.s_addr != htonl(INADDR_ANY) &&
+        setsockopt(sock_fd, IPPROTO_IP, IP_MULTICAST_IF,
+                   reinterpret_cast<const char*>(&interface_in_addr),
+                   sizeof(interface_in_addr)) < 0) {
+      LOG(ERROR) << "Failed to set the multicast interface.";
+      return false;
+    }
+  }
+
+  if (options.ttl() > 0) {
+    const int ttl = options.ttl();
+    const int ttl_option = is_multicast ? IP_MULTICAST_TTL : IP_TTL;
+    if (setsockopt(sock_fd, IPPROTO_IP, ttl_option,
+                   reinterpret_cast<const char*>(&ttl), sizeof(ttl)) < 0) {
+      LOG(ERROR) << "Failed to set the time-to-live: " << strerror(errno);
+      return false;
+    }
+  }
+
+  if (options.buffer_size() > 0) {
+    const int send_buffer_size = options.buffer_size();
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_SNDBUF,
+                   reinterpret_cast<const char*>(&send_buffer_size),
+                   sizeof(send_buffer_size)) < 0) {
+      LOG(ERROR) << "Failed to set the maximum send buffer size: "
+                 << strerror(errno);
+      return false;
+    }
+  }
+
+  struct sockaddr_in dest_sock_addr = {0};
+  dest_sock_addr.sin_family = AF_INET;
+  dest_sock_addr.sin_port = htons(options.port());
+  dest_sock_addr.sin_addr = dest_in_addr;
+  if (connect(sock_fd, reinterpret_cast<struct sockaddr*>(&dest_sock_addr),
+              sizeof(dest_sock_addr))) {
+    LOG(ERROR) << "Could not connect UDP socket";
+    return false;
+  }
+  return true;
+}
+
 }  // anonymous namespace
 
-UdpFile::UdpFile(const char* file_name)
-    : File(file_name), socket_(INVALID_SOCKET) {}
+UdpFile::UdpFile(const char* file_name, const char* mode)
+    : File(file_name),
+      options_(UdpOptions::ParseFromString(file_name)),
+      is_sending_(strcmp(mode, "w") == 0),
+      socket_(INVALID_SOCKET) {}
 
 UdpFile::~UdpFile() {}
 
 bool UdpFile::Close() {
+#if defined(__linux__)
+  if (receive_ring_) {
+    receive_ring_->Stop();
+    const UdpReceiveRing::Stats stats = receive_ring_->stats();
+    VLOG(1) << "Received " << stats.datagrams_received << " datagrams ("
+            << stats.bytes_received << " bytes) from " << file_name();
+    if (stats.kernel_drops > 0 || stats.datagrams_truncated > 0 ||
+        stats.ring_overruns > 0) {
+      LOG(WARNING) << "Receiving from " << file_name() << ": "
+                   << stats.kernel_drops
+                   << " datagrams dropped by the kernel, "
+                   << stats.datagrams_truncated
+                   << " datagrams dropped as larger than "
+                   << UdpReceiveRing::kMaxDatagramSize
+                   << " bytes, receive ring full " << stats.ring_overruns
+                   << " times.";
+    }
+    receive_ring_.reset();
+  }
+#endif  // defined(__linux__)
   if (socket_ != INVALID_SOCKET) {
     close(socket_);
     socket_ = INVALID_SOCKET;
@@ -61,10 +151,19 @@ bool UdpFile::Close() {
 
 int64_t UdpFile::Read(void* buffer, uint64_t length) {
   DCHECK(buffer);
+#if defined(__linux__)
+  if (receive_ring_) {
+    const uint8_t* data = nullptr;
+    const int64_t result = receive_ring_->ReadInPlace(&data, length);
+    if (result > 0)
+      memcpy(buffer, data, result);
+    return result;
+  }
+#endif  // defined(__linux__)
   DCHECK_GE(length, 65535u)
       << "Buffer may be too small to read entire datagram.";
 
-  if (socket_ == INVALID_SOCKET)
+  if (socket_ == INVALID_SOCKET || is_sending_)
     return -1;
 
   int64_t result;
@@ -77,8 +176,56 @@ int64_t UdpFile::Read(void* buffer, uint64_t length) {
 }
 
 int64_t UdpFile::Write(const void* buffer, uint64_t length) {
-  NOTIMPLEMENTED();
-  return -1;
+  DCHECK(buffer);
+  if (socket_ == INVALID_SOCKET || !is_sending_)
+    return -1;
+
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer);
+  const uint64_t packet_size = options_->packet_size();
+  uint64_t bytes_sent = 0;
+#if defined(__linux__)
+  struct iovec iovecs[kMaxSendBatchSize];
+  struct mmsghdr messages[kMaxSendBatchSize];
+  while (bytes_sent < length) {
+    size_t num_messages = 0;
+    for (uint64_t offset = bytes_sent;
+         offset < length && num_messages < kMaxSendBatchSize;
+         offset += packet_size, ++num_messages) {
+      iovecs[num_messages].iov_base = const_cast<uint8_t*>(data + offset);
+      iovecs[num_messages].iov_len = std::min(packet_size, length - offset);
+      memset(&messages[num_messages], 0, sizeof(messages[num_messages]));
+      messages[num_messages].msg_hdr.msg_iov = &iovecs[num_messages];
+      messages[num_messages].msg_hdr.msg_iovlen = 1;
+    }
+    const int result =
+        HANDLE_EINTR(sendmmsg(socket_, messages, num_messages, 0));
+    if (result < 0) {
+      // A unicast receiver which is not listening yet is not an error: the
+      // error reported is for an earlier datagram. Try again.
+      if (errno == ECONNREFUSED)
+        continue;
+      PLOG(ERROR) << "Failed to send UDP datagrams to " << file_name();
+      return -1;
+    }
+    for (int i = 0; i < result; ++i)
+      bytes_sent += iovecs[i].iov_len;
+  }
+#else
+  while (bytes_sent < length) {
+    const uint64_t datagram_size = std::min(packet_size, length - bytes_sent);
+    int64_t result;
+    do {
+      result = send(socket_, reinterpret_cast<const char*>(data + bytes_sent),
+                    datagram_size, 0);
+    } while ((result == -1) && (errno == EINTR || errno == ECONNREFUSED));
+    if (result < 0) {
+      LOG(ERROR) << "Failed to send UDP datagram to " << file_name();
+      return -1;
+    }
+    bytes_sent += datagram_size;
+  }
+#endif  // defined(__linux__)
+  return bytes_sent;
 }
 
 int64_t UdpFile::Size() {
@@ -89,6 +236,10 @@ int64_t UdpFile::Size() {
 }
 
 bool UdpFile::Flush() {
+  if (is_sending_) {
+    // The datagrams are sent on write.
+    return true;
+  }
   NOTIMPLEMENTED();
   return false;
 }
@@ -103,6 +254,27 @@ bool UdpFile::Tell(uint64_t* position) {
   return false;
 }
 
+bool UdpFile::SupportsReadInPlace() const {
+#if defined(__linux__)
+  return options_ && options_->ring_size() > 0;
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+int64_t UdpFile::ReadInPlace(const uint8_t** data, uint64_t length) {
+#if defined(__linux__)
+  if (receive_ring_)
+    return receive_ring_->ReadInPlace(data, length);
+#endif  // defined(__linux__)
+  return File::ReadInPlace(data, length);
+}
+
+bool UdpFile::ReadInPlaceDataStaysValid() const {
+  // The data is overwritten once the ring slot is released.
+  return false;
+}
+
 #if defined(OS_WIN)
 class LibWinsockInitializer {
  public:
@@ -158,10 +330,9 @@ bool UdpFile::Open() {
 
   DCHECK_EQ(INVALID_SOCKET, socket_);
 
-  std::unique_ptr<UdpOptions> options =
-      UdpOptions::ParseFromString(file_name());
-  if (!options)
+  if (!options_)
     return false;
+  const UdpOptions* options = options_.get();
 
   ScopedSocket new_socket(socket(AF_INET, SOCK_DGRAM, 0));
   if (new_socket.get() == INVALID_SOCKET) {
@@ -175,6 +346,13 @@ bool UdpFile::Open() {
     return false;
   }
 
+  if (is_sending_) {
+    if (!SetUpSendSocket(new_socket.get(), *options, local_in_addr))
+      return false;
+    socket_ = new_socket.release();
+    return true;
+  }
+
   struct sockaddr_in local_sock_addr = {0};
   // TODO(kqyang): Support IPv6.
   local_sock_addr.sin_family = AF_INET;
@@ -291,6 +469,19 @@ bool UdpFile::Open() {
     }
   }
 
+  if (options->ring_size() > 0) {
+#if defined(__linux__)
+    receive_ring_.reset(new UdpReceiveRing(
+        new_socket.get(), options->ring_size(), options->timestamp()));
+    if (!receive_ring_->Start()) {
+      receive_ring_.reset();
+      return false;
+    }
+#else
+    LOG(WARNING) << "The UDP receive ring is only supported on Linux.";
+#endif  // defined(__linux__)
+  }
+
   socket_ = new_socket.release();
   return true;
 }
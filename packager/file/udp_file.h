@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 
 #include "packager/base/compiler_specific.h"
@@ -22,12 +23,21 @@ typedef int SOCKET;
 
 namespace shaka {
 
-/// Implements UdpFile, which receives UDP unicast and multicast streams.
+class UdpOptions;
+class UdpReceiveRing;
+
+/// Implements UdpFile, which receives or sends UDP unicast and multicast
+/// streams. On Linux, if the ring_size option is set, the datagrams are
+/// received on a dedicated thread into a ring of datagrams and can be read in
+/// place. When sending, the data written is split into datagrams of at most
+/// packet_size bytes, which are sent in batches with sendmmsg on Linux.
 class UdpFile : public File {
  public:
-  /// @param file_name C string containing the address of the stream to receive.
-  ///        It should be of the form "<ip_address>:<port>".
-  explicit UdpFile(const char* address_and_port);
+  /// @param file_name C string containing the address of the stream to receive
+  ///        or send. It should be of the form "<ip_address>:<port>".
+  /// @param mode C string containing the open mode, "r" to receive or "w" to
+  ///        send.
+  UdpFile(const char* address_and_port, const char* mode);
 
   /// @name File implementation overrides.
   /// @{
@@ -38,6 +48,9 @@ class UdpFile : public File {
   bool Flush() override;
   bool Seek(uint64_t position) override;
   bool Tell(uint64_t* position) override;
+  bool SupportsReadInPlace() const override;
+  int64_t ReadInPlace(const uint8_t** data, uint64_t length) override;
+  bool ReadInPlaceDataStaysValid() const override;
   /// @}
 
  protected:
@@ -46,7 +59,12 @@ class UdpFile : public File {
   bool Open() override;
 
  private:
+  std::unique_ptr<UdpOptions> options_;
+  const bool is_sending_;
   SOCKET socket_;
+#if defined(__linux__)
+  std::unique_ptr<UdpReceiveRing> receive_ring_;
+#endif  // defined(__linux__)
 
   DISALLOW_COPY_AND_ASSIGN(UdpFile);
 };
@@ -25,8 +25,12 @@ enum FieldType {
   kBufferSizeField,
   kInterfaceAddressField,
   kMulticastSourceField,
+  kPacketSizeField,
   kReuseField,
+  kRingSizeField,
   kTimeoutField,
+  kTimestampField,
+  kTtlField,
 };
 
 struct FieldNameToTypeMapping {
@@ -37,9 +41,13 @@ struct FieldNameToTypeMapping {
 const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
     {"buffer_size", kBufferSizeField},
     {"interface", kInterfaceAddressField},
+    {"packet_size", kPacketSizeField},
     {"reuse", kReuseField},
+    {"ring_size", kRingSizeField},
     {"source", kMulticastSourceField},
     {"timeout", kTimeoutField},
+    {"timestamp", kTimestampField},
+    {"ttl", kTtlField},
 };
 
 FieldType GetFieldType(const std::string& field_name) {
@@ -103,6 +111,14 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
           options->source_address_ = pair.second;
           options->is_source_specific_multicast_ = true;
           break;
+        case kPacketSizeField:
+          if (!base::StringToInt(pair.second, &options->packet_size_) ||
+              options->packet_size_ <= 0 || options->packet_size_ > 65507) {
+            LOG(ERROR) << "Invalid udp option for packet_size field "
+                       << pair.second;
+            return nullptr;
+          }
+          break;
         case kReuseField: {
           int reuse_value = 0;
           if (!base::StringToInt(pair.second, &reuse_value)) {
@@ -112,6 +128,14 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
           options->reuse_ = reuse_value > 0;
           break;
         }
+        case kRingSizeField:
+          if (!base::StringToInt(pair.second, &options->ring_size_) ||
+              options->ring_size_ < 0) {
+            LOG(ERROR) << "Invalid udp option for ring_size field "
+                       << pair.second;
+            return nullptr;
+          }
+          break;
         case kTimeoutField:
           if (!base::StringToUint(pair.second, &options->timeout_us_)) {
             LOG(ERROR) << "Invalid udp option for timeout field "
@@ -119,6 +143,23 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
             return nullptr;
           }
           break;
+        case kTimestampField: {
+          int timestamp_value = 0;
+          if (!base::StringToInt(pair.second, &timestamp_value)) {
+            LOG(ERROR) << "Invalid udp option for timestamp field "
+                       << pair.second;
+            return nullptr;
+          }
+          options->timestamp_ = timestamp_value > 0;
+          break;
+        }
+        case kTtlField:
+          if (!base::StringToInt(pair.second, &options->ttl_) ||
+              options->ttl_ < 0 || options->ttl_ > 255) {
+            LOG(ERROR) << "Invalid udp option for ttl field " << pair.second;
+            return nullptr;
+          }
+          break;
         default:
           LOG(ERROR) << "Unknown field in udp options (\"" << pair.first
                      << "\").";
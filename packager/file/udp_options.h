@@ -31,6 +31,10 @@ class UdpOptions {
     return is_source_specific_multicast_;
   }
   int buffer_size() const { return buffer_size_; }
+  int ring_size() const { return ring_size_; }
+  bool timestamp() const { return timestamp_; }
+  int packet_size() const { return packet_size_; }
+  int ttl() const { return ttl_; }
 
  private:
   UdpOptions() = default;
@@ -40,7 +44,8 @@ class UdpOptions {
   uint16_t port_ = 0;
   // Allow or disallow reusing UDP sockets.
   bool reuse_ = false;
-  // Address of the interface over which to receive UDP multicast streams.
+  // Address of the interface over which to receive or send UDP multicast
+  // streams.
   std::string interface_address_ = "0.0.0.0";
   // Timeout in microseconds. 0 to indicate unlimited timeout.
   unsigned timeout_us_ = 0;
@@ -52,6 +57,16 @@ class UdpOptions {
   // by the underlying operating system ('sysctl net.core.rmem_max' on Linux
   // returns the maximum receive memory size).
   int buffer_size_ = 0;
+  // Number of datagrams in the receive ring, 0 to receive the datagrams on
+  // read instead. Only supported on Linux.
+  int ring_size_ = 0;
+  // Record the time at which the datagrams were received, in the receive ring.
+  bool timestamp_ = false;
+  // Maximum size of the datagrams sent, in bytes. The default holds seven TS
+  // packets.
+  int packet_size_ = 7 * 188;
+  // Time-to-live of the datagrams sent, 0 for the system default.
+  int ttl_ = 0;
 };
 
 }  // namespace shaka
@@ -122,4 +122,41 @@ TEST_F(UdpOptionsTest, BufferSize) {
   EXPECT_EQ(1234, options->buffer_size());
 }
 
+TEST_F(UdpOptionsTest, RingSizeAndTimestamp) {
+  auto options =
+      UdpOptions::ParseFromString("224.1.2.30:88?ring_size=4096&timestamp=1");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(4096, options->ring_size());
+  EXPECT_TRUE(options->timestamp());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(0, options->ring_size());
+  EXPECT_FALSE(options->timestamp());
+}
+
+TEST_F(UdpOptionsTest, InvalidRingSize) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?ring_size=-1"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?ring_size=1a"));
+}
+
+TEST_F(UdpOptionsTest, PacketSizeAndTtl) {
+  auto options =
+      UdpOptions::ParseFromString("224.1.2.30:88?packet_size=1500&ttl=16");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(1500, options->packet_size());
+  EXPECT_EQ(16, options->ttl());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(1316, options->packet_size());
+  EXPECT_EQ(0, options->ttl());
+}
+
+TEST_F(UdpOptionsTest, InvalidPacketSizeAndTtl) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?packet_size=0"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?packet_size=65508"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?ttl=256"));
+}
+
 }  // namespace shaka
@@ -0,0 +1,221 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/file/udp_receive_ring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <algorithm>
+
+#include "packager/base/logging.h"
+#include "packager/base/posix/eintr_wrapper.h"
+
+namespace shaka {
+
+namespace {
+
+// Maximum number of datagrams received with one recvmmsg call.
+const size_t kMaxBatchSize = 64;
+
+const size_t kControlBufferSize =
+    CMSG_SPACE(sizeof(struct timeval)) + CMSG_SPACE(sizeof(uint32_t));
+
+}  // namespace
+
+const size_t UdpReceiveRing::kMaxDatagramSize;
+
+UdpReceiveRing::UdpReceiveRing(int socket, size_t ring_size, bool timestamps)
+    : socket_(socket),
+      ring_size_(ring_size),
+      timestamps_(timestamps),
+      datagrams_(ring_size * kMaxDatagramSize),
+      control_buffers_(ring_size * kControlBufferSize),
+      iovecs_(ring_size),
+      messages_(ring_size),
+      datagram_sizes_(ring_size),
+      receive_times_us_(ring_size),
+      datagrams_available_(&lock_),
+      slot_available_(&lock_) {
+  DCHECK_GT(ring_size, 0u);
+  for (size_t i = 0; i < ring_size; ++i) {
+    iovecs_[i].iov_base = &datagrams_[i * kMaxDatagramSize];
+    iovecs_[i].iov_len = kMaxDatagramSize;
+    memset(&messages_[i], 0, sizeof(messages_[i]));
+    messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+    messages_[i].msg_hdr.msg_iovlen = 1;
+    messages_[i].msg_hdr.msg_control =
+        &control_buffers_[i * kControlBufferSize];
+  }
+}
+
+UdpReceiveRing::~UdpReceiveRing() {
+  Stop();
+}
+
+bool UdpReceiveRing::Start() {
+  DCHECK(!receive_thread_);
+  const int optval = 1;
+  if (setsockopt(socket_, SOL_SOCKET, SO_RXQ_OVFL, &optval, sizeof(optval)) <
+      0) {
+    // The kernel drops are then not reported, which is not fatal.
+    PLOG(WARNING) << "Failed to enable SO_RXQ_OVFL.";
+  }
+  if (timestamps_ &&
+      setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMP, &optval, sizeof(optval)) <
+          0) {
+    PLOG(ERROR) << "Failed to enable SO_TIMESTAMP.";
+    return false;
+  }
+  receive_thread_.reset(
+      new base::DelegateSimpleThread(this, "UdpReceiveRing"));
+  receive_thread_->Start();
+  return true;
+}
+
+void UdpReceiveRing::Stop() {
+  if (!receive_thread_ || receive_thread_->HasBeenJoined())
+    return;
+  {
+    base::AutoLock auto_lock(lock_);
+    stopping_ = true;
+    slot_available_.Signal();
+  }
+  // Wakes up the receive thread. This fails with ENOTCONN if the socket is
+  // not connected, but still wakes it up.
+  shutdown(socket_, SHUT_RDWR);
+  receive_thread_->Join();
+}
+
+int64_t UdpReceiveRing::ReadInPlace(const uint8_t** data, uint64_t length) {
+  DCHECK(data);
+  if (length == 0)
+    return 0;
+
+  base::AutoLock auto_lock(lock_);
+  while (true) {
+    if (read_count_ < write_count_) {
+      const size_t slot = read_count_ % ring_size_;
+      if (read_offset_ < datagram_sizes_[slot]) {
+        const size_t bytes_read =
+            std::min<uint64_t>(length, datagram_sizes_[slot] - read_offset_);
+        *data = &datagrams_[slot * kMaxDatagramSize + read_offset_];
+        read_offset_ += bytes_read;
+        receive_time_us_ = receive_times_us_[slot];
+        return bytes_read;
+      }
+      // The datagram has been read entirely. Release its slot.
+      if (write_count_ - read_count_ == ring_size_)
+        slot_available_.Signal();
+      ++read_count_;
+      read_offset_ = 0;
+      continue;
+    }
+    if (receive_done_)
+      return receive_result_;
+    datagrams_available_.Wait();
+  }
+}
+
+UdpReceiveRing::Stats UdpReceiveRing::stats() const {
+  base::AutoLock auto_lock(lock_);
+  return stats_;
+}
+
+void UdpReceiveRing::Run() {
+  while (true) {
+    size_t first_slot = 0;
+    size_t num_slots = 0;
+    {
+      base::AutoLock auto_lock(lock_);
+      if (!stopping_ && write_count_ - read_count_ == ring_size_) {
+        // The datagrams are queued in the socket receive buffer meanwhile.
+        ++stats_.ring_overruns;
+        while (!stopping_ && write_count_ - read_count_ == ring_size_)
+          slot_available_.Wait();
+      }
+      if (stopping_) {
+        receive_result_ = 0;
+        break;
+      }
+      const size_t num_free_slots = ring_size_ - (write_count_ - read_count_);
+      first_slot = write_count_ % ring_size_;
+      num_slots = std::min(std::min(num_free_slots, ring_size_ - first_slot),
+                           kMaxBatchSize);
+    }
+
+    for (size_t i = first_slot; i < first_slot + num_slots; ++i) {
+      messages_[i].msg_hdr.msg_controllen = kControlBufferSize;
+      messages_[i].msg_hdr.msg_flags = 0;
+    }
+    // Blocks until a datagram is received, then receives the ones already
+    // queued without blocking.
+    const int result = HANDLE_EINTR(recvmmsg(socket_, &messages_[first_slot],
+                                             num_slots, MSG_WAITFORONE,
+                                             nullptr));
+    const int receive_errno = errno;
+
+    base::AutoLock auto_lock(lock_);
+    if (stopping_) {
+      receive_result_ = 0;
+      break;
+    }
+    if (result < 0) {
+      if (receive_errno == EAGAIN || receive_errno == EWOULDBLOCK) {
+        LOG(ERROR) << "Timed out receiving UDP datagrams.";
+      } else {
+        LOG(ERROR) << "Failed to receive UDP datagrams: "
+                   << strerror(receive_errno);
+      }
+      receive_result_ = -1;
+      break;
+    }
+    OnDatagramsReceived(first_slot, result);
+    datagrams_available_.Signal();
+  }
+  base::AutoLock auto_lock(lock_);
+  receive_done_ = true;
+  datagrams_available_.Signal();
+}
+
+void UdpReceiveRing::OnDatagramsReceived(size_t first_slot,
+                                         size_t num_received) {
+  lock_.AssertAcquired();
+  for (size_t i = first_slot; i < first_slot + num_received; ++i) {
+    struct msghdr* header = &messages_[i].msg_hdr;
+    int64_t receive_time_us = 0;
+    for (struct cmsghdr* control = CMSG_FIRSTHDR(header); control;
+         control = CMSG_NXTHDR(header, control)) {
+      if (control->cmsg_level != SOL_SOCKET)
+        continue;
+      if (control->cmsg_type == SO_RXQ_OVFL) {
+        // It is the total number of datagrams dropped by the socket.
+        uint32_t num_dropped = 0;
+        memcpy(&num_dropped, CMSG_DATA(control), sizeof(num_dropped));
+        stats_.kernel_drops = num_dropped;
+      } else if (control->cmsg_type == SO_TIMESTAMP) {
+        struct timeval receive_time;
+        memcpy(&receive_time, CMSG_DATA(control), sizeof(receive_time));
+        receive_time_us =
+            receive_time.tv_sec * INT64_C(1000000) + receive_time.tv_usec;
+      }
+    }
+
+    if (header->msg_flags & MSG_TRUNC) {
+      ++stats_.datagrams_truncated;
+      datagram_sizes_[i] = 0;
+    } else {
+      ++stats_.datagrams_received;
+      stats_.bytes_received += messages_[i].msg_len;
+      datagram_sizes_[i] = messages_[i].msg_len;
+    }
+    receive_times_us_[i] = receive_time_us;
+  }
+  write_count_ += num_received;
+}
+
+}  // namespace shaka
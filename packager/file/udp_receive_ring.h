@@ -0,0 +1,134 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_UDP_RECEIVE_RING_H_
+#define PACKAGER_FILE_UDP_RECEIVE_RING_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include <memory>
+#include <vector>
+
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+#include "packager/base/threading/simple_thread.h"
+
+namespace shaka {
+
+/// Receives the datagrams of a UDP socket on a dedicated thread, in batches
+/// with recvmmsg, into a ring of preallocated datagrams, which are then read
+/// in place. If the reader falls behind and the ring is full, the datagrams
+/// are queued in the socket receive buffer until a datagram has been read.
+/// Only available on Linux.
+class UdpReceiveRing : public base::DelegateSimpleThread::Delegate {
+ public:
+  /// Receive counters.
+  struct Stats {
+    /// Number of datagrams received into the ring.
+    uint64_t datagrams_received = 0;
+    /// Number of bytes received into the ring.
+    uint64_t bytes_received = 0;
+    /// Number of times the ring was full when receiving datagrams.
+    uint64_t ring_overruns = 0;
+    /// Number of datagrams dropped because they were larger than
+    /// kMaxDatagramSize.
+    uint64_t datagrams_truncated = 0;
+    /// Number of datagrams dropped by the kernel because the socket receive
+    /// buffer was full, as reported with SO_RXQ_OVFL.
+    uint64_t kernel_drops = 0;
+  };
+
+  /// Size of the datagrams in the ring. It holds seven TS packets, with an
+  /// RTP header, with room to spare.
+  static const size_t kMaxDatagramSize = 2048;
+
+  /// @param socket is the socket to receive from. It is not owned and must
+  ///        stay open until Stop() returns.
+  /// @param ring_size is the number of datagrams in the ring.
+  /// @param timestamps indicates whether the time at which the kernel
+  ///        received the datagrams is recorded, using SO_TIMESTAMP.
+  UdpReceiveRing(int socket, size_t ring_size, bool timestamps);
+  ~UdpReceiveRing() override;
+
+  /// Sets the socket options needed by the ring and starts the receive
+  /// thread.
+  /// @return true on success, false otherwise.
+  bool Start();
+
+  /// Stops the receive thread and waits for it to exit. The datagrams
+  /// already received can still be read. Called by the destructor if needed.
+  void Stop();
+
+  /// Reads data from the next datagram without copying it. Blocks until a
+  /// datagram is available. A datagram is read entirely before the next one.
+  /// @param[out] data is set to point to the data read, which stays valid
+  ///             until the next call.
+  /// @param length indicates the maximum number of bytes to be read.
+  /// @return Number of bytes read, zero once stopped and all the datagrams
+  ///         have been read, or a value < 0 if receiving failed, e.g. on
+  ///         timeout.
+  int64_t ReadInPlace(const uint8_t** data, uint64_t length);
+
+  /// @return the time at which the kernel received the datagram last read
+  ///         from, in microseconds since the epoch, or 0 if unknown.
+  int64_t receive_time_us() const { return receive_time_us_; }
+
+  /// @return the receive counters.
+  Stats stats() const;
+
+  /// DelegateSimpleThread::Delegate implementation overrides.
+  void Run() override;
+
+ private:
+  UdpReceiveRing(const UdpReceiveRing&) = delete;
+  UdpReceiveRing& operator=(const UdpReceiveRing&) = delete;
+
+  // Updates |datagram_sizes_|, |receive_times_us_| and |stats_| for the
+  // |num_received| datagrams received in the slots starting at |first_slot|.
+  // Must be called with |lock_| held.
+  void OnDatagramsReceived(size_t first_slot, size_t num_received);
+
+  const int socket_;
+  const size_t ring_size_;
+  const bool timestamps_;
+  std::unique_ptr<base::DelegateSimpleThread> receive_thread_;
+
+  std::vector<uint8_t> datagrams_;
+  std::vector<uint8_t> control_buffers_;
+  std::vector<struct iovec> iovecs_;
+  std::vector<struct mmsghdr> messages_;
+  // The size of the datagrams in the ring, 0 for truncated datagrams, which
+  // are skipped.
+  std::vector<size_t> datagram_sizes_;
+  std::vector<int64_t> receive_times_us_;
+
+  mutable base::Lock lock_;
+  // Signalled when datagrams are added to the ring or on exit of Run().
+  base::ConditionVariable datagrams_available_;
+  // Signalled when a slot of a full ring is released or when stopping.
+  base::ConditionVariable slot_available_;
+  // The number of datagrams added to and released from the ring. The ring
+  // holds the datagrams [|read_count_|, |write_count_|). The one at
+  // |read_count_| is being read and is released on the next read after it
+  // has been read entirely.
+  uint64_t read_count_ = 0;
+  uint64_t write_count_ = 0;
+  size_t read_offset_ = 0;
+  bool stopping_ = false;
+  // Set when Run() exits, with |receive_result_| 0 if it was stopped and < 0
+  // if receiving failed.
+  bool receive_done_ = false;
+  int64_t receive_result_ = 0;
+  Stats stats_;
+
+  // Only accessed by the reader.
+  int64_t receive_time_us_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_UDP_RECEIVE_RING_H_
@@ -0,0 +1,251 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/file/udp_receive_ring.h"
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "packager/file/file.h"
+#include "packager/file/file_closer.h"
+
+namespace shaka {
+
+namespace {
+
+const size_t kRingSize = 4;
+
+std::string ToString(const uint8_t* data, int64_t size) {
+  return std::string(data, data + size);
+}
+
+}  // namespace
+
+// The datagrams are sent from a loopback socket.
+class UdpReceiveRingTest : public testing::Test {
+ public:
+  void SetUp() override {
+    receive_socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(receive_socket_, 0);
+    struct sockaddr_in address = {0};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(receive_socket_,
+                      reinterpret_cast<struct sockaddr*>(&address),
+                      sizeof(address)));
+    socklen_t address_size = sizeof(receive_address_);
+    ASSERT_EQ(0, getsockname(receive_socket_,
+                             reinterpret_cast<struct sockaddr*>(
+                                 &receive_address_),
+                             &address_size));
+
+    send_socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(send_socket_, 0);
+  }
+
+  void TearDown() override {
+    ring_.reset();
+    if (receive_socket_ >= 0)
+      close(receive_socket_);
+    if (send_socket_ >= 0)
+      close(send_socket_);
+  }
+
+ protected:
+  void StartRing(bool timestamps) {
+    ring_.reset(new UdpReceiveRing(receive_socket_, kRingSize, timestamps));
+    ASSERT_TRUE(ring_->Start());
+  }
+
+  void Send(const std::string& datagram) {
+    ASSERT_EQ(static_cast<ssize_t>(datagram.size()),
+              sendto(send_socket_, datagram.data(), datagram.size(), 0,
+                     reinterpret_cast<struct sockaddr*>(&receive_address_),
+                     sizeof(receive_address_)));
+  }
+
+  // Waits until the receive thread has processed |num_datagrams| datagrams.
+  void WaitForDatagrams(uint64_t num_datagrams) {
+    for (int i = 0; i < 1000; ++i) {
+      const UdpReceiveRing::Stats stats = ring_->stats();
+      if (stats.datagrams_received + stats.datagrams_truncated >=
+          num_datagrams) {
+        return;
+      }
+      usleep(1000);
+    }
+    FAIL() << "Timed out waiting for " << num_datagrams << " datagrams.";
+  }
+
+  std::string Read(uint64_t length) {
+    const uint8_t* data = nullptr;
+    const int64_t bytes_read = ring_->ReadInPlace(&data, length);
+    EXPECT_GT(bytes_read, 0);
+    return bytes_read > 0 ? ToString(data, bytes_read) : std::string();
+  }
+
+  int receive_socket_ = -1;
+  int send_socket_ = -1;
+  struct sockaddr_in receive_address_;
+  std::unique_ptr<UdpReceiveRing> ring_;
+};
+
+TEST_F(UdpReceiveRingTest, ReadDatagrams) {
+  ASSERT_NO_FATAL_FAILURE(StartRing(false));
+  Send("datagram 1");
+  Send("datagram 2");
+
+  EXPECT_EQ("datagram 1", Read(100));
+  // A datagram can be read in several parts.
+  EXPECT_EQ("data", Read(4));
+  EXPECT_EQ("gram 2", Read(100));
+  EXPECT_EQ(0, ring_->receive_time_us());
+
+  // The datagrams received before stopping can still be read.
+  Send("datagram 3");
+  ASSERT_NO_FATAL_FAILURE(WaitForDatagrams(3));
+  ring_->Stop();
+  EXPECT_EQ("datagram 3", Read(100));
+  const uint8_t* data = nullptr;
+  EXPECT_EQ(0, ring_->ReadInPlace(&data, 100));
+
+  const UdpReceiveRing::Stats stats = ring_->stats();
+  EXPECT_EQ(3u, stats.datagrams_received);
+  EXPECT_EQ(30u, stats.bytes_received);
+  EXPECT_EQ(0u, stats.ring_overruns);
+  EXPECT_EQ(0u, stats.datagrams_truncated);
+}
+
+TEST_F(UdpReceiveRingTest, RingOverrun) {
+  ASSERT_NO_FATAL_FAILURE(StartRing(false));
+  const size_t kNumDatagrams = kRingSize + 3;
+  for (size_t i = 0; i < kNumDatagrams; ++i)
+    Send(std::to_string(i));
+  ASSERT_NO_FATAL_FAILURE(WaitForDatagrams(kRingSize));
+  for (int i = 0; i < 1000 && ring_->stats().ring_overruns == 0; ++i)
+    usleep(1000);
+  EXPECT_EQ(kRingSize, ring_->stats().datagrams_received);
+  EXPECT_EQ(1u, ring_->stats().ring_overruns);
+
+  // The datagrams received while the ring was full are queued in the socket.
+  for (size_t i = 0; i < kNumDatagrams; ++i)
+    EXPECT_EQ(std::to_string(i), Read(100));
+  EXPECT_EQ(kNumDatagrams, ring_->stats().datagrams_received);
+}
+
+TEST_F(UdpReceiveRingTest, TruncatedDatagram) {
+  ASSERT_NO_FATAL_FAILURE(StartRing(false));
+  Send(std::string(UdpReceiveRing::kMaxDatagramSize + 1, 'x'));
+  Send("datagram");
+
+  // The truncated datagram is skipped.
+  EXPECT_EQ("datagram", Read(100));
+  EXPECT_EQ(1u, ring_->stats().datagrams_truncated);
+}
+
+TEST_F(UdpReceiveRingTest, Timestamps) {
+  struct timeval now;
+  ASSERT_EQ(0, gettimeofday(&now, nullptr));
+  ASSERT_NO_FATAL_FAILURE(StartRing(true));
+  Send("datagram");
+
+  EXPECT_EQ("datagram", Read(100));
+  EXPECT_GE(ring_->receive_time_us(), now.tv_sec * INT64_C(1000000));
+}
+
+TEST_F(UdpReceiveRingTest, Timeout) {
+  struct timeval timeout = {0, 10000};
+  ASSERT_EQ(0, setsockopt(receive_socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                          sizeof(timeout)));
+  ASSERT_NO_FATAL_FAILURE(StartRing(false));
+
+  const uint8_t* data = nullptr;
+  EXPECT_LT(ring_->ReadInPlace(&data, 100), 0);
+}
+
+// Verify that UdpFile reads the datagrams from the ring, in place, if the
+// ring_size option is set.
+TEST(UdpFileTest, ReceiveRing) {
+  // Find a free port.
+  int port_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(port_socket, 0);
+  struct sockaddr_in address = {0};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_size = sizeof(address);
+  ASSERT_EQ(0, bind(port_socket, reinterpret_cast<struct sockaddr*>(&address),
+                    sizeof(address)));
+  ASSERT_EQ(0, getsockname(port_socket,
+                           reinterpret_cast<struct sockaddr*>(&address),
+                           &address_size));
+  close(port_socket);
+
+  const std::string file_name = "udp://127.0.0.1:" +
+                                std::to_string(ntohs(address.sin_port)) +
+                                "?ring_size=16&timeout=1000000";
+  std::unique_ptr<File, FileCloser> file(File::Open(file_name.c_str(), "r"));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->SupportsReadInPlace());
+  EXPECT_FALSE(file->ReadInPlaceDataStaysValid());
+
+  int send_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(send_socket, 0);
+  const std::string kDatagram = "datagram";
+  EXPECT_EQ(static_cast<ssize_t>(kDatagram.size()),
+            sendto(send_socket, kDatagram.data(), kDatagram.size(), 0,
+                   reinterpret_cast<struct sockaddr*>(&address),
+                   sizeof(address)));
+  close(send_socket);
+
+  const uint8_t* data = nullptr;
+  const int64_t bytes_read = file->ReadInPlace(&data, 100);
+  ASSERT_EQ(static_cast<int64_t>(kDatagram.size()), bytes_read);
+  EXPECT_EQ(kDatagram, ToString(data, bytes_read));
+}
+
+// Verify that UdpFile splits the data written into datagrams of at most
+// packet_size bytes.
+TEST(UdpFileTest, SendDatagrams) {
+  int receive_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(receive_socket, 0);
+  struct sockaddr_in address = {0};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_size = sizeof(address);
+  ASSERT_EQ(0, bind(receive_socket,
+                    reinterpret_cast<struct sockaddr*>(&address),
+                    sizeof(address)));
+  ASSERT_EQ(0, getsockname(receive_socket,
+                           reinterpret_cast<struct sockaddr*>(&address),
+                           &address_size));
+
+  const std::string file_name = "udp://127.0.0.1:" +
+                                std::to_string(ntohs(address.sin_port)) +
+                                "?packet_size=10";
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name.c_str(), "w"));
+  ASSERT_TRUE(file);
+  const std::string kData = "0123456789abcdefghij0123";
+  EXPECT_EQ(static_cast<int64_t>(kData.size()),
+            file->Write(kData.data(), kData.size()));
+  file.reset();
+
+  char buffer[100];
+  EXPECT_EQ(10, recv(receive_socket, buffer, sizeof(buffer), 0));
+  EXPECT_EQ("0123456789", std::string(buffer, 10));
+  EXPECT_EQ(10, recv(receive_socket, buffer, sizeof(buffer), 0));
+  EXPECT_EQ("abcdefghij", std::string(buffer, 10));
+  EXPECT_EQ(4, recv(receive_socket, buffer, sizeof(buffer), 0));
+  EXPECT_EQ("0123", std::string(buffer, 4));
+  close(receive_socket);
+}
+
+}  // namespace shaka
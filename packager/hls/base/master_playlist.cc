@@ -408,9 +408,7 @@ bool MasterPlaylist::WriteMasterPlaylist(
     const std::string& base_url,
     const std::string& output_dir,
     const std::list<MediaPlaylist*>& playlists) {
-  std::string content = "#EXTM3U\n";
-  AppendVersionString(&content);
-  AppendPlaylists(default_language_, base_url, playlists, &content);
+  const std::string content = GetPlaylistContent(base_url, playlists);
 
   // Skip if the playlist is already written.
   if (content == written_playlist_)
@@ -428,5 +426,14 @@ bool MasterPlaylist::WriteMasterPlaylist(
   return true;
 }
 
+std::string MasterPlaylist::GetPlaylistContent(
+    const std::string& base_url,
+    const std::list<MediaPlaylist*>& playlists) {
+  std::string content = "#EXTM3U\n";
+  AppendVersionString(&content);
+  AppendPlaylists(default_language_, base_url, playlists, &content);
+  return content;
+}
+
 }  // namespace hls
 }  // namespace shaka
@@ -39,6 +39,17 @@ class MasterPlaylist {
                                    const std::string& output_dir,
                                    const std::list<MediaPlaylist*>& playlists);
 
+  /// Generates the Master Playlist written by WriteMasterPlaylist, so that it
+  /// can be written by the caller.
+  /// @param base_url is the prefix for the Media Playlist files.
+  /// @return the content of the playlist.
+  virtual std::string GetPlaylistContent(
+      const std::string& base_url,
+      const std::list<MediaPlaylist*>& playlists);
+
+  /// @return the file name of the master playlist.
+  const std::string& file_name() const { return file_name_; }
+
  private:
   MasterPlaylist(const MasterPlaylist&) = delete;
   MasterPlaylist& operator=(const MasterPlaylist&) = delete;
@@ -305,13 +305,15 @@ std::string PlacementOpportunityEntry::ToString() {
   return "#EXT-X-PLACEMENT-OPPORTUNITY";
 }
 
+// |first_entry| is the index of the first entry of the window in |entries|.
 double LatestSegmentStartTime(
-    const std::list<std::unique_ptr<HlsEntry>>& entries) {
-  DCHECK(!entries.empty());
-  for (auto iter = entries.rbegin(); iter != entries.rend(); ++iter) {
-    if (iter->get()->type() == HlsEntry::EntryType::kExtInf) {
+    const std::vector<std::unique_ptr<HlsEntry>>& entries,
+    size_t first_entry) {
+  DCHECK_LT(first_entry, entries.size());
+  for (size_t i = entries.size(); i > first_entry; --i) {
+    if (entries[i - 1]->type() == HlsEntry::EntryType::kExtInf) {
       const SegmentInfoEntry* segment_info =
-          reinterpret_cast<SegmentInfoEntry*>(iter->get());
+          reinterpret_cast<SegmentInfoEntry*>(entries[i - 1].get());
       return segment_info->start_time();
     }
   }
@@ -424,7 +426,7 @@ void MediaPlaylist::AddEncryptionInfo(MediaPlaylist::EncryptionMethod method,
   if (!inserted_discontinuity_tag_) {
     // Insert discontinuity tag only for the first EXT-X-KEY, only if there
     // are non-encrypted media segments.
-    if (!entries_.empty())
+    if (entries_.size() > first_entry_)
       entries_.emplace_back(new DiscontinuityEntry());
     inserted_discontinuity_tag_ = true;
   }
@@ -437,26 +439,26 @@ void MediaPlaylist::AddPlacementOpportunity() {
 }
 
 bool MediaPlaylist::WriteToFile(const std::string& file_path) {
+  if (!File::WriteFileAtomically(file_path.c_str(), GetPlaylistContent())) {
+    LOG(ERROR) << "Failed to write playlist to: " << file_path;
+    return false;
+  }
+  return true;
+}
+
+std::string MediaPlaylist::GetPlaylistContent() {
   if (!target_duration_set_) {
     SetTargetDuration(ceil(GetLongestSegmentDuration()));
   }
 
-  std::string content = CreatePlaylistHeader(
-      media_info_, target_duration_, hls_params_.playlist_type, stream_type_,
-      media_sequence_number_, discontinuity_sequence_number_);
-
-  for (const auto& entry : entries_)
-    base::StringAppendF(&content, "%s\n", entry->ToString().c_str());
+  UpdateSerializedPlaylist();
 
+  // The end tag is only added to the content, as more entries may follow.
+  std::string content = serialized_playlist_;
   if (hls_params_.playlist_type == HlsPlaylistType::kVod) {
     content += "#EXT-X-ENDLIST\n";
   }
-
-  if (!File::WriteFileAtomically(file_path.c_str(), content)) {
-    LOG(ERROR) << "Failed to write playlist to: " << file_path;
-    return false;
-  }
-  return true;
+  return content;
 }
 
 uint64_t MediaPlaylist::MaxBitrate() const {
@@ -543,23 +545,24 @@ void MediaPlaylist::AdjustLastSegmentInfoEntryDuration(int64_t next_timestamp) {
   const double next_timestamp_seconds =
       static_cast<double>(next_timestamp) / time_scale_;
 
-  for (auto iter = entries_.rbegin(); iter != entries_.rend(); ++iter) {
-    if (iter->get()->type() == HlsEntry::EntryType::kExtInf) {
+  for (size_t i = entries_.size(); i > first_entry_; --i) {
+    if (entries_[i - 1]->type() == HlsEntry::EntryType::kExtInf) {
       SegmentInfoEntry* segment_info =
-          reinterpret_cast<SegmentInfoEntry*>(iter->get());
+          reinterpret_cast<SegmentInfoEntry*>(entries_[i - 1].get());
 
       const double segment_duration_seconds =
           next_timestamp_seconds - segment_info->start_time();
       segment_info->set_duration(segment_duration_seconds);
       longest_segment_duration_ =
           std::max(longest_segment_duration_, segment_duration_seconds);
+      InvalidateSerializedEntries(i - 1);
       break;
     }
   }
 }
 
 void MediaPlaylist::SlideWindow() {
-  DCHECK(!entries_.empty());
+  DCHECK_LT(first_entry_, entries_.size());
   if (hls_params_.time_shift_buffer_depth <= 0.0 ||
       hls_params_.playlist_type != HlsPlaylistType::kLive) {
     return;
@@ -568,38 +571,41 @@ void MediaPlaylist::SlideWindow() {
 
   // The start time of the latest segment is considered the current_play_time,
   // and this should guarantee that the latest segment will stay in the list.
-  const double current_play_time = LatestSegmentStartTime(entries_);
+  const double current_play_time =
+      LatestSegmentStartTime(entries_, first_entry_);
   if (current_play_time <= hls_params_.time_shift_buffer_depth)
     return;
 
   const double timeshift_limit =
       current_play_time - hls_params_.time_shift_buffer_depth;
 
-  // Temporary list to hold the EXT-X-KEYs. For example, this allows us to
-  // remove <3> without removing <1> and <2> below (<1> and <2> are moved to the
-  // temporary list and added back later).
+  // The EXT-X-KEYs in effect at the start of the window are kept. For example,
+  // this allows us to remove <3> without removing <1> and <2> below (<1> and
+  // <2> are moved next to <4>, which becomes the first segment).
   //    #EXT-X-KEY   <1>
   //    #EXT-X-KEY   <2>
   //    #EXTINF      <3>
   //    #EXTINF      <4>
-  std::list<std::unique_ptr<HlsEntry>> ext_x_keys;
   // Consecutive key entries are either fully removed or not removed at all.
   // Keep track of entry types so we know if it is consecutive key entries.
+  // [|keys_begin|, |keys_end|) are the latest consecutive key entries.
+  size_t keys_begin = first_entry_;
+  size_t keys_end = first_entry_;
   HlsEntry::EntryType prev_entry_type = HlsEntry::EntryType::kExtInf;
 
-  std::list<std::unique_ptr<HlsEntry>>::iterator last = entries_.begin();
-  for (; last != entries_.end(); ++last) {
-    HlsEntry::EntryType entry_type = last->get()->type();
+  size_t last = first_entry_;
+  for (; last < entries_.size(); ++last) {
+    HlsEntry::EntryType entry_type = entries_[last]->type();
     if (entry_type == HlsEntry::EntryType::kExtKey) {
       if (prev_entry_type != HlsEntry::EntryType::kExtKey)
-        ext_x_keys.clear();
-      ext_x_keys.push_back(std::move(*last));
+        keys_begin = last;
+      keys_end = last + 1;
     } else if (entry_type == HlsEntry::EntryType::kExtDiscontinuity) {
       ++discontinuity_sequence_number_;
     } else {
       DCHECK_EQ(entry_type, HlsEntry::EntryType::kExtInf);
       const SegmentInfoEntry& segment_info =
-          *reinterpret_cast<SegmentInfoEntry*>(last->get());
+          *reinterpret_cast<SegmentInfoEntry*>(entries_[last].get());
       const double last_segment_end_time =
           segment_info.start_time() + segment_info.duration();
       if (timeshift_limit < last_segment_end_time)
@@ -609,10 +615,65 @@ void MediaPlaylist::SlideWindow() {
     }
     prev_entry_type = entry_type;
   }
-  entries_.erase(entries_.begin(), last);
-  // Add key entries back.
-  entries_.insert(entries_.begin(), std::make_move_iterator(ext_x_keys.begin()),
-                  std::make_move_iterator(ext_x_keys.end()));
+
+  // Move the key entries kept to the start of the new window, then release
+  // the entries removed.
+  const size_t new_first_entry = last - (keys_end - keys_begin);
+  if (new_first_entry == first_entry_)
+    return;
+  InvalidateSerializedEntries(first_entry_);
+  if (keys_end != last) {
+    std::move_backward(entries_.begin() + keys_begin,
+                       entries_.begin() + keys_end, entries_.begin() + last);
+  }
+  for (size_t i = first_entry_; i < new_first_entry; ++i)
+    entries_[i].reset();
+  first_entry_ = new_first_entry;
+
+  // Erase the removed entries once they make up half of |entries_|, which
+  // moves the entries in the window only once per window length on average.
+  if (first_entry_ * 2 >= entries_.size()) {
+    entries_.erase(entries_.begin(), entries_.begin() + first_entry_);
+    first_entry_ = 0;
+  }
+}
+
+void MediaPlaylist::UpdateSerializedPlaylist() {
+  const std::string header = CreatePlaylistHeader(
+      media_info_, target_duration_, hls_params_.playlist_type, stream_type_,
+      media_sequence_number_, discontinuity_sequence_number_);
+  if (serialized_playlist_.compare(0, serialized_header_size_, header) != 0) {
+    serialized_playlist_.replace(0, serialized_header_size_, header);
+    serialized_header_size_ = header.size();
+  }
+
+  for (size_t i = first_entry_ + num_serialized_entries_; i < entries_.size();
+       ++i) {
+    last_serialized_entry_offset_ =
+        serialized_playlist_.size() - serialized_header_size_;
+    serialized_playlist_ += entries_[i]->ToString();
+    serialized_playlist_ += '\n';
+    ++num_serialized_entries_;
+  }
+}
+
+void MediaPlaylist::InvalidateSerializedEntries(size_t entry_index) {
+  DCHECK_GE(entry_index, first_entry_);
+  const size_t index = entry_index - first_entry_;
+  if (index >= num_serialized_entries_)
+    return;
+  if (index + 1 == num_serialized_entries_ &&
+      last_serialized_entry_offset_ != std::string::npos) {
+    // Usually the last entry is updated, e.g. the duration of the last
+    // I-Frame.
+    serialized_playlist_.resize(serialized_header_size_ +
+                                last_serialized_entry_offset_);
+    num_serialized_entries_ = index;
+  } else {
+    serialized_playlist_.resize(serialized_header_size_);
+    num_serialized_entries_ = 0;
+  }
+  last_serialized_entry_offset_ = std::string::npos;
 }
 
 void MediaPlaylist::RemoveOldSegment(int64_t start_time) {
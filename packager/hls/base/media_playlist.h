@@ -10,6 +10,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "packager/base/macros.h"
 #include "packager/hls/public/hls_params.h"
@@ -150,6 +151,11 @@ class MediaPlaylist {
   /// @return true on success, false otherwise.
   virtual bool WriteToFile(const std::string& file_path);
 
+  /// Generates the playlist written by WriteToFile, so that it can be written
+  /// by the caller. The same notes on target duration apply.
+  /// @return the content of the playlist.
+  virtual std::string GetPlaylistContent();
+
   /// If bitrate is specified in MediaInfo then it will use that value.
   /// Otherwise, returns the max bitrate.
   /// @return the max bitrate (in bits per second) of this MediaPlaylist.
@@ -197,6 +203,12 @@ class MediaPlaylist {
   // Remove elements from |entries_| for live profile. Increments
   // |sequence_number_| by the number of segments removed.
   void SlideWindow();
+  // Serialize the header and the entries not serialized yet to
+  // |serialized_playlist_|.
+  void UpdateSerializedPlaylist();
+  // Drop the serialized entry at |entry_index| in |entries_|, and the ones
+  // after it, from |serialized_playlist_|, so that they are serialized again.
+  void InvalidateSerializedEntries(size_t entry_index);
   // Remove the segment specified by |start_time|. The actual deletion can
   // happen at a later time depending on the value of
   // |preserved_segment_outside_live_window| in |hls_params_|.
@@ -230,7 +242,22 @@ class MediaPlaylist {
   bool target_duration_set_ = false;
   uint32_t target_duration_ = 0;
 
-  std::list<std::unique_ptr<HlsEntry>> entries_;
+  // The entries before |first_entry_| have been removed from the live window.
+  // They are erased in batches, so the entries in the window are not moved
+  // every time the window slides.
+  std::vector<std::unique_ptr<HlsEntry>> entries_;
+  size_t first_entry_ = 0;
+
+  // The header followed by the first |num_serialized_entries_| entries of the
+  // window, so that only the new entries are serialized on every write. The
+  // header is replaced when it changes. The entries are serialized again only
+  // when the window slides or a serialized entry is updated.
+  std::string serialized_playlist_;
+  size_t serialized_header_size_ = 0;
+  size_t num_serialized_entries_ = 0;
+  // The offset of the last serialized entry, relative to the end of the
+  // header, or npos if it is not known.
+  size_t last_serialized_entry_offset_ = std::string::npos;
   // A list to hold the file names of the segments to be removed temporarily.
   // Once a file is actually removed, it is removed from the list.
   std::list<std::string> segments_to_be_removed_;
@@ -748,6 +748,80 @@ TEST_F(LiveMediaPlaylistTest, TimeShiftedWithEncryptionInfoShifted) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// The playlist written after sliding the window again matches the playlist
+// written at once.
+TEST_F(LiveMediaPlaylistTest, TimeShiftedWrittenIncrementally) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  media_playlist_->AddEncryptionInfo(
+      MediaPlaylist::EncryptionMethod::kSampleAes, "http://example.com", "",
+      "0x12345678", "com.widevine", "1/2/4");
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  media_playlist_->AddSegment("file3.ts", 30 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  media_playlist_->AddSegment("file4.ts", 50 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/google/shaka-packager version "
+      "test\n"
+      "#EXT-X-TARGETDURATION:20\n"
+      "#EXT-X-MEDIA-SEQUENCE:2\n"
+      "#EXT-X-DISCONTINUITY-SEQUENCE:1\n"
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,"
+      "URI=\"http://example.com\",IV=0x12345678,KEYFORMATVERSIONS=\"1/2/4\","
+      "KEYFORMAT=\"com.widevine\"\n"
+      "#EXTINF:20.000,\n"
+      "file3.ts\n"
+      "#EXTINF:20.000,\n"
+      "file4.ts\n";
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
+// The key entries right before the first segment kept are already in place.
+TEST_F(LiveMediaPlaylistTest, TimeShiftedKeysBeforeFirstSegmentKept) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  media_playlist_->AddEncryptionInfo(
+      MediaPlaylist::EncryptionMethod::kSampleAes, "http://example.com", "",
+      "0x12345678", "com.widevine", "1/2/4");
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  media_playlist_->AddSegment("file3.ts", 30 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/google/shaka-packager version "
+      "test\n"
+      "#EXT-X-TARGETDURATION:20\n"
+      "#EXT-X-MEDIA-SEQUENCE:1\n"
+      "#EXT-X-DISCONTINUITY-SEQUENCE:1\n"
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,"
+      "URI=\"http://example.com\",IV=0x12345678,KEYFORMATVERSIONS=\"1/2/4\","
+      "KEYFORMAT=\"com.widevine\"\n"
+      "#EXTINF:20.000,\n"
+      "file2.ts\n"
+      "#EXTINF:20.000,\n"
+      "file3.ts\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
 class EventMediaPlaylistTest : public MediaPlaylistMultiSegmentTest {
  protected:
   EventMediaPlaylistTest()
@@ -778,6 +852,46 @@ TEST_F(EventMediaPlaylistTest, Basic) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// Only the new segments are appended on every write, but the header is updated
+// when the target duration changes.
+TEST_F(EventMediaPlaylistTest, WrittenIncrementally) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  const char kExpectedOutput1[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/google/shaka-packager version "
+      "test\n"
+      "#EXT-X-TARGETDURATION:10\n"
+      "#EXT-X-PLAYLIST-TYPE:EVENT\n"
+      "#EXTINF:10.000,\n"
+      "file1.ts\n";
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput1);
+
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  media_playlist_->SetTargetDuration(20);
+  media_playlist_->AddPlacementOpportunity();
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  const char kExpectedOutput2[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/google/shaka-packager version "
+      "test\n"
+      "#EXT-X-TARGETDURATION:20\n"
+      "#EXT-X-PLAYLIST-TYPE:EVENT\n"
+      "#EXTINF:10.000,\n"
+      "file1.ts\n"
+      "#EXTINF:20.000,\n"
+      "file2.ts\n"
+      "#EXT-X-PLACEMENT-OPPORTUNITY\n";
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput2);
+}
+
 class IFrameMediaPlaylistTest : public MediaPlaylistTest {};
 
 TEST_F(IFrameMediaPlaylistTest, MediaPlaylistType) {
@@ -875,6 +989,50 @@ TEST_F(IFrameMediaPlaylistTest, MultiSegment) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// The duration of the last I-Frame written is updated when the next segment is
+// added.
+TEST_F(IFrameMediaPlaylistTest, MultiSegmentWrittenIncrementally) {
+  valid_video_media_info_.set_reference_time_scale(90000);
+  valid_video_media_info_.set_segment_template_url("file$Number$.ts");
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+  media_playlist_->SetTargetDuration(25);
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  media_playlist_->AddKeyFrame(0, 1000, 2345);
+  media_playlist_->AddKeyFrame(2 * kTimeScale, 5000, 6345);
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  media_playlist_->AddKeyFrame(11 * kTimeScale, 1000, 2345);
+  media_playlist_->AddKeyFrame(15 * kTimeScale, 3345, 12345);
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 30 * kTimeScale,
+                              kZeroByteOffset, 5 * kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/google/shaka-packager version "
+      "test\n"
+      "#EXT-X-TARGETDURATION:25\n"
+      "#EXT-X-PLAYLIST-TYPE:VOD\n"
+      "#EXT-X-I-FRAMES-ONLY\n"
+      "#EXTINF:2.000,\n"
+      "#EXT-X-BYTERANGE:2345@1000\n"
+      "file1.ts\n"
+      "#EXTINF:9.000,\n"
+      "#EXT-X-BYTERANGE:6345@5000\n"
+      "file1.ts\n"
+      "#EXTINF:4.000,\n"
+      "#EXT-X-BYTERANGE:2345@1000\n"
+      "file2.ts\n"
+      "#EXTINF:25.000,\n"
+      "#EXT-X-BYTERANGE:12345\n"
+      "file2.ts\n"
+      "#EXT-X-ENDLIST\n";
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
 TEST_F(IFrameMediaPlaylistTest, MultiSegmentWithPlacementOpportunity) {
   valid_video_media_info_.set_reference_time_scale(90000);
   valid_video_media_info_.set_segment_template_url("file$Number$.ts");
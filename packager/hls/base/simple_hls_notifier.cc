@@ -10,12 +10,16 @@
 #include <cmath>
 
 #include "packager/base/base64.h"
+#include "packager/base/bind.h"
 #include "packager/base/files/file_path.h"
 #include "packager/base/logging.h"
 #include "packager/base/optional.h"
 #include "packager/base/strings/string_number_conversions.h"
 #include "packager/base/strings/stringprintf.h"
+#include "packager/base/time/time.h"
+#include "packager/file/file.h"
 #include "packager/hls/base/media_playlist.h"
+#include "packager/media/base/closure_thread.h"
 #include "packager/media/base/protection_system_ids.h"
 #include "packager/media/base/protection_system_specific_info.h"
 #include "packager/media/base/proto_json_util.h"
@@ -278,16 +282,31 @@ std::unique_ptr<MediaPlaylist> MediaPlaylistFactory::Create(
 
 SimpleHlsNotifier::SimpleHlsNotifier(const HlsParams& hls_params)
     : HlsNotifier(hls_params),
-      media_playlist_factory_(new MediaPlaylistFactory()) {
+      media_playlist_factory_(new MediaPlaylistFactory()),
+      writer_cv_(&lock_) {
   const base::FilePath master_playlist_path(
       base::FilePath::FromUTF8Unsafe(hls_params.master_playlist_output));
   output_dir_ = master_playlist_path.DirName().AsUTF8Unsafe();
   master_playlist_.reset(
       new MasterPlaylist(master_playlist_path.BaseName().AsUTF8Unsafe(),
                          hls_params.default_language));
+
+  // VOD playlists are only written on Flush.
+  if (hls_params.playlist_write_delay_in_seconds > 0 &&
+      hls_params.playlist_type != HlsPlaylistType::kVod) {
+    writer_thread_.reset(new media::ClosureThread(
+        "HlsPlaylistWriter",
+        base::Bind(&SimpleHlsNotifier::RunWriter, base::Unretained(this))));
+    writer_thread_->Start();
+  }
 }
 
-SimpleHlsNotifier::~SimpleHlsNotifier() {}
+SimpleHlsNotifier::~SimpleHlsNotifier() {
+  StopWriter();
+  base::AutoLock auto_lock(lock_);
+  if (!dirty_playlists_.empty() && !WriteDirtyPlaylists())
+    LOG(ERROR) << "Failed to write the remaining playlists.";
+}
 
 bool SimpleHlsNotifier::Init() {
   return true;
@@ -367,20 +386,10 @@ bool SimpleHlsNotifier::NotifyNewSegment(uint32_t stream_id,
       hls_params().playlist_type == HlsPlaylistType::kEvent) {
     // Update all playlists if target duration is updated.
     if (target_duration_updated) {
-      for (MediaPlaylist* playlist : media_playlists_) {
+      for (MediaPlaylist* playlist : media_playlists_)
         playlist->SetTargetDuration(target_duration_);
-        if (!WriteMediaPlaylist(output_dir_, playlist))
-          return false;
-      }
-    } else {
-      if (!WriteMediaPlaylist(output_dir_, media_playlist.get()))
-        return false;
-    }
-    if (!master_playlist_->WriteMasterPlaylist(hls_params().base_url,
-                                               output_dir_, media_playlists_)) {
-      LOG(ERROR) << "Failed to write master playlist.";
-      return false;
     }
+    return UpdatePlaylists(media_playlist.get(), target_duration_updated);
   }
   return true;
 }
@@ -474,9 +483,40 @@ bool SimpleHlsNotifier::NotifyEncryptionUpdate(
 }
 
 bool SimpleHlsNotifier::Flush() {
+  StopWriter();
   base::AutoLock auto_lock(lock_);
-  for (MediaPlaylist* playlist : media_playlists_) {
+  for (MediaPlaylist* playlist : media_playlists_)
     playlist->SetTargetDuration(target_duration_);
+  return UpdatePlaylists(nullptr, true);
+}
+
+bool SimpleHlsNotifier::UpdatePlaylists(MediaPlaylist* media_playlist,
+                                        bool all_media_playlists) {
+  lock_.AssertAcquired();
+  if (writer_failed_)
+    return false;
+  const bool was_clean = dirty_playlists_.empty();
+  if (all_media_playlists) {
+    dirty_playlists_.insert(media_playlists_.begin(), media_playlists_.end());
+  } else {
+    dirty_playlists_.insert(media_playlist);
+  }
+  if (writer_thread_ && !stopping_writer_) {
+    if (was_clean)
+      writer_cv_.Signal();
+    return true;
+  }
+  return WriteDirtyPlaylists();
+}
+
+bool SimpleHlsNotifier::WriteDirtyPlaylists() {
+  lock_.AssertAcquired();
+  std::set<MediaPlaylist*> dirty_playlists;
+  dirty_playlists.swap(dirty_playlists_);
+  // Keep the order the playlists were added in.
+  for (MediaPlaylist* playlist : media_playlists_) {
+    if (dirty_playlists.count(playlist) == 0)
+      continue;
     if (!WriteMediaPlaylist(output_dir_, playlist))
       return false;
   }
@@ -488,5 +528,89 @@ bool SimpleHlsNotifier::Flush() {
   return true;
 }
 
+void SimpleHlsNotifier::RenderDirtyPlaylists(
+    std::vector<PlaylistFile>* playlist_files) {
+  lock_.AssertAcquired();
+  std::set<MediaPlaylist*> dirty_playlists;
+  dirty_playlists.swap(dirty_playlists_);
+  for (MediaPlaylist* playlist : media_playlists_) {
+    if (dirty_playlists.count(playlist) == 0)
+      continue;
+    playlist_files->push_back(
+        {FilePath::FromUTF8Unsafe(output_dir_)
+             .Append(FilePath::FromUTF8Unsafe(playlist->file_name()))
+             .AsUTF8Unsafe(),
+         playlist->GetPlaylistContent()});
+  }
+  std::string content =
+      master_playlist_->GetPlaylistContent(hls_params().base_url,
+                                           media_playlists_);
+  // Skip the master playlist if it is already written.
+  if (content != written_master_playlist_) {
+    written_master_playlist_ = content;
+    playlist_files->push_back(
+        {FilePath::FromUTF8Unsafe(output_dir_)
+             .Append(FilePath::FromUTF8Unsafe(master_playlist_->file_name()))
+             .AsUTF8Unsafe(),
+         std::move(content)});
+  }
+}
+
+void SimpleHlsNotifier::RunWriter() {
+  const base::TimeDelta delay = base::TimeDelta::FromMicroseconds(
+      static_cast<int64_t>(hls_params().playlist_write_delay_in_seconds *
+                           base::Time::kMicrosecondsPerSecond));
+  base::AutoLock auto_lock(lock_);
+  while (!stopping_writer_) {
+    if (dirty_playlists_.empty()) {
+      writer_cv_.Wait();
+      continue;
+    }
+    // Let the updates of the other streams, typically for the same segment
+    // boundary, accumulate before writing.
+    const base::TimeTicks deadline = base::TimeTicks::Now() + delay;
+    base::TimeDelta remaining = delay;
+    while (!stopping_writer_ && remaining > base::TimeDelta()) {
+      writer_cv_.TimedWait(remaining);
+      remaining = deadline - base::TimeTicks::Now();
+    }
+    // The remaining dirty playlists are written by the stopping thread.
+    if (stopping_writer_)
+      break;
+    // Only the playlists are generated under |lock_|, so the notifications
+    // are not blocked by the writes. The writes stay in order as only this
+    // thread writes until it is stopped.
+    std::vector<PlaylistFile> playlist_files;
+    RenderDirtyPlaylists(&playlist_files);
+    bool written = true;
+    {
+      base::AutoUnlock auto_unlock(lock_);
+      for (const PlaylistFile& playlist_file : playlist_files) {
+        if (!File::WriteFileAtomically(playlist_file.path.c_str(),
+                                       playlist_file.content)) {
+          LOG(ERROR) << "Failed to write playlist " << playlist_file.path;
+          written = false;
+          break;
+        }
+      }
+    }
+    if (!written) {
+      writer_failed_ = true;
+      break;
+    }
+  }
+}
+
+void SimpleHlsNotifier::StopWriter() {
+  if (!writer_thread_ || writer_thread_->HasBeenJoined())
+    return;
+  {
+    base::AutoLock auto_lock(lock_);
+    stopping_writer_ = true;
+    writer_cv_.Signal();
+  }
+  writer_thread_->Join();
+}
+
 }  // namespace hls
 }  // namespace shaka
@@ -10,10 +10,12 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "packager/base/macros.h"
+#include "packager/base/synchronization/condition_variable.h"
 #include "packager/base/synchronization/lock.h"
 #include "packager/hls/base/hls_notifier.h"
 #include "packager/hls/base/master_playlist.h"
@@ -21,6 +23,11 @@
 #include "packager/hls/public/hls_params.h"
 
 namespace shaka {
+
+namespace media {
+class ClosureThread;
+}  // namespace media
+
 namespace hls {
 
 /// For testing.
@@ -34,7 +41,8 @@ class MediaPlaylistFactory {
                                                 const std::string& group_id);
 };
 
-/// This is thread safe.
+/// This is thread safe. If HlsParams::playlist_write_delay_in_seconds is
+/// positive, live and event playlists are written on a dedicated thread.
 class SimpleHlsNotifier : public HlsNotifier {
  public:
   /// @param hls_params contains parameters for setting up the notifier.
@@ -72,6 +80,28 @@ class SimpleHlsNotifier : public HlsNotifier {
  private:
   friend class SimpleHlsNotifierTest;
 
+  // Writes |media_playlist|, or all the media playlists if
+  // |all_media_playlists| is true, and the master playlist. The writes are
+  // left to |writer_thread_| if it is running.
+  // Must be called with |lock_| held.
+  bool UpdatePlaylists(MediaPlaylist* media_playlist, bool all_media_playlists);
+  // Writes the dirty playlists. Must be called with |lock_| held.
+  bool WriteDirtyPlaylists();
+  // A playlist generated by |writer_thread_|, to be written without |lock_|
+  // held.
+  struct PlaylistFile {
+    std::string path;
+    std::string content;
+  };
+  // Generates the dirty playlists, and the master playlist if it changed.
+  // Must be called with |lock_| held.
+  void RenderDirtyPlaylists(std::vector<PlaylistFile>* playlist_files);
+  // The main loop of |writer_thread_|.
+  void RunWriter();
+  // Stops |writer_thread_|, leaving the remaining dirty playlists to the
+  // caller. Must be called without |lock_| held.
+  void StopWriter();
+
   struct StreamEntry {
     std::unique_ptr<MediaPlaylist> media_playlist;
     MediaPlaylist::EncryptionMethod encryption_method;
@@ -91,6 +121,23 @@ class SimpleHlsNotifier : public HlsNotifier {
 
   base::Lock lock_;
 
+  // Writes the playlists asynchronously. Not created if the playlists are
+  // written synchronously.
+  std::unique_ptr<media::ClosureThread> writer_thread_;
+  // Protected by |lock_|. Signaled when playlists become dirty or
+  // |writer_thread_| is stopping.
+  base::ConditionVariable writer_cv_;
+  // Protected by |lock_|. The media playlists updated but not yet written. The
+  // master playlist is written with them.
+  std::set<MediaPlaylist*> dirty_playlists_;
+  // Protected by |lock_|. The master playlist last generated by
+  // |writer_thread_|.
+  std::string written_master_playlist_;
+  bool stopping_writer_ = false;
+  // Protected by |lock_|. Set if |writer_thread_| failed to write a playlist,
+  // which is reported by the next update.
+  bool writer_failed_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(SimpleHlsNotifier);
 };
 
@@ -12,6 +12,8 @@
 
 #include "packager/base/base64.h"
 #include "packager/base/files/file_path.h"
+#include "packager/base/synchronization/waitable_event.h"
+#include "packager/file/file.h"
 #include "packager/hls/base/mock_media_playlist.h"
 #include "packager/hls/base/simple_hls_notifier.h"
 #include "packager/media/base/protection_system_ids.h"
@@ -24,9 +26,12 @@ namespace shaka {
 namespace hls {
 
 using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::DoAll;
 using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::InSequence;
+using ::testing::InvokeWithoutArgs;
 using ::testing::Mock;
 using ::testing::Property;
 using ::testing::Return;
@@ -51,6 +56,9 @@ class MockMasterPlaylist : public MasterPlaylist {
                bool(const std::string& prefix,
                     const std::string& output_dir,
                     const std::list<MediaPlaylist*>& playlists));
+  MOCK_METHOD2(GetPlaylistContent,
+               std::string(const std::string& prefix,
+                           const std::list<MediaPlaylist*>& playlists));
 };
 
 class MockMediaPlaylistFactory : public MediaPlaylistFactory {
@@ -74,6 +82,7 @@ const double kTestTimeShiftBufferDepth = 1800.0;
 const char kTestPrefix[] = "http://testprefix.com/";
 const char kEmptyPrefix[] = "";
 const char kAnyOutputDir[] = "anything";
+const char kMemoryOutputDir[] = "memory://output/";
 
 const uint64_t kAnyStartTime = 10;
 const uint64_t kAnyDuration = 1000;
@@ -675,14 +684,14 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
   // SetTargetDuration and update all playlists as target duration is updated.
   EXPECT_CALL(*mock_media_playlist1, SetTargetDuration(kTargetDuration))
       .Times(1);
+  EXPECT_CALL(*mock_media_playlist2, SetTargetDuration(kTargetDuration))
+      .Times(1);
   EXPECT_CALL(*mock_media_playlist1,
               WriteToFile(StrEq(
                   base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
                       .Append(base::FilePath::FromUTF8Unsafe("playlist1.m3u8"))
                       .AsUTF8Unsafe())))
       .WillOnce(Return(true));
-  EXPECT_CALL(*mock_media_playlist2, SetTargetDuration(kTargetDuration))
-      .Times(1);
   EXPECT_CALL(*mock_media_playlist2,
               WriteToFile(StrEq(
                   base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
@@ -713,6 +722,125 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
                                         kDuration, 0, kSize));
 }
 
+// The writer thread does not write the playlists before the delay expires,
+// so the updates are coalesced into the writes done on Flush.
+TEST_P(LiveOrEventSimpleHlsNotifierTest, AsyncWriterCoalescesUpdates) {
+  const uint64_t kStartTime = 1328;
+  const uint64_t kDuration = 398407;
+  const uint64_t kSize = 6595840;
+  const double kLongestSegmentDuration = 11.3;
+
+  std::unique_ptr<MockMasterPlaylist> mock_master_playlist(
+      new MockMasterPlaylist());
+  std::unique_ptr<MockMediaPlaylistFactory> factory(
+      new MockMediaPlaylistFactory());
+
+  // Pointer released by SimpleHlsNotifier.
+  MockMediaPlaylist* mock_media_playlist1 =
+      new MockMediaPlaylist("playlist1.m3u8", "", "");
+  MockMediaPlaylist* mock_media_playlist2 =
+      new MockMediaPlaylist("playlist2.m3u8", "", "");
+
+  EXPECT_CALL(*factory, CreateMock(_, StrEq("playlist1.m3u8"), _, _))
+      .WillOnce(Return(mock_media_playlist1));
+  EXPECT_CALL(*factory, CreateMock(_, StrEq("playlist2.m3u8"), _, _))
+      .WillOnce(Return(mock_media_playlist2));
+  for (MockMediaPlaylist* playlist :
+       {mock_media_playlist1, mock_media_playlist2}) {
+    EXPECT_CALL(*playlist, SetMediaInfo(_)).WillOnce(Return(true));
+    EXPECT_CALL(*playlist, GetLongestSegmentDuration())
+        .WillRepeatedly(Return(kLongestSegmentDuration));
+    EXPECT_CALL(*playlist, SetTargetDuration(_)).Times(AnyNumber());
+    EXPECT_CALL(*playlist, WriteToFile(_)).WillOnce(Return(true));
+  }
+  EXPECT_CALL(*mock_media_playlist1, AddSegment(_, _, _, _, _)).Times(2);
+  EXPECT_CALL(*mock_media_playlist2, AddSegment(_, _, _, _, _)).Times(1);
+  EXPECT_CALL(*mock_master_playlist, WriteMasterPlaylist(_, _, _))
+      .WillOnce(Return(true));
+
+  hls_params_.playlist_type = GetParam();
+  hls_params_.playlist_write_delay_in_seconds = 1000;
+  SimpleHlsNotifier notifier(hls_params_);
+  InjectMasterPlaylist(std::move(mock_master_playlist), &notifier);
+  InjectMediaPlaylistFactory(std::move(factory), &notifier);
+  EXPECT_TRUE(notifier.Init());
+
+  MediaInfo media_info;
+  uint32_t stream_id1;
+  EXPECT_TRUE(notifier.NotifyNewStream(media_info, "playlist1.m3u8", "name",
+                                       "groupid", &stream_id1));
+  uint32_t stream_id2;
+  EXPECT_TRUE(notifier.NotifyNewStream(media_info, "playlist2.m3u8", "name",
+                                       "groupid", &stream_id2));
+
+  EXPECT_TRUE(notifier.NotifyNewSegment(stream_id1, "segment1", kStartTime,
+                                        kDuration, 0, kSize));
+  EXPECT_TRUE(notifier.NotifyNewSegment(stream_id2, "segment1", kStartTime,
+                                        kDuration, 0, kSize));
+  EXPECT_TRUE(notifier.NotifyNewSegment(stream_id1, "segment2",
+                                        kStartTime + kDuration, kDuration, 0,
+                                        kSize));
+  EXPECT_TRUE(notifier.Flush());
+}
+
+TEST_P(LiveOrEventSimpleHlsNotifierTest, AsyncWriterWritesAfterDelay) {
+  std::unique_ptr<MockMasterPlaylist> mock_master_playlist(
+      new MockMasterPlaylist());
+  std::unique_ptr<MockMediaPlaylistFactory> factory(
+      new MockMediaPlaylistFactory());
+
+  // Pointer released by SimpleHlsNotifier.
+  MockMediaPlaylist* mock_media_playlist =
+      new MockMediaPlaylist("playlist.m3u8", "", "");
+
+  EXPECT_CALL(*mock_media_playlist, SetMediaInfo(_)).WillOnce(Return(true));
+  EXPECT_CALL(*factory, CreateMock(_, _, _, _))
+      .WillOnce(Return(mock_media_playlist));
+  EXPECT_CALL(*mock_media_playlist, AddSegment(_, _, _, _, _));
+  EXPECT_CALL(*mock_media_playlist, GetLongestSegmentDuration())
+      .WillRepeatedly(Return(11.3));
+  EXPECT_CALL(*mock_media_playlist, SetTargetDuration(_)).Times(AnyNumber());
+
+  base::WaitableEvent written(base::WaitableEvent::ResetPolicy::MANUAL,
+                              base::WaitableEvent::InitialState::NOT_SIGNALED);
+  // Generated and written by the writer thread, then written again on Flush.
+  EXPECT_CALL(*mock_media_playlist, GetPlaylistContent())
+      .WillOnce(Return("media playlist"));
+  EXPECT_CALL(*mock_master_playlist, GetPlaylistContent(_, _))
+      .WillOnce(DoAll(InvokeWithoutArgs(&written, &base::WaitableEvent::Signal),
+                      Return("master playlist")));
+  EXPECT_CALL(*mock_media_playlist, WriteToFile(_)).WillOnce(Return(true));
+  EXPECT_CALL(*mock_master_playlist, WriteMasterPlaylist(_, _, _))
+      .WillOnce(Return(true));
+
+  hls_params_.playlist_type = GetParam();
+  hls_params_.master_playlist_output =
+      std::string(kMemoryOutputDir) + kMasterPlaylistName;
+  hls_params_.playlist_write_delay_in_seconds = 0.01;
+  SimpleHlsNotifier notifier(hls_params_);
+  InjectMasterPlaylist(std::move(mock_master_playlist), &notifier);
+  InjectMediaPlaylistFactory(std::move(factory), &notifier);
+  EXPECT_TRUE(notifier.Init());
+  MediaInfo media_info;
+  uint32_t stream_id;
+  EXPECT_TRUE(notifier.NotifyNewStream(media_info, "playlist.m3u8", "name",
+                                       "groupid", &stream_id));
+
+  EXPECT_TRUE(
+      notifier.NotifyNewSegment(stream_id, "segmentname", 1328, 398407, 0, 10));
+  written.Wait();
+  EXPECT_TRUE(notifier.Flush());
+
+  std::string content;
+  ASSERT_TRUE(File::ReadFileToString(
+      (std::string(kMemoryOutputDir) + "playlist.m3u8").c_str(), &content));
+  EXPECT_EQ("media playlist", content);
+  ASSERT_TRUE(File::ReadFileToString(
+      (std::string(kMemoryOutputDir) + kMasterPlaylistName).c_str(),
+      &content));
+  EXPECT_EQ("master playlist", content);
+}
+
 INSTANTIATE_TEST_CASE_P(PlaylistTypes,
                         LiveOrEventSimpleHlsNotifierTest,
                         ::testing::Values(HlsPlaylistType::kLive,
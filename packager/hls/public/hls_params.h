@@ -46,6 +46,11 @@ struct HlsParams {
   /// in 'EXT-X-MEDIA' tag. This allows the player to choose the correct default
   /// language for the content.
   std::string default_language;
+  /// If positive, live and event playlists are written on a dedicated thread
+  /// instead of on the thread notifying the new segment. The updates arriving
+  /// within this delay, in seconds, are coalesced, so each playlist is written
+  /// at most once per delay. The playlists are written synchronously if zero.
+  double playlist_write_delay_in_seconds = 0;
 };
 
 }  // namespace shaka
@@ -10,6 +10,7 @@
 #include <openssl/err.h>
 #include <openssl/rand.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -64,6 +65,36 @@ bool AesCryptor::Crypt(const std::string& text, std::string* crypt_text) {
   return true;
 }
 
+bool AesCryptor::CryptPattern(const uint8_t* text,
+                              size_t text_size,
+                              size_t crypt_byte_size,
+                              size_t skip_byte_size,
+                              uint8_t* crypt_text) {
+  const size_t pattern_size = crypt_byte_size + skip_byte_size;
+  DCHECK_GT(pattern_size, 0u);
+  DCHECK_LE(crypt_byte_size, text_size % pattern_size == 0
+                                 ? pattern_size
+                                 : text_size % pattern_size)
+      << "The last crypted range should be complete.";
+  if (constant_iv_flag_ == kUseConstantIv) {
+    SetIvInternal();
+  } else {
+    const size_t num_patterns = (text_size + pattern_size - 1) / pattern_size;
+    num_crypt_bytes_ += num_patterns * crypt_byte_size;
+  }
+  return CryptPatternInternal(text, text_size, crypt_byte_size, skip_byte_size,
+                              crypt_text);
+}
+
+bool AesCryptor::SkipBytes(size_t num_bytes) {
+  // A constant iv restarts the key stream on every Crypt call, so there is
+  // no position to move.
+  if (constant_iv_flag_ == kUseConstantIv || !SkipBytesInternal(num_bytes))
+    return false;
+  num_crypt_bytes_ += num_bytes;
+  return true;
+}
+
 bool AesCryptor::SetIv(const std::vector<uint8_t>& iv) {
   if (!IsIvSizeValid(iv.size())) {
     LOG(ERROR) << "Invalid IV size: " << iv.size();
@@ -123,6 +154,57 @@ bool AesCryptor::GenerateRandomIv(FourCC protection_scheme,
   return true;
 }
 
+bool AesCryptor::CryptPatternInternal(const uint8_t* text,
+                                      size_t text_size,
+                                      size_t crypt_byte_size,
+                                      size_t skip_byte_size,
+                                      uint8_t* crypt_text) {
+  const bool in_place = text == crypt_text;
+  for (size_t offset = 0; offset < text_size;) {
+    size_t crypt_text_size = crypt_byte_size;
+    if (!CryptInternal(text + offset, crypt_byte_size, crypt_text + offset,
+                       &crypt_text_size)) {
+      return false;
+    }
+    DCHECK_EQ(crypt_byte_size, crypt_text_size);
+    offset += crypt_byte_size;
+
+    const size_t clear_size = std::min(skip_byte_size, text_size - offset);
+    if (!in_place)
+      memcpy(crypt_text + offset, text + offset, clear_size);
+    offset += clear_size;
+  }
+  return true;
+}
+
+bool AesCryptor::CbcCryptPattern(const uint8_t* text,
+                                 size_t text_size,
+                                 size_t crypt_byte_size,
+                                 size_t skip_byte_size,
+                                 int enc,
+                                 uint8_t* iv,
+                                 uint8_t* crypt_text) {
+  DCHECK(aes_key());
+  DCHECK_EQ(0u, crypt_byte_size % AES_BLOCK_SIZE);
+
+  const bool in_place = text == crypt_text;
+  for (size_t offset = 0; offset < text_size;) {
+    AES_cbc_encrypt(text + offset, crypt_text + offset, crypt_byte_size,
+                    aes_key(), iv, enc);
+    offset += crypt_byte_size;
+
+    const size_t clear_size = std::min(skip_byte_size, text_size - offset);
+    if (!in_place)
+      memcpy(crypt_text + offset, text + offset, clear_size);
+    offset += clear_size;
+  }
+  return true;
+}
+
+bool AesCryptor::SkipBytesInternal(size_t num_bytes) {
+  return false;
+}
+
 size_t AesCryptor::NumPaddingBytes(size_t size) const {
   // No padding by default.
   return 0;
@@ -68,6 +68,30 @@ class AesCryptor {
   }
   /// @}
 
+  /// Crypt (Encrypt/Decrypt) @a text with a repeating pattern, i.e. the first
+  /// @a crypt_byte_size bytes of every (@a crypt_byte_size +
+  /// @a skip_byte_size) bytes are crypted and the remaining bytes are left in
+  /// clear. The cryptor state, i.e. the counter or the cipher block chain, is
+  /// carried across the crypted ranges. The text and crypt_text pointers can
+  /// be the same address for in place encryption/decryption, in which case the
+  /// clear ranges are not touched.
+  /// @param text_size should be such that every crypted range is complete.
+  ///        The last clear range can be partial.
+  /// @param crypt_text should have at least @a text_size bytes.
+  bool CryptPattern(const uint8_t* text,
+                    size_t text_size,
+                    size_t crypt_byte_size,
+                    size_t skip_byte_size,
+                    uint8_t* crypt_text);
+
+  /// Move the crypt position @a num_bytes bytes forward without crypting, as
+  /// if @a num_bytes bytes had been crypted. It is only supported by counter
+  /// mode cryptors, whose key stream can be generated from any position, so
+  /// different parts of a sample can be crypted by different cryptors.
+  /// @return true on success, false if the cryptor does not support it, in
+  ///         which case the cryptor is left unchanged.
+  bool SkipBytes(size_t num_bytes);
+
   /// Set IV. SetIv() implementation guarantees that the iv passed to SetIv()
   /// is set to iv() and then calls SetIvInternal().
   /// @return true if successful, false if the input is invalid.
@@ -95,6 +119,18 @@ class AesCryptor {
   const AES_KEY* aes_key() const { return aes_key_.get(); }
   AES_KEY* mutable_aes_key() { return aes_key_.get(); }
 
+  // Pattern crypt implementation shared by the CBC encryptor and decryptor.
+  // It walks the whole range in one pass, chaining |iv| across the crypted
+  // ranges, and leaves the clear ranges alone. |enc| is AES_ENCRYPT or
+  // AES_DECRYPT. See CryptPattern for the other parameters.
+  bool CbcCryptPattern(const uint8_t* text,
+                       size_t text_size,
+                       size_t crypt_byte_size,
+                       size_t skip_byte_size,
+                       int enc,
+                       uint8_t* iv,
+                       uint8_t* crypt_text);
+
  private:
   // Internal implementation of crypt function.
   // |text| points to the input text.
@@ -111,6 +147,20 @@ class AesCryptor {
                              uint8_t* crypt_text,
                              size_t* crypt_text_size) = 0;
 
+  // Internal implementation of the pattern crypt function. See CryptPattern
+  // for the parameters. The default implementation calls CryptInternal on
+  // every crypted range. Cryptors with a cheaper way of processing many small
+  // ranges should override it.
+  virtual bool CryptPatternInternal(const uint8_t* text,
+                                    size_t text_size,
+                                    size_t crypt_byte_size,
+                                    size_t skip_byte_size,
+                                    uint8_t* crypt_text);
+
+  // Internal implementation of SkipBytes. The default implementation does not
+  // support skipping and returns false.
+  virtual bool SkipBytesInternal(size_t num_bytes);
+
   // Internal implementation of SetIv, which setup internal iv.
   virtual void SetIvInternal() = 0;
 
@@ -5,11 +5,13 @@
 // https://developers.google.com/open-source/licenses/bsd
 
 #include <gtest/gtest.h>
+#include <openssl/aes.h>
 
 #include <memory>
 
 #include "packager/base/logging.h"
 #include "packager/base/strings/string_number_conversions.h"
+#include "packager/base/time/time.h"
 #include "packager/media/base/aes_decryptor.h"
 #include "packager/media/base/aes_encryptor.h"
 
@@ -84,6 +86,11 @@ const uint8_t kIv64MaxMinusOne[] = {0xff, 0xff, 0xff, 0xff,
                                     0xff, 0xff, 0xff, 0xfe};
 const uint8_t kIv64Max[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 
+// The lower 64 bits of the counter wrap after three blocks.
+const uint8_t kIv128Max64MinusTwo[] = {0,    0,    0,    0,    0,    0,
+                                       0,    0,    0xff, 0xff, 0xff, 0xff,
+                                       0xff, 0xff, 0xff, 0xfd};
+
 // We support AES 128, i.e. 16 bytes key only.
 const uint8_t kInvalidKey[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2,
                                0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09};
@@ -92,6 +99,32 @@ const uint8_t kInvalidKey[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2,
 const uint8_t kInvalidIv[] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
                               0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe};
 
+// Reference AES-CTR implementation which generates and applies the key stream
+// one block and one byte at a time. Used to verify the bulk implementation.
+void ReferenceAesCtrCrypt(const std::vector<uint8_t>& key,
+                          const std::vector<uint8_t>& iv,
+                          const std::vector<uint8_t>& text,
+                          std::vector<uint8_t>* crypt_text) {
+  AES_KEY aes_key;
+  CHECK_EQ(0, AES_set_encrypt_key(key.data(), key.size() * 8, &aes_key));
+  std::vector<uint8_t> counter(iv);
+  counter.resize(kAesBlockSize, 0);
+  uint8_t encrypted_counter[kAesBlockSize];
+
+  crypt_text->resize(text.size());
+  for (size_t i = 0; i < text.size(); ++i) {
+    const size_t block_offset = i % kAesBlockSize;
+    if (block_offset == 0) {
+      AES_encrypt(counter.data(), encrypted_counter, &aes_key);
+      for (int j = kAesBlockSize - 1; j >= 8; --j) {
+        if (++counter[j] != 0)
+          break;
+      }
+    }
+    (*crypt_text)[i] = text[i] ^ encrypted_counter[block_offset];
+  }
+}
+
 }  // namespace
 
 namespace shaka {
@@ -215,6 +248,112 @@ TEST_F(AesCtrEncryptorTest, UnsupportedIV) {
   ASSERT_FALSE(encryptor_.InitializeWithIv(key_, iv));
 }
 
+TEST_F(AesCtrEncryptorTest, BulkEncryptionMatchesReference) {
+  const size_t kTextSize = 4096 + 7;
+  std::vector<uint8_t> plaintext(kTextSize);
+  for (size_t i = 0; i < kTextSize; ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 31);
+
+  std::vector<uint8_t> iv(kIv128Max64MinusTwo,
+                          kIv128Max64MinusTwo + arraysize(kIv128Max64MinusTwo));
+  std::vector<uint8_t> expected;
+  ReferenceAesCtrCrypt(key_, iv, plaintext, &expected);
+
+  // Encrypt the whole buffer at once.
+  ASSERT_TRUE(encryptor_.InitializeWithIv(key_, iv));
+  std::vector<uint8_t> encrypted;
+  ASSERT_TRUE(encryptor_.Crypt(plaintext, &encrypted));
+  EXPECT_EQ(expected, encrypted);
+
+  // Encrypt in pieces not aligned to the block size, as done for subsamples.
+  const size_t kPieceSizes[] = {5, 11, 2000, 1, 33, 16, 2037};
+  ASSERT_TRUE(encryptor_.InitializeWithIv(key_, iv));
+  std::vector<uint8_t> encrypted_in_pieces(kTextSize);
+  size_t offset = 0;
+  for (size_t piece_size : kPieceSizes) {
+    ASSERT_TRUE(encryptor_.Crypt(&plaintext[offset], piece_size,
+                                 &encrypted_in_pieces[offset]));
+    offset += piece_size;
+    EXPECT_EQ(offset % kAesBlockSize, encryptor_.block_offset());
+  }
+  ASSERT_EQ(kTextSize, offset);
+  EXPECT_EQ(expected, encrypted_in_pieces);
+}
+
+// Every piece is encrypted by its own encryptor, which skips the bytes before
+// the piece, as done for the parts of a sample encrypted in parallel.
+TEST_F(AesCtrEncryptorTest, SkipBytesMatchesReference) {
+  const size_t kTextSize = 4096 + 7;
+  std::vector<uint8_t> plaintext(kTextSize);
+  for (size_t i = 0; i < kTextSize; ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 31);
+
+  std::vector<uint8_t> iv(kIv128Max64MinusTwo,
+                          kIv128Max64MinusTwo + arraysize(kIv128Max64MinusTwo));
+  std::vector<uint8_t> expected;
+  ReferenceAesCtrCrypt(key_, iv, plaintext, &expected);
+
+  const size_t kPieceSizes[] = {5, 11, 2000, 1, 33, 16, 2037};
+  std::vector<uint8_t> encrypted_in_pieces(kTextSize);
+  size_t offset = 0;
+  for (size_t piece_size : kPieceSizes) {
+    AesCtrEncryptor piece_encryptor;
+    ASSERT_TRUE(piece_encryptor.InitializeWithIv(key_, iv));
+    // Skip in two steps, so skipping from a partial block is covered too.
+    ASSERT_TRUE(piece_encryptor.SkipBytes(offset / 2));
+    ASSERT_TRUE(piece_encryptor.SkipBytes(offset - offset / 2));
+    EXPECT_EQ(offset % kAesBlockSize, piece_encryptor.block_offset());
+    ASSERT_TRUE(piece_encryptor.Crypt(&plaintext[offset], piece_size,
+                                      &encrypted_in_pieces[offset]));
+    offset += piece_size;
+  }
+  ASSERT_EQ(kTextSize, offset);
+  EXPECT_EQ(expected, encrypted_in_pieces);
+
+  // The skipped bytes count for the next iv, like the crypted bytes.
+  ASSERT_TRUE(encryptor_.InitializeWithIv(key_, iv));
+  ASSERT_TRUE(encryptor_.Crypt(plaintext, &expected));
+  encryptor_.UpdateIv();
+  AesCtrEncryptor skipping_encryptor;
+  ASSERT_TRUE(skipping_encryptor.InitializeWithIv(key_, iv));
+  ASSERT_TRUE(skipping_encryptor.SkipBytes(kTextSize));
+  skipping_encryptor.UpdateIv();
+  EXPECT_EQ(encryptor_.iv(), skipping_encryptor.iv());
+}
+
+TEST_F(AesCtrEncryptorTest, SkipBytesNotSupportedInCbcMode) {
+  AesCbcEncryptor encryptor(kNoPadding);
+  ASSERT_TRUE(encryptor.InitializeWithIv(key_, std::vector<uint8_t>(16, 0)));
+  EXPECT_FALSE(encryptor.SkipBytes(kAesBlockSize));
+}
+
+// Reports AES-CTR throughput of the reference byte-wise implementation and of
+// AesCtrEncryptor. Run with --gtest_also_run_disabled_tests.
+TEST_F(AesCtrEncryptorTest, DISABLED_Throughput) {
+  const size_t kTextSize = 4 * 1024 * 1024;
+  const int kIterations = 32;
+  std::vector<uint8_t> plaintext(kTextSize, 0x5a);
+  std::vector<uint8_t> encrypted;
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    ReferenceAesCtrCrypt(key_, iv_, plaintext, &encrypted);
+  const double reference_seconds =
+      (base::TimeTicks::Now() - start).InSecondsF();
+
+  start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    ASSERT_TRUE(encryptor_.SetIv(iv_));
+    ASSERT_TRUE(encryptor_.Crypt(plaintext, &encrypted));
+  }
+  const double bulk_seconds = (base::TimeTicks::Now() - start).InSecondsF();
+
+  const double total_gb = static_cast<double>(kTextSize) * kIterations / 1e9;
+  LOG(INFO) << "Reference AES-CTR: " << total_gb / reference_seconds
+            << " GB/s.";
+  LOG(INFO) << "AesCtrEncryptor: " << total_gb / bulk_seconds << " GB/s.";
+}
+
 // Subsample test cases.
 struct SubsampleTestCase {
   const uint8_t* subsample_sizes;
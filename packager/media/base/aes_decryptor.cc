@@ -97,7 +97,10 @@ bool AesCbcDecryptor::CryptInternal(const uint8_t* ciphertext,
                     internal_iv_.data(), AES_DECRYPT);
 
     // The residual block is not encrypted.
-    memcpy(plaintext + cbc_size, ciphertext + cbc_size, residual_block_size);
+    if (plaintext != ciphertext) {
+      memcpy(plaintext + cbc_size, ciphertext + cbc_size,
+             residual_block_size);
+    }
     return true;
   } else if (padding_scheme_ != kCtsPadding) {
     LOG(ERROR) << "Expecting cipher text size to be multiple of "
@@ -108,7 +111,8 @@ bool AesCbcDecryptor::CryptInternal(const uint8_t* ciphertext,
   DCHECK_EQ(padding_scheme_, kCtsPadding);
   if (ciphertext_size < AES_BLOCK_SIZE) {
     // Don't have a full block, leave unencrypted.
-    memcpy(plaintext, ciphertext, ciphertext_size);
+    if (plaintext != ciphertext)
+      memcpy(plaintext, ciphertext, ciphertext_size);
     return true;
   }
 
@@ -153,6 +157,16 @@ bool AesCbcDecryptor::CryptInternal(const uint8_t* ciphertext,
   return true;
 }
 
+bool AesCbcDecryptor::CryptPatternInternal(const uint8_t* text,
+                                           size_t text_size,
+                                           size_t crypt_byte_size,
+                                           size_t skip_byte_size,
+                                           uint8_t* crypt_text) {
+  DCHECK_EQ(padding_scheme_, kNoPadding);
+  return CbcCryptPattern(text, text_size, crypt_byte_size, skip_byte_size,
+                         AES_DECRYPT, internal_iv_.data(), crypt_text);
+}
+
 void AesCbcDecryptor::SetIvInternal() {
   internal_iv_ = iv();
   internal_iv_.resize(AES_BLOCK_SIZE, 0);
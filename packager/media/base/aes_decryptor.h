@@ -53,6 +53,11 @@ class AesCbcDecryptor : public AesCryptor {
                      size_t ciphertext_size,
                      uint8_t* plaintext,
                      size_t* plaintext_size) override;
+  bool CryptPatternInternal(const uint8_t* text,
+                            size_t text_size,
+                            size_t crypt_byte_size,
+                            size_t skip_byte_size,
+                            uint8_t* crypt_text) override;
   void SetIvInternal() override;
 
   const CbcPaddingScheme padding_scheme_;
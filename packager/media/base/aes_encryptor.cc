@@ -8,6 +8,9 @@
 
 #include <openssl/aes.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "packager/base/logging.h"
 
 namespace {
@@ -22,6 +25,29 @@ bool Increment64(uint8_t* counter) {
   return true;
 }
 
+// Add |num_blocks| to the 8-byte counter, wrapping around at 2^64.
+void Add64(uint64_t num_blocks, uint8_t* counter) {
+  DCHECK(counter);
+  for (int i = 7; i >= 0 && num_blocks > 0; --i) {
+    num_blocks += counter[i];
+    counter[i] = num_blocks & 0xFF;
+    num_blocks >>= 8;
+  }
+}
+
+// Return the number of blocks that can be processed with an 8-byte counter
+// before it wraps around to 0.
+uint64_t NumBlocksBeforeWrap64(const uint8_t* counter) {
+  DCHECK(counter);
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i)
+    value = (value << 8) | counter[i];
+  // The counter wraps after (2^64 - value) blocks. A zero counter has 2^64
+  // blocks to go, which is capped to the maximum of uint64_t.
+  const uint64_t num_blocks = ~value + 1;
+  return num_blocks == 0 ? std::numeric_limits<uint64_t>::max() : num_blocks;
+}
+
 // AES defines three key sizes: 128, 192 and 256 bits.
 bool IsKeySizeValidForAes(size_t key_size) {
   return key_size == 16 || key_size == 24 || key_size == 32;
@@ -74,18 +100,79 @@ bool AesCtrEncryptor::CryptInternal(const uint8_t* plaintext,
   }
   *ciphertext_size = plaintext_size;
 
-  for (size_t i = 0; i < plaintext_size; ++i) {
-    if (block_offset_ == 0) {
-      AES_encrypt(&counter_[0], &encrypted_counter_[0], aes_key());
-      // As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter
-      // block, bytes 8 to 15 (i.e. the least significant bytes) are used as a
-      // simple 64 bit unsigned integer that is incremented by one for each
-      // subsequent block of sample data processed and is kept in network byte
-      // order.
-      Increment64(&counter_[8]);
-    }
-    ciphertext[i] = plaintext[i] ^ encrypted_counter_[block_offset_];
+  // Consume the remaining bytes of the previous partial block first, so
+  // |block_offset_| is carried across Crypt calls, e.g. across subsamples.
+  size_t pos = 0;
+  while (block_offset_ != 0 && pos < plaintext_size) {
+    ciphertext[pos] = plaintext[pos] ^ encrypted_counter_[block_offset_];
     block_offset_ = (block_offset_ + 1) % AES_BLOCK_SIZE;
+    ++pos;
+  }
+
+  // Process all the full blocks in bulk. AES_ctr128_encrypt generates the key
+  // stream for many counter blocks at once (using AES-NI if available) and
+  // XORs it in whole words, but it increments the counter as a 128-bit
+  // integer. As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte
+  // counter block, bytes 8 to 15 (i.e. the least significant bytes) are used
+  // as a simple 64 bit unsigned integer that is incremented by one for each
+  // subsequent block of sample data processed and is kept in network byte
+  // order. So the bulk operation is split at the 64-bit wrap point and the
+  // upper 8 bytes are restored afterwards.
+  size_t num_blocks = (plaintext_size - pos) / AES_BLOCK_SIZE;
+  while (num_blocks > 0) {
+    const size_t num_blocks_to_crypt =
+        std::min<uint64_t>(num_blocks, NumBlocksBeforeWrap64(&counter_[8]));
+    const size_t crypt_size = num_blocks_to_crypt * AES_BLOCK_SIZE;
+
+    uint8_t counter_high[8];
+    memcpy(counter_high, &counter_[0], sizeof(counter_high));
+    unsigned int num = 0;
+    AES_ctr128_encrypt(plaintext + pos, ciphertext + pos, crypt_size,
+                       aes_key(), &counter_[0], &encrypted_counter_[0], &num);
+    DCHECK_EQ(0u, num);
+    memcpy(&counter_[0], counter_high, sizeof(counter_high));
+
+    pos += crypt_size;
+    num_blocks -= num_blocks_to_crypt;
+  }
+
+  // Encrypt the trailing partial block, if any, and leave |block_offset_|
+  // pointing into it for the next Crypt call.
+  if (pos < plaintext_size) {
+    DCHECK_EQ(0u, block_offset_);
+    AES_encrypt(&counter_[0], &encrypted_counter_[0], aes_key());
+    Increment64(&counter_[8]);
+    while (pos < plaintext_size) {
+      ciphertext[pos] = plaintext[pos] ^ encrypted_counter_[block_offset_];
+      ++block_offset_;
+      ++pos;
+    }
+    DCHECK_LT(block_offset_, static_cast<uint32_t>(AES_BLOCK_SIZE));
+  }
+  return true;
+}
+
+bool AesCtrEncryptor::SkipBytesInternal(size_t num_bytes) {
+  // Use up the remaining bytes of the current partial block first.
+  if (block_offset_ != 0) {
+    const size_t bytes_left_in_block = AES_BLOCK_SIZE - block_offset_;
+    if (num_bytes < bytes_left_in_block) {
+      block_offset_ += static_cast<uint32_t>(num_bytes);
+      return true;
+    }
+    num_bytes -= bytes_left_in_block;
+    block_offset_ = 0;
+  }
+
+  Add64(num_bytes / AES_BLOCK_SIZE, &counter_[8]);
+
+  // Land in the middle of the next block, the same way CryptInternal leaves a
+  // trailing partial block.
+  const size_t partial_block_size = num_bytes % AES_BLOCK_SIZE;
+  if (partial_block_size > 0) {
+    AES_encrypt(&counter_[0], &encrypted_counter_[0], aes_key());
+    Increment64(&counter_[8]);
+    block_offset_ = static_cast<uint32_t>(partial_block_size);
   }
   return true;
 }
@@ -184,6 +271,16 @@ bool AesCbcEncryptor::CryptInternal(const uint8_t* plaintext,
   return true;
 }
 
+bool AesCbcEncryptor::CryptPatternInternal(const uint8_t* text,
+                                           size_t text_size,
+                                           size_t crypt_byte_size,
+                                           size_t skip_byte_size,
+                                           uint8_t* crypt_text) {
+  DCHECK_EQ(padding_scheme_, kNoPadding);
+  return CbcCryptPattern(text, text_size, crypt_byte_size, skip_byte_size,
+                         AES_ENCRYPT, internal_iv_.data(), crypt_text);
+}
+
 void AesCbcEncryptor::SetIvInternal() {
   internal_iv_ = iv();
   internal_iv_.resize(AES_BLOCK_SIZE, 0);
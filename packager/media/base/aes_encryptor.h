@@ -51,6 +51,7 @@ class AesCtrEncryptor : public AesEncryptor {
                      size_t plaintext_size,
                      uint8_t* ciphertext,
                      size_t* ciphertext_size) override;
+  bool SkipBytesInternal(size_t num_bytes) override;
   void SetIvInternal() override;
 
   // Current block offset.
@@ -99,6 +100,11 @@ class AesCbcEncryptor : public AesEncryptor {
                      size_t plaintext_size,
                      uint8_t* ciphertext,
                      size_t* ciphertext_size) override;
+  bool CryptPatternInternal(const uint8_t* text,
+                            size_t text_size,
+                            size_t crypt_byte_size,
+                            size_t skip_byte_size,
+                            uint8_t* crypt_text) override;
   void SetIvInternal() override;
   size_t NumPaddingBytes(size_t size) const override;
 
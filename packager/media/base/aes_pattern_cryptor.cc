@@ -49,43 +49,46 @@ bool AesPatternCryptor::CryptInternal(const uint8_t* text,
   }
   *crypt_text_size = text_size;
 
-  while (text_size > 0) {
-    const size_t crypt_byte_size = crypt_byte_block_ * AES_BLOCK_SIZE;
+  const size_t crypt_byte_size = crypt_byte_block_ * AES_BLOCK_SIZE;
+  const size_t skip_byte_size = skip_byte_block_ * AES_BLOCK_SIZE;
 
-    if (text_size <= crypt_byte_size) {
-      const bool need_encrypt =
-          encryption_mode_ != kSkipIfCryptByteBlockRemaining &&
-          text_size >= AES_BLOCK_SIZE;
-      if (need_encrypt) {
-        // The partial pattern SHALL be followed with the partial 16-byte block
-        // remains unencrypted.
-        const size_t aligned_crypt_byte_size =
-            text_size / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
-        if (!cryptor_->Crypt(text, aligned_crypt_byte_size, crypt_text))
-          return false;
-        text += aligned_crypt_byte_size;
-        text_size -= aligned_crypt_byte_size;
-        crypt_text += aligned_crypt_byte_size;
-      }
-
-      // The remaining bytes are not encrypted.
-      memcpy(crypt_text, text, text_size);
-      return true;
+  // Hand all the complete patterns, i.e. the ones with a full crypt byte
+  // block followed by a possibly partial skip byte block, to the cryptor in
+  // one go, so the whole range is walked in a single pass.
+  if (text_size > crypt_byte_size) {
+    const size_t pattern_size = crypt_byte_size + skip_byte_size;
+    const size_t num_patterns =
+        (text_size - crypt_byte_size + pattern_size - 1) / pattern_size;
+    const size_t pattern_bytes =
+        std::min(num_patterns * pattern_size, text_size);
+    if (!cryptor_->CryptPattern(text, pattern_bytes, crypt_byte_size,
+                                skip_byte_size, crypt_text)) {
+      return false;
     }
+    text += pattern_bytes;
+    text_size -= pattern_bytes;
+    crypt_text += pattern_bytes;
+  }
+  DCHECK_LE(text_size, crypt_byte_size);
 
-    if (!cryptor_->Crypt(text, crypt_byte_size, crypt_text))
+  const bool need_encrypt =
+      encryption_mode_ != kSkipIfCryptByteBlockRemaining &&
+      text_size >= AES_BLOCK_SIZE;
+  if (need_encrypt) {
+    // The partial pattern SHALL be followed with the partial 16-byte block
+    // remains unencrypted.
+    const size_t aligned_crypt_byte_size =
+        text_size / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
+    if (!cryptor_->Crypt(text, aligned_crypt_byte_size, crypt_text))
       return false;
-    text += crypt_byte_size;
-    text_size -= crypt_byte_size;
-    crypt_text += crypt_byte_size;
-
-    const size_t skip_byte_size = std::min(
-        static_cast<size_t>(skip_byte_block_ * AES_BLOCK_SIZE), text_size);
-    memcpy(crypt_text, text, skip_byte_size);
-    text += skip_byte_size;
-    text_size -= skip_byte_size;
-    crypt_text += skip_byte_size;
+    text += aligned_crypt_byte_size;
+    text_size -= aligned_crypt_byte_size;
+    crypt_text += aligned_crypt_byte_size;
   }
+
+  // The remaining bytes are not encrypted.
+  if (text != crypt_text)
+    memcpy(crypt_text, text, text_size);
   return true;
 }
 
@@ -8,6 +8,8 @@
 #include <gtest/gtest.h>
 
 #include "packager/base/strings/string_number_conversions.h"
+#include "packager/media/base/aes_decryptor.h"
+#include "packager/media/base/aes_encryptor.h"
 #include "packager/media/base/aes_pattern_cryptor.h"
 #include "packager/media/base/mock_aes_cryptor.h"
 
@@ -208,5 +210,61 @@ TEST(SampleAesPatternCryptor, MoreThan16Bytes) {
   ASSERT_TRUE(pattern_cryptor.Crypt("0123456789abcdef012", &crypt_text));
 }
 
+TEST(AesPatternCryptorCbcsTest, MatchesPerBlockCbcEncryption) {
+  const uint8_t kCbcsCryptByteBlock = 1;
+  const uint8_t kCbcsSkipByteBlock = 9;
+  const size_t kBlockSize = 16;
+  const std::vector<uint8_t> key(16, 'k');
+  const std::vector<uint8_t> iv(16, 'i');
+
+  // 6 full patterns, a partial skip byte block and a partial block.
+  const size_t kTextSize = 6 * 10 * kBlockSize + 3 * kBlockSize + 5;
+  std::vector<uint8_t> text(kTextSize);
+  for (size_t i = 0; i < kTextSize; ++i)
+    text[i] = static_cast<uint8_t>(i);
+
+  // Expected output: only the first block of every 10 blocks is encrypted,
+  // with the cipher block chain carried across the encrypted blocks.
+  AesCbcEncryptor cbc_encryptor(kNoPadding, AesCryptor::kDontUseConstantIv);
+  ASSERT_TRUE(cbc_encryptor.InitializeWithIv(key, iv));
+  std::vector<uint8_t> expected(text);
+  for (size_t offset = 0; offset + kBlockSize <= kTextSize;
+       offset += 10 * kBlockSize) {
+    ASSERT_TRUE(
+        cbc_encryptor.Crypt(&text[offset], kBlockSize, &expected[offset]));
+  }
+
+  AesPatternCryptor pattern_encryptor(
+      kCbcsCryptByteBlock, kCbcsSkipByteBlock,
+      AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCbcEncryptor(
+          kNoPadding, AesCryptor::kDontUseConstantIv)));
+  ASSERT_TRUE(pattern_encryptor.InitializeWithIv(key, iv));
+
+  // Out of place.
+  std::vector<uint8_t> encrypted(kTextSize);
+  ASSERT_TRUE(pattern_encryptor.Crypt(text.data(), text.size(),
+                                      encrypted.data()));
+  EXPECT_EQ(expected, encrypted);
+
+  // In place.
+  std::vector<uint8_t> buffer(text);
+  ASSERT_TRUE(
+      pattern_encryptor.Crypt(buffer.data(), buffer.size(), buffer.data()));
+  EXPECT_EQ(expected, buffer);
+
+  AesPatternCryptor pattern_decryptor(
+      kCbcsCryptByteBlock, kCbcsSkipByteBlock,
+      AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCbcDecryptor(
+          kNoPadding, AesCryptor::kDontUseConstantIv)));
+  ASSERT_TRUE(pattern_decryptor.InitializeWithIv(key, iv));
+  ASSERT_TRUE(
+      pattern_decryptor.Crypt(buffer.data(), buffer.size(), buffer.data()));
+  EXPECT_EQ(text, buffer);
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -24,12 +24,16 @@ ByteQueue::~ByteQueue() {}
 void ByteQueue::Reset() {
   offset_ = 0;
   used_ = 0;
+  in_place_data_ = nullptr;
 }
 
 void ByteQueue::Push(const uint8_t* data, int size) {
   DCHECK(data);
   DCHECK_GT(size, 0);
 
+  if (in_place_data_)
+    CopyInPlaceData();
+
   size_t size_needed = used_ + size;
 
   // Check to see if we need a bigger buffer.
@@ -45,18 +49,31 @@ void ByteQueue::Push(const uint8_t* data, int size) {
 
     // Copy the data from the old buffer to the start of the new one.
     if (used_ > 0)
-      memcpy(new_buffer.get(), front(), used_);
+      memcpy(new_buffer.get(), buffer_.get() + offset_, used_);
 
     buffer_.reset(new_buffer.release());
     size_ = new_size;
     offset_ = 0;
   } else if ((offset_ + used_ + size) > size_) {
     // The buffer is big enough, but we need to move the data in the queue.
-    memmove(buffer_.get(), front(), used_);
+    memmove(buffer_.get(), buffer_.get() + offset_, used_);
     offset_ = 0;
   }
 
-  memcpy(front() + used_, data, size);
+  memcpy(buffer_.get() + offset_ + used_, data, size);
+  used_ += size;
+}
+
+void ByteQueue::PushInPlace(const uint8_t* data, int size) {
+  DCHECK(data);
+  DCHECK_GT(size, 0);
+
+  if (used_ == 0) {
+    in_place_data_ = data;
+  } else if (!in_place_data_ || in_place_data_ + used_ != data) {
+    Push(data, size);
+    return;
+  }
   used_ += size;
 }
 
@@ -70,6 +87,14 @@ void ByteQueue::Peek(const uint8_t** data, int* size) const {
 void ByteQueue::Pop(int count) {
   DCHECK_LE(count, used_);
 
+  if (in_place_data_) {
+    in_place_data_ += count;
+    used_ -= count;
+    if (used_ == 0)
+      in_place_data_ = nullptr;
+    return;
+  }
+
   offset_ += count;
   used_ -= count;
 
@@ -80,8 +105,18 @@ void ByteQueue::Pop(int count) {
   }
 }
 
-uint8_t* ByteQueue::front() const {
-  return buffer_.get() + offset_;
+const uint8_t* ByteQueue::front() const {
+  return in_place_data_ ? in_place_data_ : buffer_.get() + offset_;
+}
+
+void ByteQueue::CopyInPlaceData() {
+  DCHECK(in_place_data_);
+  const uint8_t* data = in_place_data_;
+  const int size = used_;
+  in_place_data_ = nullptr;
+  offset_ = 0;
+  used_ = 0;
+  Push(data, size);
 }
 
 }  // namespace media
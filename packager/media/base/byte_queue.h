@@ -30,6 +30,13 @@ class ByteQueue {
   /// Append new bytes to the end of the queue.
   void Push(const uint8_t* data, int size);
 
+  /// Append new bytes to the end of the queue, without copying them if
+  /// possible. The bytes are referenced in place if the queue is empty or if
+  /// they directly follow the bytes already referenced, and copied otherwise.
+  /// @param data must stay valid, at the same address, until the queue is
+  ///        reset or destroyed.
+  void PushInPlace(const uint8_t* data, int size);
+
   /// Get a pointer to the front of the queue and the queue size.
   /// These values are only valid until the next Push() or Pop() call.
   void Peek(const uint8_t** data, int* size) const;
@@ -40,7 +47,10 @@ class ByteQueue {
 
  private:
   // Returns a pointer to the front of the queue.
-  uint8_t* front() const;
+  const uint8_t* front() const;
+
+  // Copies the bytes referenced in place to |buffer_|.
+  void CopyInPlaceData();
 
   std::unique_ptr<uint8_t[]> buffer_;
 
@@ -53,6 +63,10 @@ class ByteQueue {
   // Number of bytes stored in the queue.
   int used_;
 
+  // If not null, the queue references |used_| bytes at this address instead
+  // of storing them in |buffer_|.
+  const uint8_t* in_place_data_ = nullptr;
+
   DISALLOW_COPY_AND_ASSIGN(ByteQueue);
 };
 
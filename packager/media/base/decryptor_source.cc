@@ -39,7 +39,9 @@ bool DecryptorSource::DecryptSampleBuffer(const DecryptConfig* decrypt_config,
   DCHECK(encrypted_buffer);
   DCHECK(decrypted_buffer);
 
-  if (CheckMemoryOverlap(encrypted_buffer, buffer_size, decrypted_buffer)) {
+  const bool in_place = encrypted_buffer == decrypted_buffer;
+  if (!in_place &&
+      CheckMemoryOverlap(encrypted_buffer, buffer_size, decrypted_buffer)) {
     LOG(ERROR) << "Encrypted buffer and decrypted buffer cannot overlap.";
     return false;
   }
@@ -119,7 +121,8 @@ bool DecryptorSource::DecryptSampleBuffer(const DecryptConfig* decrypt_config,
       LOG(ERROR) << "Subsamples overflow sample buffer.";
       return false;
     }
-    memcpy(decrypted_buffer, current_ptr, subsample.clear_bytes);
+    if (!in_place)
+      memcpy(decrypted_buffer, current_ptr, subsample.clear_bytes);
     current_ptr += subsample.clear_bytes;
     decrypted_buffer += subsample.clear_bytes;
     if (!decryptor->Crypt(current_ptr, subsample.cipher_bytes,
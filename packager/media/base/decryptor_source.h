@@ -30,10 +30,11 @@ class DecryptorSource {
   /// @param decrypt_config contains decrypt configuration, e.g. protection
   ///        scheme, subsample information etc.
   /// @param encrypted_buffer points to the encrypted buffer that is to be
-  ///        decrypted. It should not overlap with @a decrypted_buffer.
+  ///        decrypted. It should either be @a decrypted_buffer, to decrypt in
+  ///        place, or not overlap with it.
   /// @param buffer_size is the size of encrypted buffer and decrypted buffer.
-  /// @param decrypted_buffer points to the decrypted buffer. It should not
-  ///        overlap with @a encrypted_buffer.
+  /// @param decrypted_buffer points to the decrypted buffer. It should either
+  ///        be @a encrypted_buffer or not overlap with it.
   /// @return true if success, false otherwise.
   bool DecryptSampleBuffer(const DecryptConfig* decrypt_config,
                            const uint8_t* encrypted_buffer,
@@ -10,6 +10,7 @@
 #include <gtest/gtest.h>
 
 #include "packager/base/macros.h"
+#include "packager/media/base/aes_encryptor.h"
 #include "packager/media/base/raw_key_source.h"
 
 using ::testing::Return;
@@ -177,6 +178,88 @@ TEST_F(DecryptorSourceTest, DecryptFailedIfGetKeyFailed) {
       &decrypted_buffer_[0]));
 }
 
+TEST_F(DecryptorSourceTest, InPlaceFullSampleDecryption) {
+  EncryptionKey encryption_key;
+  encryption_key.key.assign(kMockKey, kMockKey + arraysize(kMockKey));
+  EXPECT_CALL(mock_key_source_, GetKey(key_id_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(encryption_key), Return(Status::OK)));
+
+  DecryptConfig decrypt_config(key_id_,
+                               std::vector<uint8_t>(kIv, kIv + arraysize(kIv)),
+                               std::vector<SubsampleEntry>());
+  ASSERT_TRUE(decryptor_source_.DecryptSampleBuffer(
+      &decrypt_config, &encrypted_buffer_[0], encrypted_buffer_.size(),
+      &encrypted_buffer_[0]));
+  EXPECT_EQ(std::vector<uint8_t>(
+                kExpectedDecryptedBuffer,
+                kExpectedDecryptedBuffer + arraysize(kExpectedDecryptedBuffer)),
+            encrypted_buffer_);
+}
+
+TEST_F(DecryptorSourceTest, InPlaceSubsampleDecryption) {
+  EncryptionKey encryption_key;
+  encryption_key.key.assign(kMockKey, kMockKey + arraysize(kMockKey));
+  EXPECT_CALL(mock_key_source_, GetKey(key_id_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(encryption_key), Return(Status::OK)));
+
+  const SubsampleEntry kSubsamples[] = {
+    {2, 3},
+    {3, 13},
+  };
+  DecryptConfig decrypt_config(
+      key_id_, std::vector<uint8_t>(kIv, kIv + arraysize(kIv)),
+      std::vector<SubsampleEntry>(kSubsamples,
+                                  kSubsamples + arraysize(kSubsamples)));
+  ASSERT_TRUE(decryptor_source_.DecryptSampleBuffer(
+      &decrypt_config, &encrypted_buffer_[0], encrypted_buffer_.size(),
+      &decrypted_buffer_[0]));
+
+  // Same result as decrypting to another buffer.
+  std::vector<uint8_t> buffer(kBuffer, kBuffer + arraysize(kBuffer));
+  ASSERT_TRUE(decryptor_source_.DecryptSampleBuffer(
+      &decrypt_config, &buffer[0], buffer.size(), &buffer[0]));
+  EXPECT_EQ(decrypted_buffer_, buffer);
+}
+
+// Covers the unencrypted residual block of 'cbc1' in place.
+TEST_F(DecryptorSourceTest, InPlaceCbc1Decryption) {
+  EncryptionKey encryption_key;
+  encryption_key.key.assign(kMockKey, kMockKey + arraysize(kMockKey));
+  EXPECT_CALL(mock_key_source_, GetKey(key_id_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(encryption_key), Return(Status::OK)));
+
+  const std::vector<uint8_t> iv(16, 0x42);
+  const size_t kSampleSize = 100;
+  std::vector<uint8_t> clear_sample(kSampleSize);
+  for (size_t i = 0; i < kSampleSize; ++i)
+    clear_sample[i] = static_cast<uint8_t>(i * 7);
+  const SubsampleEntry kSubsamples[] = {
+    {10, 40},
+    {5, 45},
+  };
+
+  std::vector<uint8_t> sample(clear_sample);
+  AesCbcEncryptor encryptor(kNoPadding);
+  ASSERT_TRUE(encryptor.InitializeWithIv(encryption_key.key, iv));
+  size_t offset = 0;
+  for (const SubsampleEntry& subsample : kSubsamples) {
+    offset += subsample.clear_bytes;
+    ASSERT_TRUE(encryptor.Crypt(&sample[offset], subsample.cipher_bytes,
+                                &sample[offset]));
+    offset += subsample.cipher_bytes;
+  }
+  ASSERT_NE(clear_sample, sample);
+
+  DecryptConfig decrypt_config(
+      key_id_, iv,
+      std::vector<SubsampleEntry>(kSubsamples,
+                                  kSubsamples + arraysize(kSubsamples)),
+      FOURCC_cbc1, 0, 0);
+  ASSERT_TRUE(decryptor_source_.DecryptSampleBuffer(
+      &decrypt_config, &sample[0], sample.size(), &sample[0]));
+  EXPECT_EQ(clear_sample, sample);
+}
+
 TEST_F(DecryptorSourceTest, EncryptedBufferAndDecryptedBufferOverlap) {
   DecryptConfig decrypt_config(key_id_,
                                std::vector<uint8_t>(kIv, kIv + arraysize(kIv)),
@@ -0,0 +1,78 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/gather_list.h"
+
+#include <iterator>
+
+#include "packager/base/logging.h"
+#include "packager/file/file.h"
+#include "packager/media/base/buffer_writer.h"
+
+namespace shaka {
+namespace media {
+
+GatherList::GatherList() {}
+GatherList::~GatherList() {}
+
+void GatherList::AppendBuffer(BufferWriter* buffer) {
+  DCHECK(buffer);
+  if (buffer->Size() == 0)
+    return;
+  std::shared_ptr<std::vector<uint8_t>> owned_data =
+      std::make_shared<std::vector<uint8_t>>();
+  buffer->SwapBuffer(owned_data.get());
+  const size_t size = owned_data->size();
+  // The block points to the vector data and owns the vector.
+  const uint8_t* data = owned_data->data();
+  blocks_.push_back({std::shared_ptr<const uint8_t>(owned_data, data), size});
+  size_ += size;
+}
+
+void GatherList::AppendSharedData(std::shared_ptr<const uint8_t> data,
+                                  size_t size) {
+  if (size == 0)
+    return;
+  DCHECK(data);
+  blocks_.push_back({std::move(data), size});
+  size_ += size;
+}
+
+void GatherList::AppendList(GatherList* list) {
+  DCHECK(list);
+  if (blocks_.empty()) {
+    blocks_.swap(list->blocks_);
+  } else {
+    blocks_.insert(blocks_.end(),
+                   std::make_move_iterator(list->blocks_.begin()),
+                   std::make_move_iterator(list->blocks_.end()));
+  }
+  size_ += list->size_;
+  list->Clear();
+}
+
+void GatherList::Clear() {
+  blocks_.clear();
+  size_ = 0;
+}
+
+Status GatherList::WriteToFile(File* file) {
+  DCHECK(file);
+
+  std::vector<File::GatherBuffer> buffers;
+  buffers.reserve(blocks_.size());
+  for (const Block& block : blocks_)
+    buffers.push_back({block.data.get(), block.size});
+  const int64_t size_written = file->WriteGathered(buffers);
+  if (size_written < 0 || static_cast<size_t>(size_written) != size_) {
+    return Status(error::FILE_FAILURE, "Fail to write to file in GatherList");
+  }
+  Clear();
+  return Status::OK;
+}
+
+}  // namespace media
+}  // namespace shaka
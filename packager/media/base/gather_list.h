@@ -0,0 +1,69 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_GATHER_LIST_H_
+#define PACKAGER_MEDIA_BASE_GATHER_LIST_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "packager/status.h"
+
+namespace shaka {
+class File;
+
+namespace media {
+
+class BufferWriter;
+
+/// A list of blocks of data which are written to a file at once, with
+/// File::WriteGathered, without being copied into a single buffer first.
+/// The blocks are either moved from a BufferWriter, e.g. for box headers, or
+/// shared with their owner, e.g. for media sample data.
+class GatherList {
+ public:
+  GatherList();
+  ~GatherList();
+
+  /// Append the contents of @a buffer, which is left empty. The data is moved,
+  /// not copied.
+  void AppendBuffer(BufferWriter* buffer);
+
+  /// Append @a size bytes at @a data, which is kept alive by the list.
+  void AppendSharedData(std::shared_ptr<const uint8_t> data, size_t size);
+
+  /// Append the blocks of @a list, which is left empty.
+  void AppendList(GatherList* list);
+
+  void Clear();
+
+  /// @return the total size of the blocks, in bytes.
+  size_t Size() const { return size_; }
+
+  /// Write the blocks to file. The list is cleared after writing.
+  /// @param file should not be NULL.
+  /// @return OK on success.
+  Status WriteToFile(File* file);
+
+ private:
+  GatherList(const GatherList&) = delete;
+  GatherList& operator=(const GatherList&) = delete;
+
+  struct Block {
+    std::shared_ptr<const uint8_t> data;
+    size_t size;
+  };
+
+  std::vector<Block> blocks_;
+  size_t size_ = 0;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_GATHER_LIST_H_
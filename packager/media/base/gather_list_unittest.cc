@@ -0,0 +1,69 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/gather_list.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "packager/file/file.h"
+#include "packager/file/file_closer.h"
+#include "packager/file/memory_file.h"
+#include "packager/media/base/buffer_writer.h"
+#include "packager/status_test_util.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+const char kOutputFileName[] = "memory://gather_list_output";
+
+std::shared_ptr<const uint8_t> MakeSharedData(const std::string& data) {
+  std::shared_ptr<uint8_t> shared_data(new uint8_t[data.size()],
+                                       std::default_delete<uint8_t[]>());
+  std::copy(data.begin(), data.end(), shared_data.get());
+  return shared_data;
+}
+
+}  // namespace
+
+TEST(GatherListTest, WriteToFile) {
+  GatherList list;
+  BufferWriter header;
+  header.AppendString("header,");
+  list.AppendBuffer(&header);
+  EXPECT_EQ(0u, header.Size());
+
+  std::shared_ptr<const uint8_t> sample_data = MakeSharedData("sample1,");
+  list.AppendSharedData(sample_data, 8);
+  // The list keeps a reference to the data.
+  EXPECT_EQ(2, sample_data.use_count());
+
+  GatherList other_list;
+  other_list.AppendSharedData(MakeSharedData("sample2"), 7);
+  list.AppendList(&other_list);
+  EXPECT_EQ(0u, other_list.Size());
+  EXPECT_EQ(22u, list.Size());
+
+  std::unique_ptr<File, FileCloser> file(File::Open(kOutputFileName, "w"));
+  ASSERT_TRUE(file);
+  ASSERT_OK(list.WriteToFile(file.get()));
+  EXPECT_EQ(0u, list.Size());
+  EXPECT_EQ(1, sample_data.use_count());
+  file.reset();
+
+  std::string output;
+  ASSERT_TRUE(File::ReadFileToString(kOutputFileName, &output));
+  EXPECT_EQ("header,sample1,sample2", output);
+  MemoryFile::Delete(kOutputFileName);
+}
+
+}  // namespace media
+}  // namespace shaka
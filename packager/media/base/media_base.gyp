@@ -47,6 +47,8 @@
         'decryptor_source.h',
         'encryption_config.h',
         'fourccs.h',
+        'gather_list.cc',
+        'gather_list.h',
         'http_key_fetcher.cc',
         'http_key_fetcher.h',
         'id3_tag.cc',
@@ -78,6 +80,8 @@
         'playready_key_source.h',
         'playready_pssh_generator.cc',
         'playready_pssh_generator.h',
+        'prefetching_key_source.cc',
+        'prefetching_key_source.h',
         'producer_consumer_queue.h',
         'protection_system_ids.h',
         'protection_system_specific_info.cc',
@@ -96,6 +100,8 @@
         'request_signer.h',
         'rsa_key.cc',
         'rsa_key.h',
+        'sample_buffer_pool.cc',
+        'sample_buffer_pool.h',
         'stream_info.cc',
         'stream_info.h',
         'text_sample.cc',
@@ -111,19 +117,35 @@
         'widevine_key_source.cc',
         'widevine_key_source.h',
         'widevine_pssh_generator.cc',
-        'widevine_pssh_generator.h'
+        'widevine_pssh_generator.h',
+        'worker_pool.cc',
+        'worker_pool.h',
       ],
       'dependencies': [
+        'key_cache_proto',
         'widevine_common_encryption_proto',
         'widevine_pssh_data_proto',
         '../../base/base.gyp:base',
         '../../packager.gyp:status',
         '../../third_party/boringssl/boringssl.gyp:boringssl',
         '../../third_party/curl/curl.gyp:libcurl',
+        '../../third_party/gflags/gflags.gyp:gflags',
         '../../third_party/libxml/libxml.gyp:libxml',
         '../../version/version.gyp:version',
       ],
     },
+    {
+      'target_name': 'key_cache_proto',
+      'type': '<(component)',
+      'sources': ['key_cache.proto'],
+      'variables': {
+        'proto_in_dir': '.',
+        'proto_out_dir': 'packager/media/base',
+      },
+      'includes': [
+        '../../protoc.gypi',
+      ],
+    },
     {
       'target_name': 'widevine_pssh_data_proto',
       'type': '<(component)',
@@ -173,27 +195,32 @@
         'closure_thread_unittest.cc',
         'container_names_unittest.cc',
         'decryptor_source_unittest.cc',
+        'gather_list_unittest.cc',
         'http_key_fetcher_unittest.cc',
         'id3_tag_unittest.cc',
         'muxer_util_unittest.cc',
         'offset_byte_queue_unittest.cc',
+        'prefetching_key_source_unittest.cc',
         'producer_consumer_queue_unittest.cc',
         'protection_system_specific_info_unittest.cc',
         'pssh_generator_unittest.cc',
         'raw_key_source_unittest.cc',
         'rsa_key_unittest.cc',
+        'sample_buffer_pool_unittest.cc',
         'status_test_util_unittest.cc',
         'test/fake_prng.cc',  # For rsa_key_unittest
         'test/fake_prng.h',   # For rsa_key_unittest
         'test/rsa_test_data.cc',  # For rsa_key_unittest
         'test/rsa_test_data.h',   # For rsa_key_unittest
         'widevine_key_source_unittest.cc',
+        'worker_pool_unittest.cc',
       ],
       'dependencies': [
         '../../file/file.gyp:file',
         '../../testing/gmock.gyp:gmock',
         '../../testing/gtest.gyp:gtest',
         '../../third_party/boringssl/boringssl.gyp:boringssl',
+        '../../third_party/gflags/gflags.gyp:gflags',
         '../test/media_test.gyp:media_test_support',
         'media_base',
       ],
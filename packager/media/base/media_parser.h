@@ -62,6 +62,31 @@ class MediaParser {
   /// @return true if successful.
   virtual bool Parse(const uint8_t* buf, int size) WARN_UNUSED_RESULT = 0;
 
+  /// Same as Parse(), except that @a buf stays valid, at the same address,
+  /// until the parser is destroyed, so the parser may reference the data
+  /// instead of copying it. The default implementation calls Parse().
+  /// @return true if successful.
+  virtual bool ParseInPlace(const uint8_t* buf, int size) WARN_UNUSED_RESULT {
+    return Parse(buf, size);
+  }
+
+  /// @return true if the parser reads the media directly from the input file
+  ///         instead of consuming the data passed to Parse(), e.g. to read it
+  ///         out of file order. ParseDirectly() is then called instead of
+  ///         Parse() until it reports the end of the stream.
+  virtual bool ReadsInputDirectly() const { return false; }
+
+  /// Read and parse the next part of the input file. Only called if
+  /// ReadsInputDirectly() is true.
+  /// @param eos is set to true if the end of the stream is reached.
+  /// @return true if successful.
+  virtual bool ParseDirectly(bool* eos) WARN_UNUSED_RESULT { return false; }
+
+  /// Tell the parser that the samples of @a track_id are not needed. Parsers
+  /// reading the input directly may then skip reading them altogether. It
+  /// should be called from the init callback.
+  virtual void DisableTrack(uint32_t track_id) {}
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MediaParser);
 };
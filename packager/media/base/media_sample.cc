@@ -10,6 +10,7 @@
 
 #include "packager/base/logging.h"
 #include "packager/base/strings/stringprintf.h"
+#include "packager/media/base/sample_buffer_pool.h"
 
 namespace shaka {
 namespace media {
@@ -26,8 +27,8 @@ MediaSample::MediaSample(const uint8_t* data,
 
   SetData(data, data_size);
   if (side_data) {
-    std::shared_ptr<uint8_t> shared_side_data(new uint8_t[side_data_size],
-                                              std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> shared_side_data =
+        SampleBufferPool::GetInstance()->Allocate(side_data_size);
     memcpy(shared_side_data.get(), side_data, side_data_size);
     side_data_ = std::move(shared_side_data);
     side_data_size_ = side_data_size;
@@ -100,6 +101,14 @@ std::shared_ptr<MediaSample> MediaSample::Clone() const {
   return new_media_sample;
 }
 
+uint8_t* MediaSample::writable_data() {
+  DCHECK(!end_of_stream());
+  // Copy on write if the buffer is shared.
+  if (data_.use_count() > 1)
+    SetData(data_.get(), data_size_);
+  return data_.get();
+}
+
 void MediaSample::TransferData(std::shared_ptr<uint8_t> data,
                                size_t data_size) {
   data_ = std::move(data);
@@ -107,8 +116,8 @@ void MediaSample::TransferData(std::shared_ptr<uint8_t> data,
 }
 
 void MediaSample::SetData(const uint8_t* data, size_t data_size) {
-  std::shared_ptr<uint8_t> shared_data(new uint8_t[data_size],
-                                       std::default_delete<uint8_t[]>());
+  std::shared_ptr<uint8_t> shared_data =
+      SampleBufferPool::GetInstance()->Allocate(data_size);
   memcpy(shared_data.get(), data, data_size);
   TransferData(std::move(shared_data), data_size);
 }
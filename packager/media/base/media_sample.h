@@ -124,6 +124,19 @@ class MediaSample {
     return data_size_;
   }
 
+  /// @return the sample data buffer, which can be kept alive by the caller
+  ///         instead of copying the data. writable_data() copies the buffer
+  ///         before modifying it if it is still referenced.
+  std::shared_ptr<const uint8_t> shared_data() const {
+    DCHECK(!end_of_stream());
+    return data_;
+  }
+
+  /// @return a writable pointer to the sample data. If the data buffer is
+  ///         shared with other owners, e.g. with a MediaSample it is cloned
+  ///         from, it is copied first so the other owners are not affected.
+  uint8_t* writable_data();
+
   const uint8_t* side_data() const { return side_data_.get(); }
 
   size_t side_data_size() const { return side_data_size_; }
@@ -171,8 +184,9 @@ class MediaSample {
   // is sample encrypted ?
   bool is_encrypted_ = false;
 
-  // Main buffer data.
-  std::shared_ptr<const uint8_t> data_;
+  // Main buffer data. It is not modified unless exclusively owned, see
+  // writable_data().
+  std::shared_ptr<uint8_t> data_;
   size_t data_size_ = 0;
   // Contain additional buffers to complete the main one. Needed by WebM
   // http://www.matroska.org/technical/specs/index.html BlockAdditional[A5].
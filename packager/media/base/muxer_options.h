@@ -39,6 +39,10 @@ struct MuxerOptions {
   /// Optional.
   std::string segment_template;
 
+  /// Optional UDP destination, of the form udp://ip:port[?options], to which
+  /// the stream is also sent, paced in real time. Only supported by TsMuxer.
+  std::string udp_output;
+
   /// Specify temporary directory for intermediate files.
   std::string temp_dir;
 
@@ -27,6 +27,12 @@ void OffsetByteQueue::Push(const uint8_t* buf, int size) {
   DVLOG(4) << "Buffer pushed. head=" << head() << " tail=" << tail();
 }
 
+void OffsetByteQueue::PushInPlace(const uint8_t* buf, int size) {
+  queue_.PushInPlace(buf, size);
+  Sync();
+  DVLOG(4) << "Buffer pushed in place. head=" << head() << " tail=" << tail();
+}
+
 void OffsetByteQueue::Peek(const uint8_t** buf, int* size) {
   *buf = size_ > 0 ? buf_ : NULL;
   *size = size_;
@@ -25,6 +25,7 @@ class OffsetByteQueue {
   /// @{
   void Reset();
   void Push(const uint8_t* buf, int size);
+  void PushInPlace(const uint8_t* buf, int size);
   void Peek(const uint8_t** buf, int* size);
   void Pop(int count);
   /// @}
@@ -89,5 +89,68 @@ TEST_F(OffsetByteQueueTest, Trim) {
   EXPECT_TRUE(queue_->Trim(512));
 }
 
+TEST(OffsetByteQueuePushInPlaceTest, ContiguousDataIsNotCopied) {
+  uint8_t data[256];
+  for (int i = 0; i < 256; i++)
+    data[i] = i;
+
+  OffsetByteQueue queue;
+  queue.PushInPlace(data, 100);
+  queue.PushInPlace(data + 100, 156);
+  queue.Pop(10);
+
+  const uint8_t* buf;
+  int size;
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(data + 10, buf);
+  EXPECT_EQ(246, size);
+
+  queue.PeekAt(200, &buf, &size);
+  EXPECT_EQ(data + 200, buf);
+  EXPECT_EQ(56, size);
+}
+
+TEST(OffsetByteQueuePushInPlaceTest, NonContiguousDataIsCopied) {
+  uint8_t data[256];
+  for (int i = 0; i < 256; i++)
+    data[i] = i;
+
+  OffsetByteQueue queue;
+  queue.PushInPlace(data, 128);
+  queue.Pop(64);
+  // Does not follow the bytes referenced.
+  queue.PushInPlace(data, 16);
+  // Mixing with copied data.
+  queue.Push(data + 16, 16);
+  memset(data, 0xFF, sizeof(data));
+
+  const uint8_t* buf;
+  int size;
+  queue.Peek(&buf, &size);
+  ASSERT_EQ(96, size);
+  EXPECT_NE(data + 64, buf);
+  for (int i = 0; i < 64; i++)
+    EXPECT_EQ(64 + i, buf[i]);
+  for (int i = 0; i < 32; i++)
+    EXPECT_EQ(i, buf[64 + i]);
+  EXPECT_EQ(64, queue.head());
+}
+
+TEST(OffsetByteQueuePushInPlaceTest, ReferencesAgainOnceEmpty) {
+  uint8_t data[64] = {};
+
+  OffsetByteQueue queue;
+  queue.Push(data, 32);
+  queue.Pop(32);
+  queue.PushInPlace(data + 32, 32);
+
+  const uint8_t* buf;
+  int size;
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(data + 32, buf);
+  EXPECT_EQ(32, size);
+  EXPECT_EQ(32, queue.head());
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -0,0 +1,344 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/prefetching_key_source.h"
+
+#include <openssl/sha.h>
+
+#include <algorithm>
+
+#include "packager/base/bind.h"
+#include "packager/base/logging.h"
+#include "packager/base/time/default_clock.h"
+#include "packager/file/file.h"
+#include "packager/media/base/key_cache.pb.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kDefaultMaxCachedKeys = 256;
+// The keys of a few past crypto periods are kept, as the streams sharing a
+// stream label may not change period at the same time.
+const uint32_t kNumKeptPastPeriods = 2;
+
+std::vector<uint8_t> ToVector(const std::string& str) {
+  return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+std::string ToString(const std::vector<uint8_t>& vec) {
+  return std::string(vec.begin(), vec.end());
+}
+
+std::string Sha256(const std::string& data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return std::string(digest, digest + sizeof(digest));
+}
+
+}  // namespace
+
+PrefetchingKeySource::PrefetchingKeySource(
+    std::unique_ptr<KeySource> key_source,
+    uint32_t num_prefetched_periods)
+    // The wrapped KeySource generates the protection system info.
+    : KeySource(NO_PROTECTION_SYSTEM_FLAG, FOURCC_NULL),
+      key_source_(std::move(key_source)),
+      num_prefetched_periods_(num_prefetched_periods),
+      fetch_requested_(&lock_),
+      fetch_completed_(&lock_),
+      max_cached_keys_(kDefaultMaxCachedKeys),
+      clock_(new base::DefaultClock()),
+      fetch_thread_("KeyPrefetchThread",
+                    base::Bind(&PrefetchingKeySource::FetchTask,
+                               base::Unretained(this))) {
+  DCHECK(key_source_);
+  fetch_thread_.Start();
+}
+
+PrefetchingKeySource::~PrefetchingKeySource() {
+  {
+    base::AutoLock auto_lock(lock_);
+    stopping_ = true;
+    fetch_requested_.Signal();
+  }
+  fetch_thread_.Join();
+
+  VLOG(1) << "Crypto period keys: " << stats_.hits << " hits, "
+          << stats_.late_hits << " late hits, " << stats_.misses
+          << " misses, " << stats_.fetches << " fetches ("
+          << stats_.fetch_failures << " failed), " << stats_.evictions
+          << " evictions, max fetch latency " << stats_.max_fetch_latency_us
+          << "us.";
+}
+
+Status PrefetchingKeySource::FetchKeys(EmeInitDataType init_data_type,
+                                       const std::vector<uint8_t>& init_data) {
+  base::AutoLock auto_lock(key_source_lock_);
+  return key_source_->FetchKeys(init_data_type, init_data);
+}
+
+Status PrefetchingKeySource::GetKey(const std::string& stream_label,
+                                    EncryptionKey* key) {
+  base::AutoLock auto_lock(key_source_lock_);
+  return key_source_->GetKey(stream_label, key);
+}
+
+Status PrefetchingKeySource::GetKey(const std::vector<uint8_t>& key_id,
+                                    EncryptionKey* key) {
+  base::AutoLock auto_lock(key_source_lock_);
+  return key_source_->GetKey(key_id, key);
+}
+
+Status PrefetchingKeySource::GetCryptoPeriodKey(
+    uint32_t crypto_period_index,
+    const std::string& stream_label,
+    EncryptionKey* key) {
+  DCHECK(key);
+  const PeriodKeyId id(stream_label, crypto_period_index);
+
+  base::AutoLock auto_lock(lock_);
+  // Drop the keys of the past crypto periods of this stream label.
+  const uint32_t oldest_kept_period_index =
+      crypto_period_index -
+      std::min(crypto_period_index, kNumKeptPastPeriods);
+  // The keys still being fetched are kept, as other requests may be waiting
+  // for them.
+  for (auto iter = cache_.lower_bound(PeriodKeyId(stream_label, 0));
+       iter != cache_.end() && iter->first.first == stream_label &&
+       iter->first.second < oldest_kept_period_index;) {
+    if (iter->second->fetched)
+      iter = cache_.erase(iter);
+    else
+      ++iter;
+  }
+
+  auto iter = cache_.find(id);
+  if (iter == cache_.end() ||
+      (iter->second->fetched && !IsUsable(*iter->second))) {
+    ++stats_.misses;
+  } else if (iter->second->fetched) {
+    ++stats_.hits;
+  } else {
+    ++stats_.late_hits;
+  }
+  RequestFetch(id, true);
+  std::shared_ptr<CachedKey> cached_key = cache_[id];
+  cached_key->last_use = ++num_requests_;
+
+  for (uint32_t i = 1; i <= num_prefetched_periods_; ++i)
+    RequestFetch(PeriodKeyId(stream_label, crypto_period_index + i), false);
+  EvictKeys();
+
+  while (!cached_key->fetched)
+    fetch_completed_.Wait();
+  if (!cached_key->status.ok())
+    return cached_key->status;
+  *key = cached_key->key;
+  return Status::OK;
+}
+
+void PrefetchingKeySource::set_max_cached_keys(size_t max_cached_keys) {
+  base::AutoLock auto_lock(lock_);
+  max_cached_keys_ = max_cached_keys;
+}
+
+void PrefetchingKeySource::set_key_ttl(base::TimeDelta key_ttl) {
+  base::AutoLock auto_lock(lock_);
+  key_ttl_ = key_ttl;
+}
+
+Status PrefetchingKeySource::SetCacheFile(const std::string& cache_file_name,
+                                          const std::string& config) {
+  base::AutoLock auto_lock(lock_);
+  cache_file_name_ = cache_file_name;
+  config_fingerprint_ = Sha256(config);
+
+  std::string contents;
+  if (!File::ReadFileToString(cache_file_name.c_str(), &contents)) {
+    VLOG(1) << "No key cache loaded from " << cache_file_name;
+    return Status::OK;
+  }
+  KeyCache key_cache;
+  if (!key_cache.ParseFromString(contents)) {
+    return Status(error::PARSER_FAILURE,
+                  "Failed to parse key cache file " + cache_file_name);
+  }
+  if (key_cache.config_fingerprint() != config_fingerprint_) {
+    LOG(WARNING) << "Ignoring the keys in " << cache_file_name
+                 << ", which were saved with a different configuration.";
+    return Status::OK;
+  }
+  for (const KeyCache::Key& saved_key : key_cache.keys()) {
+    std::shared_ptr<CachedKey> cached_key(new CachedKey);
+    cached_key->fetched = true;
+    cached_key->fetch_time =
+        base::Time::UnixEpoch() +
+        base::TimeDelta::FromMicroseconds(saved_key.fetch_time_us());
+    cached_key->key.key_id = ToVector(saved_key.key_id());
+    cached_key->key.key = ToVector(saved_key.key());
+    cached_key->key.iv = ToVector(saved_key.iv());
+    for (const KeyCache::ProtectionSystem& protection_system :
+         saved_key.key_system_info()) {
+      ProtectionSystemSpecificInfo info;
+      info.system_id = ToVector(protection_system.system_id());
+      info.psshs = ToVector(protection_system.psshs());
+      cached_key->key.key_system_info.push_back(info);
+    }
+    cache_[PeriodKeyId(saved_key.stream_label(),
+                       saved_key.crypto_period_index())] = cached_key;
+  }
+  VLOG(1) << "Loaded " << key_cache.keys_size() << " keys from "
+          << cache_file_name;
+  return Status::OK;
+}
+
+PrefetchingKeySource::Stats PrefetchingKeySource::GetStats() const {
+  base::AutoLock auto_lock(lock_);
+  return stats_;
+}
+
+void PrefetchingKeySource::InjectClockForTesting(
+    std::unique_ptr<base::Clock> clock) {
+  base::AutoLock auto_lock(lock_);
+  clock_ = std::move(clock);
+}
+
+void PrefetchingKeySource::FetchTask() {
+  base::AutoLock auto_lock(lock_);
+  while (true) {
+    while (!stopping_ && fetch_queue_.empty())
+      fetch_requested_.Wait();
+    if (stopping_)
+      return;
+
+    const PeriodKeyId id = fetch_queue_.front();
+    fetch_queue_.pop_front();
+    auto iter = cache_.find(id);
+    // The key may have been dropped since it was queued.
+    if (iter == cache_.end() || iter->second->fetched)
+      continue;
+    std::shared_ptr<CachedKey> cached_key = iter->second;
+
+    EncryptionKey key;
+    Status status;
+    const base::TimeTicks start_time = base::TimeTicks::Now();
+    {
+      base::AutoUnlock auto_unlock(lock_);
+      base::AutoLock key_source_auto_lock(key_source_lock_);
+      status = key_source_->GetCryptoPeriodKey(id.second, id.first, &key);
+    }
+    const int64_t latency_us =
+        (base::TimeTicks::Now() - start_time).InMicroseconds();
+
+    ++stats_.fetches;
+    stats_.total_fetch_latency_us += latency_us;
+    stats_.max_fetch_latency_us =
+        std::max(stats_.max_fetch_latency_us, latency_us);
+    if (!status.ok()) {
+      ++stats_.fetch_failures;
+      LOG(WARNING) << "Failed to fetch the key of crypto period " << id.second
+                   << " for stream label '" << id.first << "': " << status;
+    }
+
+    cached_key->status = status;
+    cached_key->key = std::move(key);
+    cached_key->fetch_time = clock_->Now();
+    cached_key->fetched = true;
+    fetch_completed_.Broadcast();
+
+    if (status.ok() && !cache_file_name_.empty())
+      SaveCache();
+  }
+}
+
+void PrefetchingKeySource::RequestFetch(const PeriodKeyId& id, bool urgent) {
+  lock_.AssertAcquired();
+  std::shared_ptr<CachedKey>& cached_key = cache_[id];
+  if (cached_key && (!cached_key->fetched || IsUsable(*cached_key))) {
+    if (urgent && !cached_key->fetched) {
+      // Move the key ahead of the prefetches if it is still queued.
+      auto iter = std::find(fetch_queue_.begin(), fetch_queue_.end(), id);
+      if (iter != fetch_queue_.end()) {
+        fetch_queue_.erase(iter);
+        fetch_queue_.push_front(id);
+      }
+    }
+    return;
+  }
+
+  // Not requested yet, or the previous fetch failed or has expired.
+  cached_key.reset(new CachedKey);
+  cached_key->last_use = num_requests_;
+  if (urgent)
+    fetch_queue_.push_front(id);
+  else
+    fetch_queue_.push_back(id);
+  fetch_requested_.Signal();
+}
+
+bool PrefetchingKeySource::IsUsable(const CachedKey& cached_key) const {
+  lock_.AssertAcquired();
+  if (!cached_key.fetched || !cached_key.status.ok())
+    return false;
+  return key_ttl_.is_zero() ||
+         clock_->Now() - cached_key.fetch_time < key_ttl_;
+}
+
+void PrefetchingKeySource::EvictKeys() {
+  lock_.AssertAcquired();
+  while (cache_.size() > max_cached_keys_) {
+    auto lru_iter = cache_.end();
+    for (auto iter = cache_.begin(); iter != cache_.end(); ++iter) {
+      if (iter->second->fetched &&
+          (lru_iter == cache_.end() ||
+           iter->second->last_use < lru_iter->second->last_use)) {
+        lru_iter = iter;
+      }
+    }
+    if (lru_iter == cache_.end())
+      return;
+    cache_.erase(lru_iter);
+    ++stats_.evictions;
+  }
+}
+
+void PrefetchingKeySource::SaveCache() {
+  lock_.AssertAcquired();
+  KeyCache key_cache;
+  key_cache.set_config_fingerprint(config_fingerprint_);
+  for (const auto& entry : cache_) {
+    const CachedKey& cached_key = *entry.second;
+    if (!IsUsable(cached_key))
+      continue;
+    KeyCache::Key* saved_key = key_cache.add_keys();
+    saved_key->set_stream_label(entry.first.first);
+    saved_key->set_crypto_period_index(entry.first.second);
+    saved_key->set_fetch_time_us(
+        (cached_key.fetch_time - base::Time::UnixEpoch()).InMicroseconds());
+    saved_key->set_key_id(ToString(cached_key.key.key_id));
+    saved_key->set_key(ToString(cached_key.key.key));
+    saved_key->set_iv(ToString(cached_key.key.iv));
+    for (const ProtectionSystemSpecificInfo& info :
+         cached_key.key.key_system_info) {
+      KeyCache::ProtectionSystem* protection_system =
+          saved_key->add_key_system_info();
+      protection_system->set_system_id(ToString(info.system_id));
+      protection_system->set_psshs(ToString(info.psshs));
+    }
+  }
+  const std::string cache_file_name = cache_file_name_;
+
+  // Only the fetch thread writes the file, so the writes stay in order.
+  base::AutoUnlock auto_unlock(lock_);
+  if (!File::WritePrivateFileAtomically(cache_file_name.c_str(),
+                                        key_cache.SerializeAsString())) {
+    LOG(WARNING) << "Failed to save the key cache to " << cache_file_name;
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
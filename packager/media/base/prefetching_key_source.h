@@ -0,0 +1,167 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_PREFETCHING_KEY_SOURCE_H_
+#define PACKAGER_MEDIA_BASE_PREFETCHING_KEY_SOURCE_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+#include "packager/base/time/clock.h"
+#include "packager/base/time/time.h"
+#include "packager/media/base/closure_thread.h"
+#include "packager/media/base/key_source.h"
+
+namespace shaka {
+namespace media {
+
+/// A KeySource which wraps another KeySource and fetches the keys of the
+/// crypto periods following the one requested in the background, so the keys
+/// are usually ready when the next crypto period starts, instead of being
+/// fetched synchronously at the segment boundary. The other calls are
+/// forwarded to the wrapped KeySource.
+///
+/// The crypto period keys are cached by stream label and crypto period index,
+/// and shared by all the streams. Concurrent requests for the same key wait
+/// for a single fetch. The cache is bounded, its keys can expire, and it can
+/// be saved to a file so a restarted job does not fetch the keys again.
+///
+/// The calls to the wrapped KeySource are serialized, so it does not need to
+/// be thread safe.
+class PrefetchingKeySource : public KeySource {
+ public:
+  /// Key fetch counters.
+  struct Stats {
+    /// Number of requests served from a key already fetched.
+    uint64_t hits = 0;
+    /// Number of requests which waited for a fetch in progress.
+    uint64_t late_hits = 0;
+    /// Number of requests for a key which was not cached or had expired.
+    uint64_t misses = 0;
+    /// Number of keys fetched from the wrapped KeySource, including the
+    /// failed fetches.
+    uint64_t fetches = 0;
+    /// Number of failed fetches.
+    uint64_t fetch_failures = 0;
+    /// Number of keys dropped to keep the cache within its size limit.
+    uint64_t evictions = 0;
+    /// Total and maximum time spent fetching keys, in microseconds.
+    int64_t total_fetch_latency_us = 0;
+    int64_t max_fetch_latency_us = 0;
+  };
+
+  /// @param key_source is the KeySource to fetch the keys from.
+  /// @param num_prefetched_periods is the number of crypto periods after the
+  ///        one requested whose keys are fetched in the background. The keys
+  ///        are only fetched on request if it is 0.
+  PrefetchingKeySource(std::unique_ptr<KeySource> key_source,
+                       uint32_t num_prefetched_periods);
+  ~PrefetchingKeySource() override;
+
+  /// @name KeySource implementation overrides.
+  /// @{
+  Status FetchKeys(EmeInitDataType init_data_type,
+                   const std::vector<uint8_t>& init_data) override;
+  Status GetKey(const std::string& stream_label, EncryptionKey* key) override;
+  Status GetKey(const std::vector<uint8_t>& key_id,
+                EncryptionKey* key) override;
+  Status GetCryptoPeriodKey(uint32_t crypto_period_index,
+                            const std::string& stream_label,
+                            EncryptionKey* key) override;
+  /// @}
+
+  /// Sets the maximum number of cached keys. The least recently used keys are
+  /// dropped first.
+  void set_max_cached_keys(size_t max_cached_keys);
+
+  /// Sets how long a fetched key is served from the cache. The keys never
+  /// expire if it is zero, which is the default.
+  void set_key_ttl(base::TimeDelta key_ttl);
+
+  /// Loads the keys saved in @a cache_file_name if it exists, and saves the
+  /// cached keys to it after every fetch from then on. Should be called before
+  /// the first key request. Note that the keys are saved in the clear, in a
+  /// file only readable by its owner.
+  /// @param config describes the configuration of the wrapped KeySource and
+  ///        the crypto period duration. The saved keys are ignored if they
+  ///        were saved with a different configuration.
+  /// @return OK on success, an error status if the file cannot be parsed.
+  Status SetCacheFile(const std::string& cache_file_name,
+                      const std::string& config);
+
+  /// @return The key fetch counters.
+  Stats GetStats() const;
+
+  /// Inject a |clock| that returns the current time. Used to expire the keys.
+  void InjectClockForTesting(std::unique_ptr<base::Clock> clock);
+
+ private:
+  // The stream label and the crypto period index of a key.
+  typedef std::pair<std::string, uint32_t> PeriodKeyId;
+
+  struct CachedKey {
+    // Set once the fetch has completed, successfully or not.
+    bool fetched = false;
+    Status status;
+    EncryptionKey key;
+    base::Time fetch_time;
+    // Sequence number of the last request of the key, for LRU eviction.
+    uint64_t last_use = 0;
+  };
+
+  // The main loop of the fetch thread.
+  void FetchTask();
+  // Queue the fetch of the key |id| unless it is cached and usable, or
+  // already being fetched. The urgent fetches are queued ahead of the
+  // prefetches. Must be called with |lock_| held.
+  void RequestFetch(const PeriodKeyId& id, bool urgent);
+  // @return true if |cached_key| was fetched successfully and has not expired.
+  //         Must be called with |lock_| held.
+  bool IsUsable(const CachedKey& cached_key) const;
+  // Drop the least recently used keys above |max_cached_keys_|. Keys being
+  // fetched are kept. Must be called with |lock_| held.
+  void EvictKeys();
+  // Save the usable keys to |cache_file_name_|. Must be called on the fetch
+  // thread with |lock_| held. The lock is released while writing the file.
+  void SaveCache();
+
+  // Serializes the calls to |key_source_|.
+  base::Lock key_source_lock_;
+  std::unique_ptr<KeySource> key_source_;
+  const uint32_t num_prefetched_periods_;
+
+  mutable base::Lock lock_;
+  // Signalled when a fetch is queued or when stopping.
+  base::ConditionVariable fetch_requested_;
+  // Signalled when a fetch completes.
+  base::ConditionVariable fetch_completed_;
+  std::map<PeriodKeyId, std::shared_ptr<CachedKey>> cache_;
+  // The keys to be fetched, in order.
+  std::deque<PeriodKeyId> fetch_queue_;
+  uint64_t num_requests_ = 0;
+  size_t max_cached_keys_;
+  base::TimeDelta key_ttl_;
+  std::string cache_file_name_;
+  // SHA-256 digest of the configuration passed to SetCacheFile.
+  std::string config_fingerprint_;
+  std::unique_ptr<base::Clock> clock_;
+  bool stopping_ = false;
+  Stats stats_;
+
+  ClosureThread fetch_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrefetchingKeySource);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_PREFETCHING_KEY_SOURCE_H_
@@ -0,0 +1,322 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/prefetching_key_source.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+#include "packager/file/file.h"
+#include "packager/status_test_util.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+const char kStreamLabel[] = "SD";
+const uint32_t kNumPrefetchedPeriods = 2;
+const uint32_t kNoFailingPeriod = 0xFFFFFFFF;
+const char kCacheFile[] = "memory://key_cache";
+const char kConfig[] = "config";
+
+// Stands in for a key server. The key id of a crypto period key is made of
+// the stream label followed by the crypto period index.
+class FakeKeySource : public KeySource {
+ public:
+  FakeKeySource()
+      : KeySource(NO_PROTECTION_SYSTEM_FLAG, FOURCC_NULL),
+        fetched_(&lock_),
+        unblocked_(&lock_) {}
+
+  Status FetchKeys(EmeInitDataType init_data_type,
+                   const std::vector<uint8_t>& init_data) override {
+    return Status::OK;
+  }
+
+  Status GetKey(const std::string& stream_label, EncryptionKey* key) override {
+    key->key_id.assign(stream_label.begin(), stream_label.end());
+    return Status::OK;
+  }
+
+  Status GetKey(const std::vector<uint8_t>& key_id,
+                EncryptionKey* key) override {
+    return Status(error::NOT_FOUND, "Key not found.");
+  }
+
+  Status GetCryptoPeriodKey(uint32_t crypto_period_index,
+                            const std::string& stream_label,
+                            EncryptionKey* key) override {
+    base::AutoLock auto_lock(lock_);
+    fetched_periods_.push_back(crypto_period_index);
+    fetched_.Broadcast();
+    while (blocked_)
+      unblocked_.Wait();
+    if (crypto_period_index == failing_period_)
+      return Status(error::SERVER_ERROR, "Key server error.");
+    *key = MakeKey(crypto_period_index, stream_label);
+    return Status::OK;
+  }
+
+  static EncryptionKey MakeKey(uint32_t crypto_period_index,
+                               const std::string& stream_label) {
+    EncryptionKey key;
+    key.key_id.assign(stream_label.begin(), stream_label.end());
+    key.key_id.push_back(static_cast<uint8_t>(crypto_period_index));
+    return key;
+  }
+
+  // Waits until |num_fetches| crypto period keys have been requested.
+  std::vector<uint32_t> WaitForFetches(size_t num_fetches) {
+    base::AutoLock auto_lock(lock_);
+    while (fetched_periods_.size() < num_fetches)
+      fetched_.Wait();
+    return fetched_periods_;
+  }
+
+  void set_failing_period(uint32_t failing_period) {
+    base::AutoLock auto_lock(lock_);
+    failing_period_ = failing_period;
+  }
+
+  // The fetches do not complete while blocked.
+  void set_blocked(bool blocked) {
+    base::AutoLock auto_lock(lock_);
+    blocked_ = blocked;
+    unblocked_.Broadcast();
+  }
+
+ private:
+  base::Lock lock_;
+  base::ConditionVariable fetched_;
+  base::ConditionVariable unblocked_;
+  std::vector<uint32_t> fetched_periods_;
+  uint32_t failing_period_ = kNoFailingPeriod;
+  bool blocked_ = false;
+};
+
+class TestClock : public base::Clock {
+ public:
+  explicit TestClock(const base::Time& t) : time_(t) {}
+  ~TestClock() override {}
+  base::Time Now() override { return time_; }
+
+  void Advance(base::TimeDelta delta) { time_ += delta; }
+
+ private:
+  base::Time time_;
+};
+
+}  // namespace
+
+class PrefetchingKeySourceTest : public testing::Test {
+ public:
+  void SetUp() override { CreateKeySource(kNumPrefetchedPeriods); }
+
+  void CreateKeySource(uint32_t num_prefetched_periods) {
+    key_source_.reset();
+    std::unique_ptr<FakeKeySource> fake_key_source(new FakeKeySource);
+    fake_key_source_ = fake_key_source.get();
+    key_source_.reset(new PrefetchingKeySource(std::move(fake_key_source),
+                                               num_prefetched_periods));
+  }
+
+  // Waits until |num_misses| requests have missed the cache.
+  void WaitForMisses(uint64_t num_misses) {
+    while (key_source_->GetStats().misses < num_misses)
+      std::this_thread::yield();
+  }
+
+ protected:
+  FakeKeySource* fake_key_source_ = nullptr;
+  std::unique_ptr<PrefetchingKeySource> key_source_;
+};
+
+TEST_F(PrefetchingKeySourceTest, PrefetchesFollowingPeriods) {
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  EXPECT_EQ(FakeKeySource::MakeKey(0, kStreamLabel).key_id, key.key_id);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2}),
+            fake_key_source_->WaitForFetches(3));
+
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(1, kStreamLabel, &key));
+  EXPECT_EQ(FakeKeySource::MakeKey(1, kStreamLabel).key_id, key.key_id);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 3}),
+            fake_key_source_->WaitForFetches(4));
+
+  // The keys are cached per stream label.
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(1, "HD", &key));
+  EXPECT_EQ(FakeKeySource::MakeKey(1, "HD").key_id, key.key_id);
+
+  const PrefetchingKeySource::Stats stats = key_source_->GetStats();
+  EXPECT_EQ(2u, stats.misses);
+  // The prefetch may still be completing when the key is requested.
+  EXPECT_EQ(1u, stats.hits + stats.late_hits);
+  EXPECT_GE(stats.fetches, 4u);
+  EXPECT_EQ(0u, stats.fetch_failures);
+}
+
+TEST_F(PrefetchingKeySourceTest, FailedFetchIsRetried) {
+  fake_key_source_->set_failing_period(1);
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  fake_key_source_->WaitForFetches(3);
+  EXPECT_EQ(error::SERVER_ERROR,
+            key_source_->GetCryptoPeriodKey(1, kStreamLabel, &key)
+                .error_code());
+
+  fake_key_source_->set_failing_period(kNoFailingPeriod);
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(1, kStreamLabel, &key));
+  EXPECT_EQ(FakeKeySource::MakeKey(1, kStreamLabel).key_id, key.key_id);
+  EXPECT_GE(key_source_->GetStats().fetch_failures, 1u);
+}
+
+TEST_F(PrefetchingKeySourceTest, ForwardsOtherCalls) {
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetKey(kStreamLabel, &key));
+  EXPECT_EQ(std::vector<uint8_t>({'S', 'D'}), key.key_id);
+  EXPECT_EQ(error::NOT_FOUND,
+            key_source_->GetKey(std::vector<uint8_t>(16, 0), &key)
+                .error_code());
+  EXPECT_OK(key_source_->FetchKeys(EmeInitDataType::CENC,
+                                   std::vector<uint8_t>()));
+}
+
+TEST_F(PrefetchingKeySourceTest, ConcurrentRequestsShareOneFetch) {
+  CreateKeySource(0);
+  fake_key_source_->set_blocked(true);
+
+  const size_t kNumStreams = 4;
+  std::vector<std::thread> streams;
+  for (size_t i = 0; i < kNumStreams; ++i) {
+    streams.emplace_back([this]() {
+      EncryptionKey key;
+      ASSERT_OK(key_source_->GetCryptoPeriodKey(5, kStreamLabel, &key));
+      EXPECT_EQ(FakeKeySource::MakeKey(5, kStreamLabel).key_id, key.key_id);
+    });
+  }
+  fake_key_source_->WaitForFetches(1);
+  fake_key_source_->set_blocked(false);
+  for (std::thread& stream : streams)
+    stream.join();
+
+  EXPECT_EQ(std::vector<uint32_t>({5}), fake_key_source_->WaitForFetches(1));
+  const PrefetchingKeySource::Stats stats = key_source_->GetStats();
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(kNumStreams - 1, stats.hits + stats.late_hits);
+  EXPECT_EQ(1u, stats.fetches);
+}
+
+TEST_F(PrefetchingKeySourceTest, PendingPastPeriodIsNotDropped) {
+  CreateKeySource(0);
+  fake_key_source_->set_blocked(true);
+
+  // Streams sharing a stream label request crypto periods far apart. The
+  // request of period 10 must not drop period 0, which is still queued.
+  std::vector<std::thread> streams;
+  const uint32_t kPeriods[] = {5, 0, 10};
+  for (size_t i = 0; i < arraysize(kPeriods); ++i) {
+    const uint32_t period = kPeriods[i];
+    streams.emplace_back([this, period]() {
+      EncryptionKey key;
+      ASSERT_OK(key_source_->GetCryptoPeriodKey(period, kStreamLabel, &key));
+      EXPECT_EQ(FakeKeySource::MakeKey(period, kStreamLabel).key_id,
+                key.key_id);
+    });
+    WaitForMisses(i + 1);
+  }
+  fake_key_source_->set_blocked(false);
+  for (std::thread& stream : streams)
+    stream.join();
+
+  EXPECT_EQ(std::vector<uint32_t>({5, 10, 0}),
+            fake_key_source_->WaitForFetches(3));
+}
+
+TEST_F(PrefetchingKeySourceTest, ExpiredKeyIsFetchedAgain) {
+  CreateKeySource(0);
+  TestClock* clock = new TestClock(base::Time::Now());
+  key_source_->InjectClockForTesting(std::unique_ptr<base::Clock>(clock));
+  key_source_->set_key_ttl(base::TimeDelta::FromSeconds(10));
+
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  clock->Advance(base::TimeDelta::FromSeconds(9));
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  EXPECT_EQ(1u, key_source_->GetStats().fetches);
+
+  clock->Advance(base::TimeDelta::FromSeconds(2));
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  EXPECT_EQ(std::vector<uint32_t>({0, 0}),
+            fake_key_source_->WaitForFetches(2));
+  EXPECT_EQ(2u, key_source_->GetStats().misses);
+}
+
+TEST_F(PrefetchingKeySourceTest, EvictsLeastRecentlyUsedKeys) {
+  CreateKeySource(0);
+  key_source_->set_max_cached_keys(2);
+
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, "A", &key));
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, "B", &key));
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, "A", &key));
+  // Drops the key of "B".
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, "C", &key));
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, "A", &key));
+
+  PrefetchingKeySource::Stats stats = key_source_->GetStats();
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ(1u, stats.evictions);
+
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, "B", &key));
+  EXPECT_EQ(4u, key_source_->GetStats().misses);
+}
+
+TEST_F(PrefetchingKeySourceTest, KeysSurviveRestart) {
+  CreateKeySource(kNumPrefetchedPeriods);
+  ASSERT_OK(key_source_->SetCacheFile(kCacheFile, kConfig));
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  fake_key_source_->WaitForFetches(1 + kNumPrefetchedPeriods);
+
+  // The new instance is served from the cache file.
+  CreateKeySource(kNumPrefetchedPeriods);
+  ASSERT_OK(key_source_->SetCacheFile(kCacheFile, kConfig));
+  for (uint32_t i = 0; i <= kNumPrefetchedPeriods; ++i) {
+    ASSERT_OK(key_source_->GetCryptoPeriodKey(i, kStreamLabel, &key));
+    EXPECT_EQ(FakeKeySource::MakeKey(i, kStreamLabel).key_id, key.key_id);
+  }
+  EXPECT_EQ(kNumPrefetchedPeriods + 1, key_source_->GetStats().hits);
+  EXPECT_EQ(0u, key_source_->GetStats().misses);
+  File::Delete(kCacheFile);
+}
+
+TEST_F(PrefetchingKeySourceTest, CacheOfOtherConfigIsIgnored) {
+  ASSERT_OK(key_source_->SetCacheFile(kCacheFile, kConfig));
+  EncryptionKey key;
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  fake_key_source_->WaitForFetches(1 + kNumPrefetchedPeriods);
+
+  CreateKeySource(kNumPrefetchedPeriods);
+  ASSERT_OK(key_source_->SetCacheFile(kCacheFile, "other config"));
+  ASSERT_OK(key_source_->GetCryptoPeriodKey(0, kStreamLabel, &key));
+  EXPECT_EQ(1u, key_source_->GetStats().misses);
+  File::Delete(kCacheFile);
+}
+
+TEST_F(PrefetchingKeySourceTest, CorruptCacheFile) {
+  ASSERT_TRUE(File::WriteStringToFile(kCacheFile, "not a key cache"));
+  EXPECT_EQ(error::PARSER_FAILURE,
+            key_source_->SetCacheFile(kCacheFile, kConfig).error_code());
+  File::Delete(kCacheFile);
+}
+
+}  // namespace media
+}  // namespace shaka
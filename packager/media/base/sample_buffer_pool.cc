@@ -0,0 +1,230 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/sample_buffer_pool.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+#include "packager/base/logging.h"
+
+DEFINE_bool(use_sample_buffer_pool,
+            true,
+            "Recycle media sample buffers through a pool of size-classed "
+            "buffers. Disable it to allocate every sample buffer from the "
+            "heap, e.g. when debugging memory errors.");
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Buffers up to 32 MB are pooled. The size classes are powers of two from 256
+// bytes to 1 MB. Above that, every doubling is split into four size classes,
+// so a large frame wastes at most a fifth of its buffer. Larger buffers are
+// allocated from the heap directly.
+const size_t kMinSizeClassShift = 8;
+const size_t kFineSizeClassShift = 20;
+const size_t kMaxSizeClassShift = 25;
+const size_t kNumSizeClassesPerDoubling = 4;
+const size_t kNumCoarseSizeClasses =
+    kFineSizeClassShift - kMinSizeClassShift + 1;
+const size_t kNumSizeClasses =
+    kNumCoarseSizeClasses +
+    (kMaxSizeClassShift - kFineSizeClassShift) * kNumSizeClassesPerDoubling;
+// Number of shards per size class. Threads are assigned to the shards in a
+// round robin fashion.
+const size_t kNumShards = 8;
+// Limits on what is cached per shard and size class. Small buffers are capped
+// by count and large buffers by bytes.
+const size_t kMaxCachedBuffersPerShard = 32;
+const size_t kMaxCachedBytesPerShard = 64 << 20;
+// Limit on what is cached overall, as the limits above add up to gigabytes.
+const size_t kMaxCachedBytes = 256 << 20;
+
+}  // namespace
+
+class SampleBufferPool::BufferReleaser {
+ public:
+  BufferReleaser(SampleBufferPool* pool,
+                 size_t buffer_size,
+                 int size_class_index,
+                 size_t shard_index)
+      : pool_(pool),
+        buffer_size_(buffer_size),
+        size_class_index_(size_class_index),
+        shard_index_(shard_index) {}
+
+  void operator()(uint8_t* buffer) const {
+    pool_->Release(buffer, buffer_size_, size_class_index_, shard_index_);
+  }
+
+ private:
+  SampleBufferPool* pool_;
+  size_t buffer_size_;
+  int size_class_index_;
+  // The shard the buffer was allocated from, which is where the allocating
+  // thread looks for it again.
+  size_t shard_index_;
+};
+
+// static
+SampleBufferPool* SampleBufferPool::GetInstance() {
+  // Intentionally leaked, as buffers may be released during process shutdown.
+  static SampleBufferPool* pool = new SampleBufferPool;
+  return pool;
+}
+
+SampleBufferPool::SampleBufferPool()
+    : size_classes_(kNumSizeClasses),
+      max_cached_bytes_(kMaxCachedBytes),
+      hits_(0),
+      misses_(0),
+      bytes_outstanding_(0),
+      bytes_cached_(0) {
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    SizeClass& size_class = size_classes_[i];
+    size_class.buffer_size = GetSizeClassBufferSize(i);
+    size_class.max_cached_buffers_per_shard =
+        std::max<size_t>(1, std::min(kMaxCachedBuffersPerShard,
+                                     kMaxCachedBytesPerShard /
+                                         size_class.buffer_size));
+    for (size_t j = 0; j < kNumShards; ++j)
+      size_class.shards.emplace_back(new Shard);
+  }
+}
+
+SampleBufferPool::~SampleBufferPool() {
+  Purge();
+}
+
+std::shared_ptr<uint8_t> SampleBufferPool::Allocate(size_t size) {
+  const int size_class_index =
+      FLAGS_use_sample_buffer_pool ? GetSizeClassIndex(size) : -1;
+  if (size_class_index < 0) {
+    misses_ += 1;
+    bytes_outstanding_ += size;
+    return std::shared_ptr<uint8_t>(new uint8_t[size],
+                                    BufferReleaser(this, size, -1, 0));
+  }
+
+  SizeClass& size_class = size_classes_[size_class_index];
+  const size_t buffer_size = size_class.buffer_size;
+  const size_t shard_index = GetShardIndex();
+  Shard& shard = *size_class.shards[shard_index];
+  uint8_t* buffer = nullptr;
+  {
+    base::AutoLock auto_lock(shard.lock);
+    if (!shard.free_buffers.empty()) {
+      buffer = shard.free_buffers.back();
+      shard.free_buffers.pop_back();
+      bytes_cached_ -= buffer_size;
+    }
+  }
+  if (buffer) {
+    hits_ += 1;
+  } else {
+    misses_ += 1;
+    buffer = new uint8_t[buffer_size];
+  }
+  bytes_outstanding_ += buffer_size;
+  return std::shared_ptr<uint8_t>(
+      buffer,
+      BufferReleaser(this, buffer_size, size_class_index, shard_index));
+}
+
+SampleBufferPool::Stats SampleBufferPool::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.bytes_outstanding = bytes_outstanding_;
+  stats.bytes_cached = bytes_cached_;
+  return stats;
+}
+
+void SampleBufferPool::Purge() {
+  for (SizeClass& size_class : size_classes_) {
+    for (std::unique_ptr<Shard>& shard : size_class.shards) {
+      std::vector<uint8_t*> free_buffers;
+      {
+        base::AutoLock auto_lock(shard->lock);
+        free_buffers.swap(shard->free_buffers);
+        bytes_cached_ -= free_buffers.size() * size_class.buffer_size;
+      }
+      for (uint8_t* buffer : free_buffers)
+        delete[] buffer;
+    }
+  }
+}
+
+// static
+int SampleBufferPool::GetSizeClassIndex(size_t size) {
+  if (size > (static_cast<size_t>(1) << kMaxSizeClassShift))
+    return -1;
+  size_t shift = kMinSizeClassShift;
+  while ((static_cast<size_t>(1) << shift) < size)
+    ++shift;
+  if (shift <= kFineSizeClassShift)
+    return static_cast<int>(shift - kMinSizeClassShift);
+
+  // |size| is in (2^(shift - 1), 2^shift], which is split into steps.
+  const size_t doubling_start = static_cast<size_t>(1) << (shift - 1);
+  const size_t step_size = doubling_start / kNumSizeClassesPerDoubling;
+  const size_t step = (size - doubling_start + step_size - 1) / step_size;
+  return static_cast<int>(
+      kNumCoarseSizeClasses +
+      (shift - 1 - kFineSizeClassShift) * kNumSizeClassesPerDoubling + step -
+      1);
+}
+
+// static
+size_t SampleBufferPool::GetSizeClassBufferSize(size_t size_class_index) {
+  if (size_class_index < kNumCoarseSizeClasses)
+    return static_cast<size_t>(1) << (kMinSizeClassShift + size_class_index);
+  const size_t fine_index = size_class_index - kNumCoarseSizeClasses;
+  const size_t doubling_start =
+      static_cast<size_t>(1)
+      << (kFineSizeClassShift + fine_index / kNumSizeClassesPerDoubling);
+  const size_t step = fine_index % kNumSizeClassesPerDoubling + 1;
+  return doubling_start + doubling_start / kNumSizeClassesPerDoubling * step;
+}
+
+// static
+size_t SampleBufferPool::GetShardIndex() {
+  static std::atomic<size_t> next_shard_index(0);
+  static thread_local size_t shard_index = next_shard_index++ % kNumShards;
+  return shard_index;
+}
+
+void SampleBufferPool::Release(uint8_t* buffer,
+                               size_t buffer_size,
+                               int size_class_index,
+                               size_t shard_index) {
+  DCHECK(buffer);
+  bytes_outstanding_ -= buffer_size;
+  if (size_class_index < 0) {
+    delete[] buffer;
+    return;
+  }
+
+  SizeClass& size_class = size_classes_[size_class_index];
+  DCHECK_EQ(buffer_size, size_class.buffer_size);
+  // Reserve the bytes first, so that concurrent releases cannot exceed the
+  // limit together.
+  if (bytes_cached_.fetch_add(buffer_size) + buffer_size <= max_cached_bytes_) {
+    Shard& shard = *size_class.shards[shard_index];
+    base::AutoLock auto_lock(shard.lock);
+    if (shard.free_buffers.size() < size_class.max_cached_buffers_per_shard) {
+      shard.free_buffers.push_back(buffer);
+      return;
+    }
+  }
+  bytes_cached_ -= buffer_size;
+  delete[] buffer;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,106 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_SAMPLE_BUFFER_POOL_H_
+#define PACKAGER_MEDIA_BASE_SAMPLE_BUFFER_POOL_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "packager/base/synchronization/lock.h"
+
+namespace shaka {
+namespace media {
+
+/// A pool of buffers for MediaSample payloads. Buffers are organized in size
+/// classes, which are powers of two up to 1 MB and finer above, so that large
+/// frames do not waste up to half of their buffer. Buffers are returned to the
+/// pool by the deleter of the shared_ptr handed out, i.e. when the last
+/// MediaSample referencing the buffer goes away. Every size class is split into
+/// shards selected by the calling thread, so concurrent jobs rarely contend on
+/// the same lock. A buffer goes back to the shard it was allocated from,
+/// whichever thread releases it. The bytes cached are capped globally.
+///
+/// The pool can be disabled with --use_sample_buffer_pool=false, in which case
+/// every buffer is allocated from and released to the heap directly, which is
+/// useful for debugging memory errors.
+///
+/// Thread Safety: All member functions are thread safe.
+class SampleBufferPool {
+ public:
+  /// Pool usage counters.
+  struct Stats {
+    /// Number of allocations served from the pool.
+    uint64_t hits = 0;
+    /// Number of allocations served from the heap.
+    uint64_t misses = 0;
+    /// Number of bytes handed out and not released yet.
+    uint64_t bytes_outstanding = 0;
+    /// Number of bytes cached in the pool for reuse.
+    uint64_t bytes_cached = 0;
+  };
+
+  /// @return The process wide pool instance.
+  static SampleBufferPool* GetInstance();
+
+  /// Allocate a buffer.
+  /// @param size is the minimum size of the buffer in bytes.
+  /// @return a buffer of at least @a size bytes, which is returned to the pool
+  ///         when the last reference to it is released.
+  std::shared_ptr<uint8_t> Allocate(size_t size);
+
+  /// @return The current pool usage counters.
+  Stats GetStats() const;
+
+  /// Release all the cached buffers back to the heap.
+  void Purge();
+
+ private:
+  friend class SampleBufferPoolTest;
+
+  struct Shard {
+    base::Lock lock;
+    std::vector<uint8_t*> free_buffers;
+  };
+  struct SizeClass {
+    size_t buffer_size = 0;
+    size_t max_cached_buffers_per_shard = 0;
+    std::vector<std::unique_ptr<Shard>> shards;
+  };
+  class BufferReleaser;
+
+  SampleBufferPool();
+  ~SampleBufferPool();
+
+  SampleBufferPool(const SampleBufferPool&) = delete;
+  SampleBufferPool& operator=(const SampleBufferPool&) = delete;
+
+  // Return the size class index for |size| or -1 if |size| is not pooled.
+  static int GetSizeClassIndex(size_t size);
+  // Return the buffer size of the size class |size_class_index|.
+  static size_t GetSizeClassBufferSize(size_t size_class_index);
+  // Return the shard of the calling thread.
+  static size_t GetShardIndex();
+
+  void Release(uint8_t* buffer,
+               size_t buffer_size,
+               int size_class_index,
+               size_t shard_index);
+
+  std::vector<SizeClass> size_classes_;
+  size_t max_cached_bytes_;
+
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+  std::atomic<uint64_t> bytes_outstanding_;
+  std::atomic<uint64_t> bytes_cached_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_SAMPLE_BUFFER_POOL_H_
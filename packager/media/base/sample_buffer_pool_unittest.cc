@@ -0,0 +1,135 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/sample_buffer_pool.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+DECLARE_bool(use_sample_buffer_pool);
+
+namespace shaka {
+namespace media {
+
+class SampleBufferPoolTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    FLAGS_use_sample_buffer_pool = true;
+    pool_ = new SampleBufferPool;
+  }
+
+  void TearDown() override {
+    delete pool_;
+    FLAGS_use_sample_buffer_pool = true;
+  }
+
+ protected:
+  void set_max_cached_bytes(size_t max_cached_bytes) {
+    pool_->max_cached_bytes_ = max_cached_bytes;
+  }
+
+  SampleBufferPool* pool_ = nullptr;
+};
+
+TEST_F(SampleBufferPoolTest, ReuseReleasedBuffer) {
+  const uint8_t* first_buffer = nullptr;
+  {
+    std::shared_ptr<uint8_t> buffer = pool_->Allocate(1000);
+    first_buffer = buffer.get();
+    EXPECT_EQ(1u, pool_->GetStats().misses);
+    EXPECT_EQ(1024u, pool_->GetStats().bytes_outstanding);
+  }
+  EXPECT_EQ(0u, pool_->GetStats().bytes_outstanding);
+  EXPECT_EQ(1024u, pool_->GetStats().bytes_cached);
+
+  // Any size in the same size class reuses the buffer.
+  std::shared_ptr<uint8_t> buffer = pool_->Allocate(600);
+  EXPECT_EQ(first_buffer, buffer.get());
+  EXPECT_EQ(1u, pool_->GetStats().hits);
+  EXPECT_EQ(1u, pool_->GetStats().misses);
+  EXPECT_EQ(0u, pool_->GetStats().bytes_cached);
+}
+
+TEST_F(SampleBufferPoolTest, DifferentSizeClass) {
+  pool_->Allocate(1000);
+  std::shared_ptr<uint8_t> buffer = pool_->Allocate(2000);
+  EXPECT_EQ(0u, pool_->GetStats().hits);
+  EXPECT_EQ(2u, pool_->GetStats().misses);
+  EXPECT_EQ(2048u, pool_->GetStats().bytes_outstanding);
+  EXPECT_EQ(1024u, pool_->GetStats().bytes_cached);
+}
+
+TEST_F(SampleBufferPoolTest, FineSizeClassesForLargeBuffers) {
+  // 17 MB takes a 20 MB buffer rather than a 32 MB one.
+  const size_t kSize = 17 << 20;
+  {
+    std::shared_ptr<uint8_t> buffer = pool_->Allocate(kSize);
+    EXPECT_EQ(20u << 20, pool_->GetStats().bytes_outstanding);
+  }
+  // Any size in the same size class reuses the buffer.
+  std::shared_ptr<uint8_t> buffer = pool_->Allocate(20 << 20);
+  EXPECT_EQ(1u, pool_->GetStats().hits);
+  buffer = pool_->Allocate((20 << 20) + 1);
+  EXPECT_EQ(1u, pool_->GetStats().hits);
+  EXPECT_EQ(24u << 20, pool_->GetStats().bytes_outstanding);
+}
+
+TEST_F(SampleBufferPoolTest, LargeBufferNotPooled) {
+  const size_t kLargeSize = 64 << 20;
+  pool_->Allocate(kLargeSize);
+  pool_->Allocate(kLargeSize);
+  EXPECT_EQ(0u, pool_->GetStats().hits);
+  EXPECT_EQ(2u, pool_->GetStats().misses);
+  EXPECT_EQ(0u, pool_->GetStats().bytes_cached);
+}
+
+TEST_F(SampleBufferPoolTest, Disabled) {
+  FLAGS_use_sample_buffer_pool = false;
+  {
+    std::shared_ptr<uint8_t> buffer = pool_->Allocate(1000);
+    EXPECT_EQ(1000u, pool_->GetStats().bytes_outstanding);
+  }
+  pool_->Allocate(1000);
+  EXPECT_EQ(0u, pool_->GetStats().hits);
+  EXPECT_EQ(2u, pool_->GetStats().misses);
+  EXPECT_EQ(0u, pool_->GetStats().bytes_outstanding);
+  EXPECT_EQ(0u, pool_->GetStats().bytes_cached);
+}
+
+TEST_F(SampleBufferPoolTest, ReuseBufferReleasedOnAnotherThread) {
+  std::shared_ptr<uint8_t> buffer = pool_->Allocate(1000);
+  const uint8_t* first_buffer = buffer.get();
+  std::thread([&buffer]() { buffer.reset(); }).join();
+  EXPECT_EQ(1024u, pool_->GetStats().bytes_cached);
+
+  // The buffer went back to the shard of this thread.
+  buffer = pool_->Allocate(1000);
+  EXPECT_EQ(first_buffer, buffer.get());
+  EXPECT_EQ(1u, pool_->GetStats().hits);
+}
+
+TEST_F(SampleBufferPoolTest, CachedBytesLimit) {
+  set_max_cached_bytes(4096);
+  std::vector<std::shared_ptr<uint8_t>> buffers;
+  for (int i = 0; i < 3; ++i)
+    buffers.push_back(pool_->Allocate(2000));
+  buffers.clear();
+  EXPECT_EQ(4096u, pool_->GetStats().bytes_cached);
+  EXPECT_EQ(0u, pool_->GetStats().bytes_outstanding);
+}
+
+TEST_F(SampleBufferPoolTest, Purge) {
+  pool_->Allocate(1000);
+  pool_->Allocate(100000);
+  EXPECT_EQ(1024u + 131072u, pool_->GetStats().bytes_cached);
+  pool_->Purge();
+  EXPECT_EQ(0u, pool_->GetStats().bytes_cached);
+}
+
+}  // namespace media
+}  // namespace shaka
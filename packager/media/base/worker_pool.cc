@@ -0,0 +1,116 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/worker_pool.h"
+
+#include "packager/base/logging.h"
+#include "packager/base/strings/stringprintf.h"
+#include "packager/base/threading/simple_thread.h"
+
+namespace shaka {
+namespace media {
+
+class WorkerPool::Worker : public base::SimpleThread {
+ public:
+  Worker(WorkerPool* pool, size_t worker_index)
+      : SimpleThread(base::StringPrintf("PoolWorker %zu", worker_index)),
+        pool_(pool) {}
+
+ private:
+  Worker(const Worker&) = delete;
+  Worker& operator=(const Worker&) = delete;
+
+  void Run() override { pool_->RunWorker(); }
+
+  WorkerPool* pool_;
+};
+
+struct WorkerPool::Job {
+  Job(size_t num_parts, const PartTask* task, base::Lock* lock)
+      : num_parts(num_parts), task(task), parts_done(lock) {}
+
+  const size_t num_parts;
+  // Owned by the caller of RunParts, which waits for all the parts.
+  const PartTask* task;
+  // The members below are protected by the pool lock.
+  size_t next_part = 0;
+  size_t num_parts_done = 0;
+  // Signalled when the last part completes.
+  base::ConditionVariable parts_done;
+};
+
+// static
+WorkerPool* WorkerPool::GetInstance() {
+  // Intentionally leaked, as the workers are never stopped.
+  static WorkerPool* pool = new WorkerPool;
+  return pool;
+}
+
+void WorkerPool::RunParts(size_t num_parts,
+                          size_t num_workers,
+                          const PartTask& task) {
+  if (num_parts == 0)
+    return;
+  std::shared_ptr<Job> job(new Job(num_parts, &task, &lock_));
+
+  base::AutoLock auto_lock(lock_);
+  while (workers_.size() < num_workers) {
+    workers_.emplace_back(new Worker(this, workers_.size()));
+    workers_.back()->Start();
+  }
+  if (num_parts > 1) {
+    jobs_.push_back(job);
+    job_available_.Broadcast();
+  }
+  while (job->next_part < num_parts)
+    RunNextPart(job);
+  while (job->num_parts_done < num_parts)
+    job->parts_done.Wait();
+}
+
+size_t WorkerPool::num_workers() const {
+  base::AutoLock auto_lock(lock_);
+  return workers_.size();
+}
+
+WorkerPool::WorkerPool() : job_available_(&lock_) {}
+
+WorkerPool::~WorkerPool() {}
+
+void WorkerPool::RunWorker() {
+  base::AutoLock auto_lock(lock_);
+  while (true) {
+    while (jobs_.empty())
+      job_available_.Wait();
+    // Hold a reference, as the job is dropped from |jobs_| once its last part
+    // is taken.
+    std::shared_ptr<Job> job = jobs_.front();
+    RunNextPart(job);
+  }
+}
+
+void WorkerPool::RunNextPart(const std::shared_ptr<Job>& job) {
+  lock_.AssertAcquired();
+  DCHECK_LT(job->next_part, job->num_parts);
+  const size_t part_index = job->next_part++;
+  if (job->next_part == job->num_parts) {
+    for (auto iter = jobs_.begin(); iter != jobs_.end(); ++iter) {
+      if (*iter == job) {
+        jobs_.erase(iter);
+        break;
+      }
+    }
+  }
+  {
+    base::AutoUnlock auto_unlock(lock_);
+    (*job->task)(part_index);
+  }
+  if (++job->num_parts_done == job->num_parts)
+    job->parts_done.Signal();
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,71 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_WORKER_POOL_H_
+#define PACKAGER_MEDIA_BASE_WORKER_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+
+namespace shaka {
+namespace media {
+
+/// A process wide pool of worker threads, shared by all the jobs, to split
+/// CPU heavy work on a single item, e.g. a large sample, across cores. The
+/// workers are started on demand and are never stopped.
+///
+/// Thread Safety: All member functions are thread safe.
+class WorkerPool {
+ public:
+  typedef std::function<void(size_t part_index)> PartTask;
+
+  /// @return The process wide pool instance.
+  static WorkerPool* GetInstance();
+
+  /// Run @a task for every part index in [0, @a num_parts) and wait for all
+  /// the parts to complete. The parts are run in no particular order, by the
+  /// workers and by the calling thread, which takes parts too, so the call
+  /// makes progress even if all the workers are busy with other calls.
+  /// @param num_workers is the number of workers the pool is grown to if it
+  ///        has fewer.
+  void RunParts(size_t num_parts, size_t num_workers, const PartTask& task);
+
+  /// @return The number of workers started.
+  size_t num_workers() const;
+
+ private:
+  class Worker;
+  struct Job;
+
+  WorkerPool();
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // The main loop of the workers.
+  void RunWorker();
+  // Take the next part of |job| and run it. Must be called with |lock_| held,
+  // which is released while the part runs.
+  void RunNextPart(const std::shared_ptr<Job>& job);
+
+  mutable base::Lock lock_;
+  // Signalled when a job is added to |jobs_|.
+  base::ConditionVariable job_available_;
+  // The jobs with parts left to be taken, oldest first.
+  std::deque<std::shared_ptr<Job>> jobs_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_WORKER_POOL_H_
@@ -0,0 +1,60 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/worker_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace shaka {
+namespace media {
+
+TEST(WorkerPoolTest, RunParts) {
+  const size_t kNumParts = 100;
+  std::vector<std::atomic<int>> run_counts(kNumParts);
+  for (auto& run_count : run_counts)
+    run_count = 0;
+  WorkerPool::GetInstance()->RunParts(
+      kNumParts, 3, [&run_counts](size_t part_index) {
+        ASSERT_LT(part_index, run_counts.size());
+        ++run_counts[part_index];
+      });
+  for (size_t i = 0; i < kNumParts; ++i)
+    EXPECT_EQ(1, run_counts[i]) << "part " << i;
+  EXPECT_GE(WorkerPool::GetInstance()->num_workers(), 3u);
+}
+
+TEST(WorkerPoolTest, NoParts) {
+  bool run = false;
+  WorkerPool::GetInstance()->RunParts(0, 1, [&run](size_t) { run = true; });
+  EXPECT_FALSE(run);
+}
+
+// The pool is shared, so several threads can run parts at the same time.
+TEST(WorkerPoolTest, ConcurrentCallers) {
+  const size_t kNumCallers = 4;
+  const size_t kNumParts = 50;
+  std::vector<std::atomic<size_t>> sums(kNumCallers);
+  std::vector<std::thread> callers;
+  for (size_t i = 0; i < kNumCallers; ++i) {
+    sums[i] = 0;
+    callers.emplace_back([i, &sums]() {
+      WorkerPool::GetInstance()->RunParts(
+          kNumParts, 2,
+          [i, &sums](size_t part_index) { sums[i] += part_index + 1; });
+    });
+  }
+  for (std::thread& caller : callers)
+    caller.join();
+  for (size_t i = 0; i < kNumCallers; ++i)
+    EXPECT_EQ(kNumParts * (kNumParts + 1) / 2, sums[i]);
+}
+
+}  // namespace media
+}  // namespace shaka
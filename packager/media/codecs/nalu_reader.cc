@@ -8,6 +8,13 @@
 
 #include <iostream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "packager/base/logging.h"
 #include "packager/media/base/buffer_reader.h"
 #include "packager/media/codecs/h264_parser.h"
@@ -20,6 +27,70 @@ inline bool IsStartCode(const uint8_t* data) {
   return data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x01;
 }
 
+// Returns the position of the first three-byte start code in [data, end), or
+// nullptr if there is none. A start code begins at |data + i| if
+// |data[i]| and |data[i + 1]| are 0 and |data[i + 2]| is 1, which is checked
+// for 32 or 16 positions at a time when SIMD is available.
+const uint8_t* FindThreeByteStartCode(const uint8_t* data,
+                                      const uint8_t* end) {
+#if defined(__AVX2__)
+  const __m256i kZero256 = _mm256_setzero_si256();
+  const __m256i kOne256 = _mm256_set1_epi8(1);
+  while (end - data >= 32 + 2) {
+    const __m256i first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const __m256i second =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 1));
+    const __m256i third =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 2));
+    const __m256i matches = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, kZero256),
+                         _mm256_cmpeq_epi8(second, kZero256)),
+        _mm256_cmpeq_epi8(third, kOne256));
+    const uint32_t mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    if (mask != 0)
+      return data + __builtin_ctz(mask);
+    data += 32;
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i kZero128 = _mm_setzero_si128();
+  const __m128i kOne128 = _mm_set1_epi8(1);
+  while (end - data >= 16 + 2) {
+    const __m128i first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i second =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 1));
+    const __m128i third =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2));
+    const __m128i matches =
+        _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(first, kZero128),
+                                    _mm_cmpeq_epi8(second, kZero128)),
+                      _mm_cmpeq_epi8(third, kOne128));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    if (mask != 0)
+      return data + __builtin_ctz(mask);
+    data += 16;
+  }
+#endif
+  // Portable scan of the remaining bytes. If |data[2]| is greater than 1, no
+  // start code can begin at |data|, |data + 1| or |data + 2|. If it is 1,
+  // none can begin at |data + 1| or |data + 2|.
+  while (end - data >= 3) {
+    if (data[2] > 0x01) {
+      data += 3;
+    } else if (data[2] == 0x01) {
+      if (data[0] == 0x00 && data[1] == 0x00)
+        return data;
+      data += 3;
+    } else {
+      ++data;
+    }
+  }
+  return nullptr;
+}
+
 // Edits |subsamples| given the number of consumed bytes.
 void UpdateSubsamples(uint64_t consumed_bytes,
                       std::vector<SubsampleEntry>* subsamples) {
@@ -311,33 +382,27 @@ bool NaluReader::FindStartCode(const uint8_t* data,
                                uint64_t data_size,
                                uint64_t* offset,
                                uint8_t* start_code_size) {
-  uint64_t bytes_left = data_size;
-
-  while (bytes_left >= 3) {
-    if (IsStartCode(data)) {
-      // Found three-byte start code, set pointer at its beginning.
-      *offset = data_size - bytes_left;
-      *start_code_size = 3;
-
-      // If there is a zero byte before this start code,
-      // then it's actually a four-byte start code, so backtrack one byte.
-      if (*offset > 0 && *(data - 1) == 0x00) {
-        --(*offset);
-        ++(*start_code_size);
-      }
+  const uint8_t* start_code = FindThreeByteStartCode(data, data + data_size);
+  if (!start_code) {
+    // End of data: offset is pointing to the first byte that was not
+    // considered as a possible start of a start code.
+    *offset = data_size < 3 ? 0 : data_size - 2;
+    *start_code_size = 0;
+    return false;
+  }
 
-      return true;
-    }
+  // Found three-byte start code, set pointer at its beginning.
+  *offset = start_code - data;
+  *start_code_size = 3;
 
-    ++data;
-    --bytes_left;
+  // If there is a zero byte before this start code,
+  // then it's actually a four-byte start code, so backtrack one byte.
+  if (*offset > 0 && *(start_code - 1) == 0x00) {
+    --(*offset);
+    ++(*start_code_size);
   }
 
-  // End of data: offset is pointing to the first byte that was not considered
-  // as a possible start of a start code.
-  *offset = data_size - bytes_left;
-  *start_code_size = 0;
-  return false;
+  return true;
 }
 
 // static
@@ -6,6 +6,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "packager/media/codecs/nalu_reader.h"
 
 namespace shaka {
@@ -309,6 +311,55 @@ TEST(NaluReaderTest, SubsamplesWithInvalidNalu) {
   EXPECT_EQ(0x14, nalu.type());
 }
 
+// The start code is found at every position of a buffer longer than the SIMD
+// width, including across the boundaries between the blocks scanned at once.
+TEST(NaluReaderTest, FindStartCodeAtEveryPosition) {
+  const size_t kBufferSize = 100;
+  for (size_t position = 0; position + 3 <= kBufferSize; ++position) {
+    std::vector<uint8_t> buffer(kBufferSize, 0xFF);
+    buffer[position] = 0x00;
+    buffer[position + 1] = 0x00;
+    buffer[position + 2] = 0x01;
+
+    uint64_t offset = 0;
+    uint8_t start_code_size = 0;
+    ASSERT_TRUE(NaluReader::FindStartCode(buffer.data(), buffer.size(),
+                                          &offset, &start_code_size));
+    EXPECT_EQ(position, offset);
+    EXPECT_EQ(3u, start_code_size);
+
+    // Turns it into a four-byte start code.
+    if (position > 0) {
+      buffer[position - 1] = 0x00;
+      ASSERT_TRUE(NaluReader::FindStartCode(buffer.data(), buffer.size(),
+                                            &offset, &start_code_size));
+      EXPECT_EQ(position - 1, offset);
+      EXPECT_EQ(4u, start_code_size);
+    }
+  }
+}
+
+TEST(NaluReaderTest, FindStartCodeNoStartCode) {
+  // Zeros that are never followed by a one.
+  std::vector<uint8_t> buffer;
+  for (int i = 0; i < 30; ++i) {
+    buffer.push_back(0x00);
+    buffer.push_back(0x00);
+    buffer.push_back(0x02);
+  }
+
+  uint64_t offset = 0;
+  uint8_t start_code_size = 0;
+  EXPECT_FALSE(NaluReader::FindStartCode(buffer.data(), buffer.size(), &offset,
+                                         &start_code_size));
+  EXPECT_EQ(buffer.size() - 2, offset);
+  EXPECT_EQ(0u, start_code_size);
+
+  EXPECT_FALSE(NaluReader::FindStartCode(buffer.data(), 2, &offset,
+                                         &start_code_size));
+  EXPECT_EQ(0u, offset);
+}
+
 // No NALU start code in the subsample range. A NALU start code in the buffer
 // not specified by subsamples.
 TEST(NaluReaderTest, FindStartCodeInClearRangeNoNalu) {
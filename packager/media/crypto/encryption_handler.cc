@@ -17,6 +17,7 @@
 #include "packager/media/base/macros.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/base/video_stream_info.h"
+#include "packager/media/base/worker_pool.h"
 #include "packager/media/crypto/aes_encryptor_factory.h"
 #include "packager/media/crypto/subsample_generator.h"
 #include "packager/status_macros.h"
@@ -40,6 +41,11 @@ const uint8_t kKeyRotationDefaultIv[] = {
     0, 0, 0, 0, 0, 0, 0, 0,
 };
 
+// Size of the parts of the protected data of a sample encrypted in parallel.
+// Samples with less than two parts of protected data are encrypted serially,
+// as handing the parts to the workers would cost more than it saves.
+const size_t kParallelEncryptionPartSize = 256 * 1024;
+
 std::string GetStreamLabelForEncryption(
     const StreamInfo& stream_info,
     const std::function<std::string(
@@ -203,36 +209,33 @@ Status EncryptionHandler::ProcessMediaSample(
     return DispatchMediaSample(kStreamIndex, std::move(clear_sample));
   }
 
-  std::shared_ptr<uint8_t> cipher_sample_data(
-      new uint8_t[clear_sample->data_size()], std::default_delete<uint8_t[]>());
-
-  const uint8_t* source = clear_sample->data();
-  uint8_t* dest = cipher_sample_data.get();
-  if (!subsamples.empty()) {
-    size_t total_size = 0;
-    for (const SubsampleEntry& subsample : subsamples) {
-      if (subsample.clear_bytes > 0) {
-        memcpy(dest, source, subsample.clear_bytes);
-        source += subsample.clear_bytes;
-        dest += subsample.clear_bytes;
+  // The clone shares the data buffer with |clear_sample|. Release
+  // |clear_sample| so the buffer is encrypted in place if this handler is its
+  // only owner; otherwise, e.g. if the sample is also sent to other outputs,
+  // writable_data() makes a private copy first.
+  const size_t sample_size = clear_sample->data_size();
+  std::shared_ptr<MediaSample> cipher_sample(clear_sample->Clone());
+  clear_sample.reset();
+
+  uint8_t* data = cipher_sample->writable_data();
+  if (!EncryptInParallel(subsamples, sample_size, data)) {
+    if (!subsamples.empty()) {
+      size_t total_size = 0;
+      for (const SubsampleEntry& subsample : subsamples) {
+        data += subsample.clear_bytes;
         total_size += subsample.clear_bytes;
+        if (subsample.cipher_bytes > 0) {
+          EncryptBytes(data, subsample.cipher_bytes, data);
+          data += subsample.cipher_bytes;
+          total_size += subsample.cipher_bytes;
+        }
       }
-      if (subsample.cipher_bytes > 0) {
-        EncryptBytes(source, subsample.cipher_bytes, dest);
-        source += subsample.cipher_bytes;
-        dest += subsample.cipher_bytes;
-        total_size += subsample.cipher_bytes;
-      }
+      DCHECK_EQ(total_size, sample_size);
+    } else {
+      EncryptBytes(data, sample_size, data);
     }
-    DCHECK_EQ(total_size, clear_sample->data_size());
-  } else {
-    EncryptBytes(source, clear_sample->data_size(), dest);
   }
 
-  std::shared_ptr<MediaSample> cipher_sample(clear_sample->Clone());
-  cipher_sample->TransferData(std::move(cipher_sample_data),
-                              clear_sample->data_size());
-
   // Finish initializing the sample before sending it downstream. We must
   // wait until now to finish the initialization as we will lose access to
   // |decrypt_config| once we set it.
@@ -269,6 +272,7 @@ bool EncryptionHandler::CreateEncryptor(const EncryptionKey& encryption_key) {
   if (!encryptor)
     return false;
   encryptor_ = std::move(encryptor);
+  key_ = encryption_key.key;
 
   encryption_config_.reset(new EncryptionConfig);
   encryption_config_->protection_scheme = protection_scheme_;
@@ -297,6 +301,87 @@ void EncryptionHandler::EncryptBytes(const uint8_t* source,
   CHECK(encryptor_->Crypt(source, source_size, dest));
 }
 
+bool EncryptionHandler::EncryptInParallel(
+    const std::vector<SubsampleEntry>& subsamples,
+    size_t sample_size,
+    uint8_t* data) {
+  // Only 'cenc' has a single key stream per sample, which is contiguous over
+  // the protected ranges, so every part can be encrypted independently once
+  // its position in the key stream is known.
+  if (encryption_params_.num_encryption_workers == 0 ||
+      protection_scheme_ != FOURCC_cenc) {
+    return false;
+  }
+
+  // The protected ranges, as offsets in |data| and in the key stream.
+  struct ProtectedRange {
+    size_t data_offset;
+    size_t key_stream_offset;
+    size_t size;
+  };
+  std::vector<ProtectedRange> ranges;
+  size_t protected_size = 0;
+  if (subsamples.empty()) {
+    ranges.push_back({0, 0, sample_size});
+    protected_size = sample_size;
+  } else {
+    size_t data_offset = 0;
+    for (const SubsampleEntry& subsample : subsamples) {
+      data_offset += subsample.clear_bytes;
+      if (subsample.cipher_bytes > 0) {
+        ranges.push_back({data_offset, protected_size, subsample.cipher_bytes});
+        data_offset += subsample.cipher_bytes;
+        protected_size += subsample.cipher_bytes;
+      }
+    }
+    DCHECK_EQ(data_offset, sample_size);
+  }
+
+  const size_t num_parts =
+      (protected_size + kParallelEncryptionPartSize - 1) /
+      kParallelEncryptionPartSize;
+  if (num_parts < 2)
+    return false;
+
+  // Every part gets its own encryptor, positioned at the start of the part in
+  // the key stream of the sample.
+  std::vector<std::unique_ptr<AesCryptor>> part_encryptors(num_parts);
+  for (size_t i = 0; i < num_parts; ++i) {
+    part_encryptors[i] = encryptor_factory_->CreateEncryptor(
+        protection_scheme_, crypt_byte_block_, skip_byte_block_, codec_, key_,
+        encryptor_->iv());
+    if (!part_encryptors[i] ||
+        !part_encryptors[i]->SkipBytes(i * kParallelEncryptionPartSize)) {
+      return false;
+    }
+  }
+  // Leave |encryptor_| as if it had encrypted the sample, for the next iv.
+  if (!encryptor_->SkipBytes(protected_size))
+    return false;
+
+  WorkerPool::GetInstance()->RunParts(
+      num_parts, encryption_params_.num_encryption_workers,
+      [&ranges, &part_encryptors, protected_size, data](size_t part_index) {
+        const size_t part_start = part_index * kParallelEncryptionPartSize;
+        const size_t part_end =
+            std::min(part_start + kParallelEncryptionPartSize, protected_size);
+        AesCryptor* encryptor = part_encryptors[part_index].get();
+        for (const ProtectedRange& range : ranges) {
+          const size_t range_end = range.key_stream_offset + range.size;
+          if (range_end <= part_start)
+            continue;
+          if (range.key_stream_offset >= part_end)
+            break;
+          const size_t start = std::max(part_start, range.key_stream_offset);
+          const size_t end = std::min(part_end, range_end);
+          uint8_t* range_data =
+              data + range.data_offset + (start - range.key_stream_offset);
+          CHECK(encryptor->Crypt(range_data, end - start, range_data));
+        }
+      });
+  return true;
+}
+
 void EncryptionHandler::InjectSubsampleGeneratorForTesting(
     std::unique_ptr<SubsampleGenerator> generator) {
   subsample_generator_ = std::move(generator);
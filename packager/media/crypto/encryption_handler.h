@@ -18,6 +18,7 @@ class AesCryptor;
 class AesEncryptorFactory;
 class SubsampleGenerator;
 struct EncryptionKey;
+struct SubsampleEntry;
 
 class EncryptionHandler : public MediaHandler {
  public:
@@ -54,6 +55,16 @@ class EncryptionHandler : public MediaHandler {
   // Encrypt an array with size |source_size|. |dest| should have at
   // least |source_size| bytes.
   void EncryptBytes(const uint8_t* source, size_t source_size, uint8_t* dest);
+  // Encrypt the protected ranges of the sample |data| in place, split in parts
+  // encrypted in parallel on the shared worker pool. The output is the same as
+  // the one of serial encryption. |subsamples| are the sample subsamples,
+  // empty if the whole sample is protected.
+  // Returns false, without touching |data| or |encryptor_|, if the sample is
+  // not large enough or the protection scheme or the encryptor does not
+  // support it, in which case the sample should be encrypted serially.
+  bool EncryptInParallel(const std::vector<SubsampleEntry>& subsamples,
+                         size_t sample_size,
+                         uint8_t* data);
 
   // An E-AC3 frame comprises of one or more syncframes. This function extracts
   // the syncframe sizes from the source bytes.
@@ -75,6 +86,9 @@ class EncryptionHandler : public MediaHandler {
   // Current encryption config and encryptor.
   std::shared_ptr<EncryptionConfig> encryption_config_;
   std::unique_ptr<AesCryptor> encryptor_;
+  // The key of |encryptor_|, used to create the encryptors of the parts of
+  // the samples encrypted in parallel.
+  std::vector<uint8_t> key_;
   Codec codec_ = kUnknownCodec;
   // Remaining clear lead in the stream's time scale.
   int64_t remaining_clear_lead_ = 0;
@@ -13,6 +13,7 @@
 #include "packager/media/base/media_handler_test_base.h"
 #include "packager/media/base/mock_aes_cryptor.h"
 #include "packager/media/base/raw_key_source.h"
+#include "packager/media/base/worker_pool.h"
 #include "packager/media/crypto/aes_encryptor_factory.h"
 #include "packager/media/crypto/subsample_generator.h"
 #include "packager/status_test_util.h"
@@ -554,6 +555,156 @@ TEST_P(EncryptionHandlerSubsampleTest, SubsampleTest) {
   EXPECT_EQ(GetParam().subsamples, decrypt_config.subsamples());
 }
 
+TEST_F(EncryptionHandlerTest, SharedSampleNotModified) {
+  std::unique_ptr<MockAesCryptor> mock_encryptor(new MockAesCryptor);
+  EXPECT_CALL(*mock_encryptor, CryptInternal(_, _, _, _))
+      .WillRepeatedly(Invoke(MockEncrypt));
+  ASSERT_TRUE(mock_encryptor->SetIv(
+      std::vector<uint8_t>(std::begin(kIv), std::end(kIv))));
+
+  std::unique_ptr<MockAesEncryptorFactory> mock_encryptor_factory(
+      new MockAesEncryptorFactory);
+  EXPECT_CALL(*mock_encryptor_factory, CreateEncryptor(_, _, _, _, _, _))
+      .WillOnce(Return(ByMove(std::move(mock_encryptor))));
+  InjectEncryptorFactoryForTesting(std::move(mock_encryptor_factory));
+
+  EXPECT_CALL(mock_key_source_, GetKey(_, _))
+      .WillOnce(
+          DoAll(SetArgPointee<1>(GetMockEncryptionKey()), Return(Status::OK)));
+
+  ASSERT_OK(Process(StreamData::FromStreamInfo(
+      kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+  // Keep a reference to the clear sample, as if it was sent to other outputs
+  // too. It should not be encrypted in place.
+  std::shared_ptr<MediaSample> clear_sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  ASSERT_OK(Process(StreamData::FromMediaSample(kStreamIndex, clear_sample)));
+
+  EXPECT_EQ(std::vector<uint8_t>(std::begin(kData), std::end(kData)),
+            std::vector<uint8_t>(clear_sample->data(),
+                                 clear_sample->data() + kDataSize));
+
+  const MediaSample& sample =
+      *GetOutputStreamDataVector().back()->media_sample;
+  EXPECT_EQ(
+      kSubsampleTestCases[0].expected_output,
+      std::vector<uint8_t>(sample.data(), sample.data() + sample.data_size()));
+}
+
+TEST_F(EncryptionHandlerTest, SoleOwnerSampleEncryptedInPlace) {
+  std::unique_ptr<MockAesCryptor> mock_encryptor(new MockAesCryptor);
+  EXPECT_CALL(*mock_encryptor, CryptInternal(_, _, _, _))
+      .WillRepeatedly(Invoke(MockEncrypt));
+  ASSERT_TRUE(mock_encryptor->SetIv(
+      std::vector<uint8_t>(std::begin(kIv), std::end(kIv))));
+
+  std::unique_ptr<MockAesEncryptorFactory> mock_encryptor_factory(
+      new MockAesEncryptorFactory);
+  EXPECT_CALL(*mock_encryptor_factory, CreateEncryptor(_, _, _, _, _, _))
+      .WillOnce(Return(ByMove(std::move(mock_encryptor))));
+  InjectEncryptorFactoryForTesting(std::move(mock_encryptor_factory));
+
+  EXPECT_CALL(mock_key_source_, GetKey(_, _))
+      .WillOnce(
+          DoAll(SetArgPointee<1>(GetMockEncryptionKey()), Return(Status::OK)));
+
+  ASSERT_OK(Process(StreamData::FromStreamInfo(
+      kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+  // The handler is the only owner of the clear sample, so its buffer is
+  // encrypted and sent downstream without being copied.
+  std::shared_ptr<MediaSample> clear_sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  const uint8_t* clear_data = clear_sample->data();
+  ASSERT_OK(Process(
+      StreamData::FromMediaSample(kStreamIndex, std::move(clear_sample))));
+
+  const MediaSample& sample =
+      *GetOutputStreamDataVector().back()->media_sample;
+  EXPECT_EQ(clear_data, sample.data());
+  EXPECT_EQ(
+      kSubsampleTestCases[0].expected_output,
+      std::vector<uint8_t>(sample.data(), sample.data() + sample.data_size()));
+}
+
+// Verifies that the samples encrypted in parallel are the same as the ones
+// encrypted serially.
+class EncryptionHandlerParallelTest : public EncryptionHandlerTest {
+ protected:
+  // Encrypts two large samples with the real encryptor and returns the
+  // encrypted data and the iv of the samples.
+  void EncryptSamples(uint32_t num_encryption_workers,
+                      const std::vector<SubsampleEntry>& subsamples,
+                      std::vector<std::vector<uint8_t>>* encrypted_data,
+                      std::vector<std::vector<uint8_t>>* ivs) {
+    EncryptionParams encryption_params;
+    encryption_params.num_encryption_workers = num_encryption_workers;
+    SetUpEncryptionHandler(encryption_params);
+    ClearOutputStreamDataVector();
+    InjectSubsamples(subsamples);
+    EXPECT_CALL(mock_key_source_, GetKey(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(GetMockEncryptionKey()),
+                        Return(Status::OK)));
+
+    ASSERT_OK(Process(StreamData::FromStreamInfo(
+        kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+    std::vector<uint8_t> data(kLargeSampleSize);
+    for (size_t i = 0; i < data.size(); ++i)
+      data[i] = static_cast<uint8_t>(i * 7);
+    for (int64_t timestamp : {int64_t{0}, kSampleDuration}) {
+      ASSERT_OK(Process(StreamData::FromMediaSample(
+          kStreamIndex, GetMediaSample(timestamp, kSampleDuration, kIsKeyFrame,
+                                       data.data(), data.size()))));
+    }
+
+    for (const auto& stream_data : GetOutputStreamDataVector()) {
+      if (!stream_data->media_sample)
+        continue;
+      const MediaSample& sample = *stream_data->media_sample;
+      encrypted_data->emplace_back(sample.data(),
+                                   sample.data() + sample.data_size());
+      ivs->push_back(sample.decrypt_config()->iv());
+    }
+    ASSERT_EQ(2u, encrypted_data->size());
+  }
+
+  void VerifyParallelMatchesSerial(
+      const std::vector<SubsampleEntry>& subsamples) {
+    std::vector<std::vector<uint8_t>> serial_data;
+    std::vector<std::vector<uint8_t>> serial_ivs;
+    ASSERT_NO_FATAL_FAILURE(
+        EncryptSamples(0, subsamples, &serial_data, &serial_ivs));
+    std::vector<std::vector<uint8_t>> parallel_data;
+    std::vector<std::vector<uint8_t>> parallel_ivs;
+    ASSERT_NO_FATAL_FAILURE(
+        EncryptSamples(3, subsamples, &parallel_data, &parallel_ivs));
+
+    EXPECT_GE(WorkerPool::GetInstance()->num_workers(), 3u);
+
+    EXPECT_TRUE(serial_data == parallel_data);
+    EXPECT_EQ(serial_ivs, parallel_ivs);
+    EXPECT_NE(serial_ivs[0], serial_ivs[1]);
+  }
+
+  // Large enough to be split in several parts, which do not end on subsample
+  // or block boundaries.
+  const size_t kLargeSampleSize = 1024 * 1024 + 123;
+};
+
+TEST_F(EncryptionHandlerParallelTest, FullSample) {
+  VerifyParallelMatchesSerial(std::vector<SubsampleEntry>());
+}
+
+TEST_F(EncryptionHandlerParallelTest, Subsamples) {
+  std::vector<SubsampleEntry> subsamples;
+  size_t remaining_size = kLargeSampleSize;
+  for (uint32_t cipher_bytes : {100001u, 5u, 300017u, 0u, 200003u}) {
+    subsamples.push_back(SubsampleEntry(7, cipher_bytes));
+    remaining_size -= 7 + cipher_bytes;
+  }
+  subsamples.push_back(SubsampleEntry(11, remaining_size - 11));
+  VerifyParallelMatchesSerial(subsamples);
+}
+
 class EncryptionHandlerTrackTypeTest : public EncryptionHandlerTest {};
 
 TEST_F(EncryptionHandlerTrackTypeTest, AudioTrackType) {
@@ -6,6 +6,9 @@
 
 #include "packager/media/demuxer/demuxer.h"
 
+#include <gflags/gflags.h>
+#include <string.h>
+
 #include <algorithm>
 
 #include "packager/base/bind.h"
@@ -21,6 +24,13 @@
 #include "packager/media/formats/mp4/mp4_media_parser.h"
 #include "packager/media/formats/webm/webm_media_parser.h"
 #include "packager/media/formats/wvm/wvm_media_parser.h"
+#include "packager/status_macros.h"
+
+DEFINE_bool(mmap_local_input,
+            true,
+            "Memory map local input files, so they are parsed without "
+            "copying the data through an intermediate read buffer. Ignored "
+            "on Windows.");
 
 namespace {
 // 65KB, sufficient to determine the container and likely all init data.
@@ -67,6 +77,31 @@ bool GetStreamIndex(const std::string& stream_label, size_t* stream_index) {
   return true;
 }
 
+// Opens |file_name| for reading. Local regular files are memory mapped if
+// enabled, falling back to regular reads if mapping fails. The name the file
+// was opened with is returned in |opened_file_name|.
+shaka::File* OpenMediaFile(const std::string& file_name,
+                           std::string* opened_file_name) {
+  if (FLAGS_mmap_local_input &&
+      shaka::File::IsLocalRegularFile(file_name.c_str())) {
+    const size_t prefix_length = strlen(shaka::kLocalFilePrefix);
+    const std::string local_file_name =
+        file_name.compare(0, prefix_length, shaka::kLocalFilePrefix) == 0
+            ? file_name.substr(prefix_length)
+            : file_name;
+    const std::string mapped_file_name =
+        shaka::kMappedFilePrefix + local_file_name;
+    shaka::File* file = shaka::File::Open(mapped_file_name.c_str(), "r");
+    if (file) {
+      *opened_file_name = mapped_file_name;
+      return file;
+    }
+    VLOG(1) << "Cannot memory map " << file_name << ", reading it instead.";
+  }
+  *opened_file_name = file_name;
+  return shaka::File::Open(file_name.c_str(), "r");
+}
+
 }
 
 namespace shaka {
@@ -86,40 +121,38 @@ void Demuxer::SetKeySource(std::unique_ptr<KeySource> key_source) {
 
 Status Demuxer::Run() {
   LOG(INFO) << "Demuxer::Run() on file '" << file_name_ << "'.";
-  Status status = InitializeParser();
-  // ParserInitEvent callback is called after a few calls to Parse(), which sets
-  // up the streams. Only after that, we can verify the outputs below.
-  while (!all_streams_ready_ && status.ok())
-    status.Update(Parse());
-  // If no output is defined, then return success after receiving all stream
-  // info.
-  if (all_streams_ready_ && output_handlers().empty())
+  bool done = false;
+  Status status;
+  while (!done && status.ok())
+    status = RunSlice(&done);
+  return status;
+}
+
+Status Demuxer::RunSlice(bool* done) {
+  DCHECK(done);
+  *done = true;
+  if (!streams_initialized_) {
+    RETURN_IF_ERROR(InitializeStreams());
+    streams_initialized_ = true;
+    // If no output is defined, then return success after receiving all stream
+    // info.
+    *done = output_handlers().empty();
     return Status::OK;
-  if (!init_event_status_.ok())
-    return init_event_status_;
-  if (!status.ok())
-    return status;
-  // Check if all specified outputs exists.
-  for (const auto& pair : output_handlers()) {
-    if (std::find(stream_indexes_.begin(), stream_indexes_.end(), pair.first) ==
-        stream_indexes_.end()) {
-      LOG(ERROR) << "Invalid argument, stream=" << GetStreamLabel(pair.first)
-                 << " not available.";
-      return Status(error::INVALID_ARGUMENT, "Stream not available");
-    }
   }
 
-  while (!cancelled_ && status.ok())
-    status.Update(Parse());
-  if (cancelled_ && status.ok())
+  if (cancelled_)
     return Status(error::CANCELLED, "Demuxer run cancelled");
 
+  // Every slice parses one buffer of input, which ends at a sample boundary
+  // from the downstream handlers' point of view.
+  Status status = Parse();
+  if (status.ok()) {
+    *done = false;
+    return status;
+  }
   if (status.error_code() == error::END_OF_STREAM) {
-    for (size_t stream_index : stream_indexes_) {
-      status = FlushDownstream(stream_index);
-      if (!status.ok())
-        return status;
-    }
+    for (size_t stream_index : stream_indexes_)
+      RETURN_IF_ERROR(FlushDownstream(stream_index));
     return Status::OK;
   }
   return status;
@@ -153,30 +186,68 @@ Demuxer::QueuedSample::QueuedSample(uint32_t local_track_id,
 
 Demuxer::QueuedSample::~QueuedSample() {}
 
+Status Demuxer::InitializeStreams() {
+  Status status = InitializeParser();
+  // ParserInitEvent callback is called after a few calls to Parse(), which sets
+  // up the streams. Only after that, we can verify the outputs below.
+  while (!all_streams_ready_ && status.ok())
+    status.Update(Parse());
+  if (all_streams_ready_ && output_handlers().empty())
+    return Status::OK;
+  if (!init_event_status_.ok())
+    return init_event_status_;
+  if (!status.ok())
+    return status;
+  // Check if all specified outputs exists.
+  for (const auto& pair : output_handlers()) {
+    if (std::find(stream_indexes_.begin(), stream_indexes_.end(), pair.first) ==
+        stream_indexes_.end()) {
+      LOG(ERROR) << "Invalid argument, stream=" << GetStreamLabel(pair.first)
+                 << " not available.";
+      return Status(error::INVALID_ARGUMENT, "Stream not available");
+    }
+  }
+  return Status::OK;
+}
+
 Status Demuxer::InitializeParser() {
   DCHECK(!media_file_);
   DCHECK(!all_streams_ready_);
 
   LOG(INFO) << "Initialize Demuxer for file '" << file_name_ << "'.";
 
-  media_file_ = File::Open(file_name_.c_str(), "r");
+  std::string media_file_name;
+  media_file_ = OpenMediaFile(file_name_, &media_file_name);
   if (!media_file_) {
     return Status(error::FILE_FAILURE,
                   "Cannot open file for reading " + file_name_);
   }
 
-  // Read enough bytes before detecting the container.
+  // Read enough bytes before detecting the container. Files supporting it are
+  // read in place, which returns all the bytes available in one call, unless
+  // the data read only stays valid until the next read.
+  const uint8_t* data = buffer_.get();
   int64_t bytes_read = 0;
-  while (static_cast<size_t>(bytes_read) < kInitBufSize) {
-    int64_t read_result =
-        media_file_->Read(buffer_.get() + bytes_read, kInitBufSize);
-    if (read_result < 0)
+  if (media_file_->SupportsReadInPlace() &&
+      media_file_->ReadInPlaceDataStaysValid()) {
+    bytes_read = media_file_->ReadInPlace(&data, kInitBufSize);
+    if (bytes_read < 0)
       return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
-    if (read_result == 0)
-      break;
-    bytes_read += read_result;
+    // There is nothing mapped to point to if the file is empty.
+    if (bytes_read == 0)
+      data = buffer_.get();
+  } else {
+    while (static_cast<size_t>(bytes_read) < kInitBufSize) {
+      int64_t read_result =
+          media_file_->Read(buffer_.get() + bytes_read, kInitBufSize);
+      if (read_result < 0)
+        return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
+      if (read_result == 0)
+        break;
+      bytes_read += read_result;
+    }
   }
-  container_name_ = DetermineContainer(buffer_.get(), bytes_read);
+  container_name_ = DetermineContainer(data, bytes_read);
 
   // Initialize media parser.
   switch (container_name_) {
@@ -209,10 +280,13 @@ Status Demuxer::InitializeParser() {
                 base::Bind(&Demuxer::NewSampleEvent, base::Unretained(this)),
                 key_source_.get());
 
-  // Handle trailing 'moov'.
-  if (container_name_ == CONTAINER_MOV)
-    static_cast<mp4::MP4MediaParser*>(parser_.get())->LoadMoov(file_name_);
-  if (!parser_->Parse(buffer_.get(), bytes_read)) {
+  // Handle trailing 'moov'. The samples of a mapped file are then read from
+  // the mapping.
+  if (container_name_ == CONTAINER_MOV) {
+    static_cast<mp4::MP4MediaParser*>(parser_.get())
+        ->LoadMoov(media_file_name);
+  }
+  if (!ParseData(data, bytes_read)) {
     return Status(error::PARSER_FAILURE,
                   "Cannot parse media file " + file_name_);
   }
@@ -276,6 +350,7 @@ void Demuxer::ParserInitEvent(
     } else {
       track_id_to_stream_index_map_[stream_info->track_id()] =
           kInvalidStreamIndex;
+      parser_->DisableTrack(stream_info->track_id());
     }
     ++base_stream_index;
   }
@@ -327,7 +402,24 @@ Status Demuxer::Parse() {
   DCHECK(parser_);
   DCHECK(buffer_);
 
-  int64_t bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  if (parser_->ReadsInputDirectly()) {
+    bool eos = false;
+    if (!parser_->ParseDirectly(&eos)) {
+      return Status(error::PARSER_FAILURE,
+                    "Cannot parse media file " + file_name_);
+    }
+    if (eos) {
+      if (!parser_->Flush())
+        return Status(error::PARSER_FAILURE, "Failed to flush.");
+      return Status(error::END_OF_STREAM, "");
+    }
+    return Status::OK;
+  }
+
+  const uint8_t* data = buffer_.get();
+  int64_t bytes_read = media_file_->SupportsReadInPlace()
+                           ? media_file_->ReadInPlace(&data, kBufSize)
+                           : media_file_->Read(buffer_.get(), kBufSize);
   if (bytes_read == 0) {
     if (!parser_->Flush())
       return Status(error::PARSER_FAILURE, "Failed to flush.");
@@ -336,11 +428,24 @@ Status Demuxer::Parse() {
     return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
   }
 
-  return parser_->Parse(buffer_.get(), bytes_read)
+  return ParseData(data, bytes_read)
              ? Status::OK
              : Status(error::PARSER_FAILURE,
                       "Cannot parse media file " + file_name_);
 }
 
+bool Demuxer::ParseData(const uint8_t* data, int64_t size) {
+  // The parser does not need the data if it reads the input by itself.
+  if (parser_->ReadsInputDirectly())
+    return true;
+  // Data read in place may stay valid until |media_file_| is closed, which
+  // happens after the parser is done with it. Otherwise the parser copies
+  // what it needs, e.g. for data read in place from a UDP receive ring.
+  return media_file_->SupportsReadInPlace() &&
+                 media_file_->ReadInPlaceDataStaysValid()
+             ? parser_->ParseInPlace(data, size)
+             : parser_->Parse(data, size);
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -48,6 +48,10 @@ class Demuxer : public OriginHandler {
   /// the Data to Muxer until Eof.
   Status Run() override;
 
+  /// Read and parse the next chunk of the file and push the data to Muxer.
+  /// The first slice initializes the parser and the streams.
+  Status RunSlice(bool* done) override;
+
   /// Cancel a demuxing job in progress. Will cause @a Run to exit with an error
   /// status of type CANCELLED.
   void Cancel() override;
@@ -107,6 +111,11 @@ class Demuxer : public OriginHandler {
   // @return OK on success.
   Status InitializeParser();
 
+  // Initialize the parser and parse until all streams are ready, then verify
+  // that the specified outputs exist.
+  // @return OK on success.
+  Status InitializeStreams();
+
   // Parser init event.
   void ParserInitEvent(const std::vector<std::shared_ptr<StreamInfo>>& streams);
   // Parser new sample event handler. Queues the samples if init event has not
@@ -120,11 +129,15 @@ class Demuxer : public OriginHandler {
 
   // Read from the source and send it to the parser.
   Status Parse();
+  // Send |data| read from |media_file_| to the parser.
+  bool ParseData(const uint8_t* data, int64_t size);
 
   std::string file_name_;
   File* media_file_ = nullptr;
   // A stream is considered ready after receiving the stream info.
   bool all_streams_ready_ = false;
+  // Set after InitializeStreams() succeeds in the first slice.
+  bool streams_initialized_ = false;
   // Queued samples received in NewSampleEvent() before ParserInitEvent().
   std::deque<QueuedSample> queued_samples_;
   std::unique_ptr<MediaParser> parser_;
@@ -72,6 +72,35 @@ TEST_F(DemuxerTest, EncryptedContentWithKeySource) {
   EXPECT_OK(demuxer.Run());
 }
 
+TEST_F(DemuxerTest, RunSlice) {
+  Demuxer demuxer(
+      GetTestDataFilePath("bear-640x360-av_frag.mp4").AsUTF8Unsafe());
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+
+  // The first slice initializes the streams without consuming the rest of the
+  // file.
+  bool done = false;
+  ASSERT_OK(demuxer.RunSlice(&done));
+  EXPECT_FALSE(done);
+
+  while (!done)
+    ASSERT_OK(demuxer.RunSlice(&done));
+}
+
+TEST_F(DemuxerTest, RunSliceCancelled) {
+  Demuxer demuxer(
+      GetTestDataFilePath("bear-640x360-av_frag.mp4").AsUTF8Unsafe());
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+
+  bool done = false;
+  ASSERT_OK(demuxer.RunSlice(&done));
+  ASSERT_FALSE(done);
+
+  demuxer.Cancel();
+  EXPECT_EQ(error::CANCELLED, demuxer.RunSlice(&done).error_code());
+  EXPECT_TRUE(done);
+}
+
 // TODO(kqyang): Add more tests.
 
 }  // namespace media
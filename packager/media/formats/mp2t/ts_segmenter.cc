@@ -97,6 +97,10 @@ Status TsSegmenter::AddSample(const MediaSample& sample) {
       pmt_writer.reset(new VideoProgramMapTableWriter(codec_));
     }
     ts_writer_.reset(new TsWriter(std::move(pmt_writer)));
+    if (!muxer_options_.udp_output.empty() &&
+        !ts_writer_->OpenStreamOutput(muxer_options_.udp_output)) {
+      return Status(error::FILE_FAILURE, "Failed to open UDP output.");
+    }
   }
 
   if (sample.is_encrypted())
@@ -8,7 +8,9 @@
 
 #include <algorithm>
 
+#include "packager/base/bind.h"
 #include "packager/base/logging.h"
+#include "packager/base/time/time.h"
 #include "packager/media/base/buffer_writer.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/formats/mp2t/pes_packet.h"
@@ -56,6 +58,27 @@ const int kTsPacketMaximumPayloadSize =
 
 const size_t kMaxPesPacketLengthValue = 0xFFFF;
 
+// The segment buffer initially has room for this many TS packets, about 3 MB,
+// which holds a few seconds of HD video. It grows as needed and keeps its
+// capacity across segments.
+const size_t kInitialSegmentBufferSizeInPackets = 16 * 1024;
+
+// The TS packets are sent to the stream output in groups of seven, which is
+// the most that fits in a datagram on an Ethernet network.
+const size_t kStreamOutputGroupSize = 7 * kTsPacketSize;
+
+const uint64_t kPcrTimescale = 90000;
+// A larger PCR jump is a discontinuity: the stream time does not advance.
+const uint64_t kMaxPcrJump = 1 * kPcrTimescale;
+// The pacing starts over if the stream output falls behind by more than this.
+const int64_t kMaxPacingDriftInSeconds = 1;
+// The muxer waits for the stream output if this many groups, about 10 MB, are
+// queued, i.e. if it is far ahead of real time.
+const size_t kMaxQueuedStreamOutputGroups = 8 * 1024;
+// At most this many groups which are due are sent with one write, so that a
+// UDP output sends them with one system call.
+const size_t kMaxStreamOutputBatchSize = 64;
+
 void WritePatToBuffer(const uint8_t* pat,
                       int pat_size,
                       ContinuityCounter* continuity_counter,
@@ -87,9 +110,9 @@ void WritePtsOrDts(uint8_t leading_bits,
   writer->AppendInt(fifth_byte);
 }
 
-bool WritePesToFile(const PesPacket& pes,
-                    ContinuityCounter* continuity_counter,
-                    File* file) {
+void WritePesToBuffer(const PesPacket& pes,
+                      ContinuityCounter* continuity_counter,
+                      BufferWriter* writer) {
   // The size of the length field.
   const int kAdaptationFieldLengthSize = 1;
   // The size of the flags field.
@@ -140,28 +163,57 @@ bool WritePesToFile(const PesPacket& pes,
   const size_t bytes_consumed = std::min(pes.data().size(), available_payload);
   first_ts_packet_buffer.AppendArray(pes.data().data(), bytes_consumed);
 
-  BufferWriter output_writer;
   WritePayloadToBufferWriter(first_ts_packet_buffer.Buffer(),
                              first_ts_packet_buffer.Size(),
                              kPayloadUnitStartIndicator, pid, kHasPcr, pcr_base,
-                             continuity_counter, &output_writer);
+                             continuity_counter, writer);
 
   const size_t remaining_pes_data_size = pes.data().size() - bytes_consumed;
   if (remaining_pes_data_size > 0) {
     WritePayloadToBufferWriter(pes.data().data() + bytes_consumed,
                                remaining_pes_data_size,
                                !kPayloadUnitStartIndicator, pid, !kHasPcr, 0,
-                               continuity_counter, &output_writer);
+                               continuity_counter, writer);
   }
-  return output_writer.WriteToFile(file).ok();
 }
 
 }  // namespace
 
 TsWriter::TsWriter(std::unique_ptr<ProgramMapTableWriter> pmt_writer)
-    : pmt_writer_(std::move(pmt_writer)) {}
+    : pmt_writer_(std::move(pmt_writer)),
+      segment_buffer_(kInitialSegmentBufferSizeInPackets * kTsPacketSize),
+      stream_output_cv_(&stream_output_lock_) {}
+
+TsWriter::~TsWriter() {
+  if (!stream_output_thread_)
+    return;
+  // Send the last TS packets, which may not make a complete group, then let
+  // the queued groups be sent.
+  CopyToStreamOutputPending();
+  QueueStreamOutputGroups(0, true);
+  {
+    base::AutoLock auto_lock(stream_output_lock_);
+    stopping_stream_output_ = true;
+    stream_output_cv_.Signal();
+  }
+  stream_output_thread_->Join();
+}
 
-TsWriter::~TsWriter() {}
+bool TsWriter::OpenStreamOutput(const std::string& file_name) {
+  DCHECK(!current_file_);
+  DCHECK(!stream_output_thread_);
+  // The data is not buffered, so that it is sent when paced.
+  stream_output_.reset(File::OpenWithNoBuffering(file_name.c_str(), "w"));
+  if (!stream_output_) {
+    LOG(ERROR) << "Failed to open stream output " << file_name;
+    return false;
+  }
+  stream_output_thread_.reset(new ClosureThread(
+      "TsStreamOutput",
+      base::Bind(&TsWriter::SendStreamOutput, base::Unretained(this))));
+  stream_output_thread_->Start();
+  return true;
+}
 
 bool TsWriter::NewSegment(const std::string& file_name) {
   if (current_file_) {
@@ -174,23 +226,20 @@ bool TsWriter::NewSegment(const std::string& file_name) {
     return false;
   }
 
-  BufferWriter psi;
-  WritePatToBuffer(kPat, arraysize(kPat), &pat_continuity_counter_, &psi);
+  DCHECK_EQ(0u, segment_buffer_.Size());
+  WritePatToBuffer(kPat, arraysize(kPat), &pat_continuity_counter_,
+                   &segment_buffer_);
   if (encrypted_) {
-    if (!pmt_writer_->EncryptedSegmentPmt(&psi)) {
+    if (!pmt_writer_->EncryptedSegmentPmt(&segment_buffer_)) {
+      segment_buffer_.Clear();
       return false;
     }
   } else {
-    if (!pmt_writer_->ClearSegmentPmt(&psi)) {
+    if (!pmt_writer_->ClearSegmentPmt(&segment_buffer_)) {
+      segment_buffer_.Clear();
       return false;
     }
   }
-
-  if (!psi.WriteToFile(current_file_.get()).ok()) {
-    LOG(ERROR) << "Failed to write PSI to file.";
-    return false;
-  }
-
   return true;
 }
 
@@ -199,16 +248,37 @@ void TsWriter::SignalEncrypted() {
 }
 
 bool TsWriter::FinalizeSegment() {
-  return current_file_.release()->Close();
+  DCHECK(current_file_);
+  DCHECK_EQ(0u, segment_buffer_.Size() % kTsPacketSize);
+  // The segment buffer is reused by the next segment.
+  if (stream_output_thread_) {
+    CopyToStreamOutputPending();
+    stream_output_position_ = 0;
+  }
+  // The whole segment is written at once. WriteToFile also empties the buffer
+  // while keeping its capacity for the next segment.
+  bool write_ok = true;
+  if (segment_buffer_.Size() > 0) {
+    write_ok = segment_buffer_.WriteToFile(current_file_.get()).ok();
+    if (!write_ok) {
+      LOG(ERROR) << "Failed to write segment to file "
+                 << current_file_->file_name();
+      segment_buffer_.Clear();
+    }
+  }
+  const bool close_ok = current_file_.release()->Close();
+  return write_ok && close_ok;
 }
 
 bool TsWriter::AddPesPacket(std::unique_ptr<PesPacket> pes_packet) {
   DCHECK(current_file_);
-  if (!WritePesToFile(*pes_packet, &elementary_stream_continuity_counter_,
-                      current_file_.get())) {
-    LOG(ERROR) << "Failed to write pes to file.";
+  if (stream_output_thread_ &&
+      !QueueStreamOutput(pes_packet->has_dts() ? pes_packet->dts()
+                                               : pes_packet->pts())) {
     return false;
   }
+  WritePesToBuffer(*pes_packet, &elementary_stream_continuity_counter_,
+                   &segment_buffer_);
 
   // No need to keep pes_packet around so not passing it anywhere.
   return true;
@@ -217,9 +287,129 @@ bool TsWriter::AddPesPacket(std::unique_ptr<PesPacket> pes_packet) {
 base::Optional<uint64_t> TsWriter::GetFilePosition() {
   if (!current_file_)
     return base::nullopt;
-  uint64_t position;
-  return current_file_->Tell(&position) ? base::make_optional(position)
-                                        : base::nullopt;
+  // Nothing is written to the file until the segment is finalized.
+  return segment_buffer_.Size();
+}
+
+bool TsWriter::QueueStreamOutput(uint64_t pcr) {
+  // The TS packets of the previous PES packet are sent at the rate given by
+  // its PCR and |pcr|, so that the stream output is not bursty.
+  int64_t duration_us = 0;
+  if (has_last_pcr_ && pcr >= last_pcr_ && pcr - last_pcr_ <= kMaxPcrJump) {
+    duration_us = (pcr - last_pcr_) * base::Time::kMicrosecondsPerSecond /
+                  kPcrTimescale;
+  }
+  has_last_pcr_ = true;
+  last_pcr_ = pcr;
+  CopyToStreamOutputPending();
+  return QueueStreamOutputGroups(duration_us, false);
+}
+
+void TsWriter::CopyToStreamOutputPending() {
+  stream_output_pending_.insert(
+      stream_output_pending_.end(),
+      segment_buffer_.Buffer() + stream_output_position_,
+      segment_buffer_.Buffer() + segment_buffer_.Size());
+  stream_output_position_ = segment_buffer_.Size();
+}
+
+bool TsWriter::QueueStreamOutputGroups(int64_t duration_us, bool flush) {
+  const size_t size = stream_output_pending_.size();
+  const size_t bytes_to_queue =
+      flush ? size : size - size % kStreamOutputGroupSize;
+
+  base::AutoLock auto_lock(stream_output_lock_);
+  for (size_t offset = 0; offset < bytes_to_queue;
+       offset += kStreamOutputGroupSize) {
+    while (stream_output_queue_.size() >= kMaxQueuedStreamOutputGroups &&
+           !stream_output_failed_) {
+      stream_output_cv_.Wait();
+    }
+    if (stream_output_failed_)
+      return false;
+    const size_t group_size =
+        std::min(kStreamOutputGroupSize, bytes_to_queue - offset);
+    stream_output_queue_.push_back(
+        {std::vector<uint8_t>(stream_output_pending_.begin() + offset,
+                              stream_output_pending_.begin() + offset +
+                                  group_size),
+         stream_time_us_ + static_cast<int64_t>(duration_us * offset / size)});
+    stream_output_cv_.Signal();
+  }
+  stream_time_us_ += duration_us;
+  stream_output_pending_.erase(stream_output_pending_.begin(),
+                               stream_output_pending_.begin() + bytes_to_queue);
+  return !stream_output_failed_;
+}
+
+void TsWriter::SendStreamOutput() {
+  const base::TimeDelta max_drift =
+      base::TimeDelta::FromSeconds(kMaxPacingDriftInSeconds);
+  bool pacing_started = false;
+  int64_t pacing_start_stream_time_us = 0;
+  base::TimeTicks pacing_start_time;
+  // The groups sent with one write. Reused across writes.
+  std::vector<uint8_t> batch;
+  batch.reserve(kMaxStreamOutputBatchSize * kStreamOutputGroupSize);
+
+  base::AutoLock auto_lock(stream_output_lock_);
+  while (true) {
+    if (stream_output_queue_.empty()) {
+      if (stopping_stream_output_)
+        return;
+      stream_output_cv_.Wait();
+      continue;
+    }
+    const int64_t stream_time_us = stream_output_queue_.front().stream_time_us;
+    const base::TimeTicks now = base::TimeTicks::Now();
+    const base::TimeTicks send_time =
+        pacing_start_time + base::TimeDelta::FromMicroseconds(
+                                stream_time_us - pacing_start_stream_time_us);
+    if (!pacing_started || now - send_time > max_drift) {
+      // Start over on the first group, or if the input does not keep up.
+      pacing_started = true;
+      pacing_start_stream_time_us = stream_time_us;
+      pacing_start_time = now;
+    } else if (send_time > now) {
+      stream_output_cv_.TimedWait(send_time - now);
+      continue;
+    }
+
+    // Take all the groups which are due. A short group, which is only queued
+    // on flush, ends the batch so the datagrams stay aligned on the groups.
+    batch.clear();
+    size_t num_groups = 0;
+    while (!stream_output_queue_.empty() &&
+           num_groups < kMaxStreamOutputBatchSize &&
+           batch.size() % kStreamOutputGroupSize == 0) {
+      const StreamOutputGroup& group = stream_output_queue_.front();
+      if (num_groups > 0 &&
+          pacing_start_time +
+                  base::TimeDelta::FromMicroseconds(
+                      group.stream_time_us - pacing_start_stream_time_us) >
+              now) {
+        break;
+      }
+      batch.insert(batch.end(), group.data.begin(), group.data.end());
+      stream_output_queue_.pop_front();
+      ++num_groups;
+    }
+    // Lets the muxer queue more groups if it was waiting.
+    stream_output_cv_.Signal();
+    bool sent = true;
+    {
+      base::AutoUnlock auto_unlock(stream_output_lock_);
+      sent = stream_output_->Write(batch.data(), batch.size()) >= 0;
+    }
+    if (!sent) {
+      LOG(ERROR) << "Failed to send TS packets to "
+                 << stream_output_->file_name();
+      stream_output_failed_ = true;
+      stream_output_queue_.clear();
+      stream_output_cv_.Signal();
+      return;
+    }
+  }
 }
 
 }  // namespace mp2t
@@ -7,14 +7,19 @@
 #ifndef PACKAGER_MEDIA_FORMATS_MP2T_TS_WRITER_H_
 #define PACKAGER_MEDIA_FORMATS_MP2T_TS_WRITER_H_
 
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
 #include <vector>
 
 #include "packager/base/optional.h"
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
 #include "packager/file/file.h"
 #include "packager/file/file_closer.h"
+#include "packager/media/base/buffer_writer.h"
+#include "packager/media/base/closure_thread.h"
 #include "packager/media/formats/mp2t/continuity_counter.h"
 
 namespace shaka {
@@ -26,6 +31,9 @@ class ProgramMapTableWriter;
 
 /// This class takes PesPackets, encapsulates them into TS packets, and write
 /// the data to file. This also creates PSI from StreamInfo.
+/// The TS packets of a segment are buffered in memory and written to the file
+/// at once when the segment is finalized. They can also be sent to a stream
+/// output, e.g. a UDP destination, as they are added.
 class TsWriter {
  public:
   explicit TsWriter(std::unique_ptr<ProgramMapTableWriter> pmt_writer);
@@ -37,11 +45,18 @@ class TsWriter {
   /// @return true on success, false otherwise.
   virtual bool NewSegment(const std::string& file_name);
 
+  /// Sends the TS packets to @a file_name too, as they are added, in groups of
+  /// seven TS packets, i.e. one datagram for a UDP destination. The groups are
+  /// sent by a separate thread, paced in real time at the rate given by the
+  /// PCRs of the PES packets. This must be called before the first segment.
+  /// @param file_name is the stream output file name, e.g. udp://ip:port.
+  /// @return true on success, false otherwise.
+  virtual bool OpenStreamOutput(const std::string& file_name);
+
   /// Signals the writer that the rest of the segments are encrypted.
   virtual void SignalEncrypted();
 
-  /// Flush all the pending PesPackets that have not been written to file and
-  /// close the file.
+  /// Write the buffered TS packets of the segment to file and close the file.
   /// @return true on success, false otherwise.
   virtual bool FinalizeSegment();
 
@@ -51,13 +66,35 @@ class TsWriter {
   /// @return true on success, false otherwise.
   virtual bool AddPesPacket(std::unique_ptr<PesPacket> pes_packet);
 
-  /// @return current file position on success, nullopt otherwise.
+  /// @return the position in the segment file of the next TS packet, i.e. the
+  ///         number of bytes in the segment so far, if a segment is open;
+  ///         nullopt otherwise.
   base::Optional<uint64_t> GetFilePosition();
 
  private:
   TsWriter(const TsWriter&) = delete;
   TsWriter& operator=(const TsWriter&) = delete;
 
+  // A group of TS packets to send to the stream output, with its time in the
+  // stream, which starts at 0, in microseconds.
+  struct StreamOutputGroup {
+    std::vector<uint8_t> data;
+    int64_t stream_time_us;
+  };
+
+  // Queues the TS packets added since the previous PES packet to be sent to
+  // the stream output, spread over the time from the PCR of that PES packet to
+  // |pcr|.
+  bool QueueStreamOutput(uint64_t pcr);
+  // Moves the TS packets of |segment_buffer_| not queued yet to
+  // |stream_output_pending_|.
+  void CopyToStreamOutputPending();
+  // Queues the complete groups of |stream_output_pending_|, or all of them if
+  // |flush| is true, spread over |duration_us| from |stream_time_us_|.
+  bool QueueStreamOutputGroups(int64_t duration_us, bool flush);
+  // The main loop of |stream_output_thread_|.
+  void SendStreamOutput();
+
   // True if further segments generated by this instance should be encrypted.
   bool encrypted_ = false;
 
@@ -67,6 +104,33 @@ class TsWriter {
   std::unique_ptr<ProgramMapTableWriter> pmt_writer_;
 
   std::unique_ptr<File, FileCloser> current_file_;
+  // TS packets of the current segment. Reused across segments.
+  BufferWriter segment_buffer_;
+
+  std::unique_ptr<File, FileCloser> stream_output_;
+  // Position in |segment_buffer_| of the TS packets not copied to
+  // |stream_output_pending_| yet.
+  size_t stream_output_position_ = 0;
+  // TS packets added since the previous PES packet, and the TS packets before
+  // them which did not make a complete group.
+  std::vector<uint8_t> stream_output_pending_;
+  // The PCR of the previous PES packet and its time in the stream.
+  bool has_last_pcr_ = false;
+  uint64_t last_pcr_ = 0;
+  int64_t stream_time_us_ = 0;
+
+  // Sends the queued groups, so that the muxer thread does not wait for them.
+  // Not created if there is no stream output.
+  std::unique_ptr<ClosureThread> stream_output_thread_;
+  base::Lock stream_output_lock_;
+  // Protected by |stream_output_lock_|. Signaled when a group is queued or
+  // sent, or when |stream_output_thread_| is stopping.
+  base::ConditionVariable stream_output_cv_;
+  std::deque<StreamOutputGroup> stream_output_queue_;
+  bool stopping_stream_output_ = false;
+  // Protected by |stream_output_lock_|. Set if |stream_output_thread_| failed
+  // to send a group, which is reported by the next PES packet.
+  bool stream_output_failed_ = false;
 };
 
 }  // namespace mp2t
@@ -9,6 +9,9 @@
 
 #include "packager/base/files/file_path.h"
 #include "packager/base/files/file_util.h"
+#include "packager/base/time/time.h"
+#include "packager/file/file.h"
+#include "packager/file/memory_file.h"
 #include "packager/media/base/audio_stream_info.h"
 #include "packager/media/base/buffer_writer.h"
 #include "packager/media/base/video_stream_info.h"
@@ -27,6 +30,8 @@ namespace mp2t {
 namespace {
 
 const int kTsPacketSize = 188;
+// The TS packets are sent to the stream output in groups of seven.
+const size_t kStreamOutputGroupSize = 7 * kTsPacketSize;
 const Codec kCodecForTesting = kCodecH264;
 
 class MockProgramMapTableWriter : public ProgramMapTableWriter {
@@ -387,6 +392,167 @@ TEST_F(TsWriterTest, AddPesPacket) {
       content.data() + kPesStartPosition));
 }
 
+// The segment is written to file when it is finalized. The file position is
+// tracked while the TS packets are buffered.
+TEST_F(TsWriterTest, SegmentWrittenOnFinalize) {
+  TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
+      new VideoProgramMapTableWriter(kCodecForTesting)));
+  const uint8_t kAnyData[] = {
+      0x12, 0x88, 0x4f, 0x4a,
+  };
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(ts_writer.NewSegment(test_file_name_));
+    // PAT and PMT.
+    EXPECT_EQ(376u, ts_writer.GetFilePosition().value());
+
+    std::unique_ptr<PesPacket> pes(new PesPacket());
+    pes->set_stream_id(0xE0);
+    pes->set_pts(0x900);
+    pes->mutable_data()->assign(kAnyData, kAnyData + arraysize(kAnyData));
+    EXPECT_TRUE(ts_writer.AddPesPacket(std::move(pes)));
+    EXPECT_EQ(564u, ts_writer.GetFilePosition().value());
+
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(ReadFileToVector(test_file_path_, &content));
+    EXPECT_TRUE(content.empty());
+
+    ASSERT_TRUE(ts_writer.FinalizeSegment());
+    EXPECT_FALSE(ts_writer.GetFilePosition());
+    ASSERT_TRUE(ReadFileToVector(test_file_path_, &content));
+    EXPECT_EQ(564u, content.size());
+  }
+}
+
+// Verify that the TS packets sent to the stream output are the same as the
+// segments.
+TEST_F(TsWriterTest, StreamOutput) {
+  const char kStreamOutputName[] = "memory://ts_writer_stream_output";
+  const uint8_t kAnyData[] = {
+      0x12, 0x88, 0x4f, 0x4a,
+  };
+
+  std::vector<uint8_t> segments;
+  std::string stream_output;
+  {
+    TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
+        new VideoProgramMapTableWriter(kCodecForTesting)));
+    ASSERT_TRUE(ts_writer.OpenStreamOutput(kStreamOutputName));
+
+    uint64_t pts = 0x900;
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_TRUE(ts_writer.NewSegment(test_file_name_));
+      // PAT and PMT, then one TS packet per PES packet, 1ms apart.
+      for (int j = 0; j < 6; ++j) {
+        std::unique_ptr<PesPacket> pes(new PesPacket());
+        pes->set_stream_id(0xE0);
+        pes->set_pts(pts);
+        pts += 90;
+        pes->mutable_data()->assign(kAnyData, kAnyData + arraysize(kAnyData));
+        EXPECT_TRUE(ts_writer.AddPesPacket(std::move(pes)));
+      }
+      ASSERT_TRUE(ts_writer.FinalizeSegment());
+
+      std::vector<uint8_t> content;
+      ASSERT_TRUE(ReadFileToVector(test_file_path_, &content));
+      EXPECT_EQ(8u * kTsPacketSize, content.size());
+      segments.insert(segments.end(), content.begin(), content.end());
+    }
+  }
+  // The last TS packets, which do not make a complete group, are sent when the
+  // writer is destroyed.
+  EXPECT_NE(0u, segments.size() % kStreamOutputGroupSize);
+  ASSERT_TRUE(File::ReadFileToString(kStreamOutputName, &stream_output));
+  EXPECT_EQ(std::string(segments.begin(), segments.end()), stream_output);
+  MemoryFile::Delete(kStreamOutputName);
+}
+
+// Verify that the stream output is paced in real time by its own thread, so
+// that adding the PES packets does not wait.
+TEST_F(TsWriterTest, StreamOutputIsPaced) {
+  const char kStreamOutputName[] = "memory://ts_writer_paced_stream_output";
+  const int kNumPesPackets = 5;
+  // 100ms apart, so the stream output takes 400ms.
+  const uint64_t kPesPacketDuration = 9000;
+  const base::TimeDelta kStreamDuration =
+      base::TimeDelta::FromMilliseconds(400);
+  // About two groups of TS packets per PES packet.
+  const std::vector<uint8_t> kAnyData(2 * kStreamOutputGroupSize, 0x12);
+
+  const base::TimeTicks start_time = base::TimeTicks::Now();
+  {
+    TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
+        new VideoProgramMapTableWriter(kCodecForTesting)));
+    ASSERT_TRUE(ts_writer.OpenStreamOutput(kStreamOutputName));
+    EXPECT_TRUE(ts_writer.NewSegment(test_file_name_));
+    for (int i = 0; i < kNumPesPackets; ++i) {
+      std::unique_ptr<PesPacket> pes(new PesPacket());
+      pes->set_stream_id(0xE0);
+      pes->set_pts(0x900 + i * kPesPacketDuration);
+      *pes->mutable_data() = kAnyData;
+      EXPECT_TRUE(ts_writer.AddPesPacket(std::move(pes)));
+    }
+    EXPECT_LT(base::TimeTicks::Now() - start_time, kStreamDuration / 2);
+    ASSERT_TRUE(ts_writer.FinalizeSegment());
+  }
+  // The groups of the first PES packet are sent right away, and the groups of
+  // the last PES packet when its PCR is reached.
+  EXPECT_GE(base::TimeTicks::Now() - start_time, kStreamDuration * 9 / 10);
+
+  std::vector<uint8_t> content;
+  ASSERT_TRUE(ReadFileToVector(test_file_path_, &content));
+  std::string stream_output;
+  ASSERT_TRUE(File::ReadFileToString(kStreamOutputName, &stream_output));
+  EXPECT_EQ(std::string(content.begin(), content.end()), stream_output);
+  MemoryFile::Delete(kStreamOutputName);
+}
+
+// Verify that the groups which are due are sent with one write, so that a UDP
+// stream output sends them with one system call.
+TEST_F(TsWriterTest, StreamOutputBatchesDueGroups) {
+  const size_t kNumGroups = 20;
+  const std::vector<uint8_t> kAnyData(kNumGroups * kStreamOutputGroupSize,
+                                      0x12);
+
+  std::vector<uint64_t> write_sizes;
+  BufferCallbackParams callback_params;
+  callback_params.write_func = [&write_sizes](const std::string& name,
+                                              const void* buffer,
+                                              uint64_t size) {
+    write_sizes.push_back(size);
+    return static_cast<int64_t>(size);
+  };
+  {
+    TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
+        new VideoProgramMapTableWriter(kCodecForTesting)));
+    ASSERT_TRUE(ts_writer.OpenStreamOutput(
+        File::MakeCallbackFileName(callback_params, "stream_output")));
+    EXPECT_TRUE(ts_writer.NewSegment(test_file_name_));
+    // The second PES packet has the same PCR, so all the groups of the first
+    // one are due at once.
+    for (int i = 0; i < 2; ++i) {
+      std::unique_ptr<PesPacket> pes(new PesPacket());
+      pes->set_stream_id(0xE0);
+      pes->set_pts(0x900);
+      *pes->mutable_data() = kAnyData;
+      EXPECT_TRUE(ts_writer.AddPesPacket(std::move(pes)));
+    }
+    ASSERT_TRUE(ts_writer.FinalizeSegment());
+  }
+
+  std::vector<uint8_t> content;
+  ASSERT_TRUE(ReadFileToVector(test_file_path_, &content));
+  uint64_t total_size = 0;
+  for (uint64_t write_size : write_sizes)
+    total_size += write_size;
+  EXPECT_EQ(content.size(), total_size);
+  ASSERT_FALSE(write_sizes.empty());
+  EXPECT_GE(write_sizes[0], kNumGroups * kStreamOutputGroupSize);
+  // Only the last write may end with a short group.
+  for (size_t i = 0; i + 1 < write_sizes.size(); ++i)
+    EXPECT_EQ(0u, write_sizes[i] % kStreamOutputGroupSize);
+}
+
 // Verify that PES packet > 64KiB can be handled.
 TEST_F(TsWriterTest, BigPesPacket) {
   TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
@@ -10,7 +10,7 @@
 #include <limits>
 
 #include "packager/media/base/audio_stream_info.h"
-#include "packager/media/base/buffer_writer.h"
+#include "packager/media/base/gather_list.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/formats/mp4/box_definitions.h"
 #include "packager/media/formats/mp4/key_frame_info.h"
@@ -94,7 +94,7 @@ Status Fragmenter::AddSample(const MediaSample& sample) {
         {static_cast<uint64_t>(pts), data_->Size(), sample.data_size()});
   }
 
-  data_->AppendArray(sample.data(), sample.data_size());
+  data_->AppendSharedData(sample.shared_data(), sample.data_size());
 
   traf_->runs[0].sample_composition_time_offsets.push_back(pts - dts);
   if (pts != dts)
@@ -151,7 +151,7 @@ Status Fragmenter::InitializeFragment(int64_t first_sample_dts) {
   fragment_duration_ = 0;
   earliest_presentation_time_ = kInvalidTime;
   first_sap_time_ = kInvalidTime;
-  data_.reset(new BufferWriter());
+  data_.reset(new GatherList());
   key_frame_infos_.clear();
   return Status::OK;
 }
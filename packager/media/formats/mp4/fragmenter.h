@@ -16,7 +16,7 @@
 namespace shaka {
 namespace media {
 
-class BufferWriter;
+class GatherList;
 class MediaSample;
 class StreamInfo;
 
@@ -66,7 +66,7 @@ class Fragmenter {
   }
   bool fragment_initialized() const { return fragment_initialized_; }
   bool fragment_finalized() const { return fragment_finalized_; }
-  BufferWriter* data() { return data_.get(); }
+  GatherList* data() { return data_.get(); }
   const std::vector<KeyFrameInfo>& key_frame_infos() const {
     return key_frame_infos_;
   }
@@ -94,7 +94,9 @@ class Fragmenter {
   int64_t fragment_duration_ = 0;
   int64_t earliest_presentation_time_ = 0;
   int64_t first_sap_time_ = 0;
-  std::unique_ptr<BufferWriter> data_;
+  // The sample data of the fragment, which is shared with the samples rather
+  // than copied.
+  std::unique_ptr<GatherList> data_;
   // Saves key frames information, for Video.
   std::vector<KeyFrameInfo> key_frame_infos_;
 
@@ -4,6 +4,8 @@
 
 #include "packager/media/formats/mp4/mp4_media_parser.h"
 
+#include <gflags/gflags.h>
+
 #include <algorithm>
 #include <limits>
 
@@ -20,6 +22,7 @@
 #include "packager/media/base/macros.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/base/rcheck.h"
+#include "packager/media/base/sample_buffer_pool.h"
 #include "packager/media/base/video_stream_info.h"
 #include "packager/media/codecs/ac3_audio_util.h"
 #include "packager/media/codecs/av1_codec_configuration_record.h"
@@ -32,11 +35,57 @@
 #include "packager/media/formats/mp4/box_reader.h"
 #include "packager/media/formats/mp4/track_run_iterator.h"
 
+DEFINE_bool(mp4_random_access,
+            false,
+            "MP4 only. Also read the samples of non-fragmented seekable "
+            "inputs that are not memory mapped with positioned reads, "
+            "interleaved by time, instead of in file order. It bounds the "
+            "memory usage by the largest chunk instead of by the "
+            "interleaving distance of the tracks, at the cost of copying "
+            "each chunk. Memory mapped inputs are always read this way, "
+            "directly from the mapping.");
+
 namespace shaka {
 namespace media {
 namespace mp4 {
 namespace {
 
+// Reads |size| bytes at |offset| of |file| and points |data| to them. The
+// bytes are read in place if |file| supports it, otherwise they are copied
+// to |buffer|.
+bool ReadAt(File* file,
+            int64_t offset,
+            int64_t size,
+            std::vector<uint8_t>* buffer,
+            const uint8_t** data) {
+  if (!file->Seek(offset)) {
+    LOG(ERROR) << "Cannot seek to " << offset << " in " << file->file_name();
+    return false;
+  }
+  if (file->SupportsReadInPlace()) {
+    if (file->ReadInPlace(data, size) != size) {
+      LOG(ERROR) << "Cannot read " << size << " bytes at " << offset << " in "
+                 << file->file_name();
+      return false;
+    }
+    return true;
+  }
+  buffer->resize(size);
+  *data = buffer->data();
+  int64_t bytes_read = 0;
+  while (bytes_read < size) {
+    const int64_t result =
+        file->Read(buffer->data() + bytes_read, size - bytes_read);
+    if (result <= 0) {
+      LOG(ERROR) << "Cannot read " << size << " bytes at " << offset << " in "
+                 << file->file_name();
+      return false;
+    }
+    bytes_read += result;
+  }
+  return true;
+}
+
 uint64_t Rescale(uint64_t time_in_old_scale,
                  uint32_t old_scale,
                  uint32_t new_scale) {
@@ -146,6 +195,7 @@ void MP4MediaParser::Init(const InitCB& init_cb,
 void MP4MediaParser::Reset() {
   queue_.Reset();
   runs_.reset();
+  input_file_.reset();
   moof_head_ = 0;
   mdat_tail_ = 0;
 }
@@ -164,7 +214,20 @@ bool MP4MediaParser::Parse(const uint8_t* buf, int size) {
     return false;
 
   queue_.Push(buf, size);
+  return ParseQueue();
+}
+
+bool MP4MediaParser::ParseInPlace(const uint8_t* buf, int size) {
+  DCHECK_NE(state_, kWaitingForInit);
+
+  if (state_ == kError)
+    return false;
 
+  queue_.PushInPlace(buf, size);
+  return ParseQueue();
+}
+
+bool MP4MediaParser::ParseQueue() {
   bool result, err = false;
 
   do {
@@ -191,6 +254,49 @@ bool MP4MediaParser::Parse(const uint8_t* buf, int size) {
   return true;
 }
 
+bool MP4MediaParser::ReadsInputDirectly() const {
+  return input_file_ != nullptr;
+}
+
+bool MP4MediaParser::ParseDirectly(bool* eos) {
+  DCHECK(input_file_);
+  DCHECK_EQ(state_, kEmittingSamples);
+  *eos = false;
+  // The data passed to Parse() before is not needed anymore.
+  queue_.Reset();
+
+  while (runs_->IsRunValid() &&
+         (!runs_->IsSampleValid() ||
+          disabled_track_ids_.count(runs_->track_id()) > 0)) {
+    runs_->AdvanceRun();
+  }
+  if (!runs_->IsRunValid()) {
+    *eos = true;
+    return true;
+  }
+
+  // Parse a run at a time, so the memory usage is bounded by the largest run.
+  bool err = !ReadRunData();
+  const int64_t run_offset = runs_->data_offset();
+  while (!err && runs_->IsSampleValid()) {
+    err = !EmitSample(run_data_ + runs_->sample_offset() - run_offset);
+    runs_->AdvanceSample();
+  }
+  if (err) {
+    DLOG(ERROR) << "Error while parsing MP4";
+    moov_.reset();
+    Reset();
+    ChangeState(kError);
+    return false;
+  }
+  runs_->AdvanceRun();
+  return true;
+}
+
+void MP4MediaParser::DisableTrack(uint32_t track_id) {
+  disabled_track_ids_.insert(track_id);
+}
+
 bool MP4MediaParser::LoadMoov(const std::string& file_path) {
   std::unique_ptr<File, FileCloser> file(
       File::OpenWithNoBuffering(file_path.c_str(), "r"));
@@ -203,6 +309,7 @@ bool MP4MediaParser::LoadMoov(const std::string& file_path) {
                << "'";
     return false;
   }
+  seekable_file_path_ = file_path;
 
   uint64_t file_position(0);
   bool mdat_seen(false);
@@ -640,6 +747,23 @@ bool MP4MediaParser::ParseMoov(BoxReader* reader) {
     return false;
   runs_.reset(new TrackRunIterator(moov_.get()));
   RCHECK(runs_->Init());
+  // The samples of non-fragmented seekable files are read directly from the
+  // file, in place if it is memory mapped. Fragmented files have no samples
+  // in 'moov'.
+  if (moov_->extends.tracks.empty() && !seekable_file_path_.empty()) {
+    input_file_.reset(
+        File::OpenWithNoBuffering(seekable_file_path_.c_str(), "r"));
+    if (!input_file_) {
+      LOG(WARNING) << "Unable to open '" << seekable_file_path_
+                   << "' for random access, reading it sequentially.";
+    } else if (!(input_file_->SupportsReadInPlace() &&
+                 input_file_->ReadInPlaceDataStaysValid()) &&
+               !FLAGS_mp4_random_access) {
+      input_file_.reset();
+    } else {
+      runs_->OrderRunsByTime();
+    }
+  }
   ChangeState(kEmittingSamples);
   return true;
 }
@@ -682,6 +806,10 @@ bool MP4MediaParser::FetchKeysIfNecessary(
 }
 
 bool MP4MediaParser::EnqueueSample(bool* err) {
+  // The samples are read by ParseDirectly() instead.
+  if (input_file_)
+    return false;
+
   if (!runs_->IsRunValid()) {
     // Remain in kEnqueueingSamples state, discarding data, until the end of
     // the current 'mdat' box has been appended to the queue.
@@ -735,7 +863,15 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
     return false;
   }
 
-  const uint8_t* media_data = buf;
+  if (!EmitSample(buf)) {
+    *err = true;
+    return false;
+  }
+  runs_->AdvanceSample();
+  return true;
+}
+
+bool MP4MediaParser::EmitSample(const uint8_t* media_data) {
   const size_t media_data_size = runs_->sample_size();
   // Use a dummy data size of 0 to avoid copying overhead.
   // Actual media data is set later.
@@ -744,11 +880,8 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       MediaSample::CopyFrom(media_data, kDummyDataSize, runs_->is_keyframe()));
 
   if (runs_->is_encrypted()) {
-    std::shared_ptr<uint8_t> decrypted_media_data(
-        new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
     std::unique_ptr<DecryptConfig> decrypt_config = runs_->GetDecryptConfig();
     if (!decrypt_config) {
-      *err = true;
       LOG(ERROR) << "Missing decrypt config.";
       return false;
     }
@@ -760,10 +893,11 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       stream_sample->set_decrypt_config(std::move(decrypt_config));
       stream_sample->set_is_encrypted(true);
     } else {
+      std::shared_ptr<uint8_t> decrypted_media_data =
+          SampleBufferPool::GetInstance()->Allocate(media_data_size);
       if (!decryptor_source_->DecryptSampleBuffer(decrypt_config.get(),
                                                   media_data, media_data_size,
                                                   decrypted_media_data.get())) {
-        *err = true;
         LOG(ERROR) << "Cannot decrypt samples.";
         return false;
       }
@@ -786,15 +920,24 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
            << ", size=" << runs_->sample_size();
 
   if (!new_sample_cb_.Run(runs_->track_id(), stream_sample)) {
-    *err = true;
     LOG(ERROR) << "Failed to process the sample.";
     return false;
   }
 
-  runs_->AdvanceSample();
   return true;
 }
 
+bool MP4MediaParser::ReadRunData() {
+  if (runs_->AuxInfoNeedsToBeCached()) {
+    const uint8_t* aux_info = nullptr;
+    RCHECK(ReadAt(input_file_.get(), runs_->aux_info_offset(),
+                  runs_->aux_info_size(), &run_buffer_, &aux_info));
+    RCHECK(runs_->CacheAuxInfo(aux_info, runs_->aux_info_size()));
+  }
+  return ReadAt(input_file_.get(), runs_->data_offset(), runs_->data_size(),
+                &run_buffer_, &run_data_);
+}
+
 bool MP4MediaParser::ReadAndDiscardMDATsUntil(const int64_t offset) {
   bool err = false;
   while (mdat_tail_ < offset) {
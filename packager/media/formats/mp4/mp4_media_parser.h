@@ -11,9 +11,12 @@
 
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "packager/base/callback_forward.h"
+#include "packager/file/file_closer.h"
 #include "packager/media/base/decryptor_source.h"
 #include "packager/media/base/media_parser.h"
 #include "packager/media/base/offset_byte_queue.h"
@@ -39,12 +42,21 @@ class MP4MediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   bool Flush() override WARN_UNUSED_RESULT;
   bool Parse(const uint8_t* buf, int size) override WARN_UNUSED_RESULT;
+  bool ParseInPlace(const uint8_t* buf, int size) override WARN_UNUSED_RESULT;
+  bool ReadsInputDirectly() const override;
+  bool ParseDirectly(bool* eos) override WARN_UNUSED_RESULT;
+  void DisableTrack(uint32_t track_id) override;
   /// @}
 
   /// Handles ISO-BMFF containers which have the 'moov' box trailing the
   /// movie data ('mdat'). It does this by doing a sparse parse of the file
   /// to locate the 'moov' box, and parsing its contents if it is found to be
   /// located after the 'mdat' box(es).
+  /// The samples of non-fragmented files are then read directly from the file
+  /// with positioned reads, in time order, if @a file_path is memory mapped,
+  /// i.e. starts with "mmap://", or if --mp4_random_access is enabled. Memory
+  /// usage is then bounded by the largest run of samples instead of by the
+  /// distance between the interleaved tracks.
   /// @param file_path is the path to the media file to be parsed.
   /// @return true if successful, false otherwise.
   bool LoadMoov(const std::string& file_path);
@@ -57,6 +69,8 @@ class MP4MediaParser : public MediaParser {
     kError
   };
 
+  // Parses the data in |queue_| as far as possible.
+  bool ParseQueue();
   bool ParseBox(bool* err);
   bool ParseMoov(mp4::BoxReader* reader);
   bool ParseMoof(mp4::BoxReader* reader);
@@ -77,6 +91,12 @@ class MP4MediaParser : public MediaParser {
   bool EmitConfigs();
 
   bool EnqueueSample(bool* err);
+  // Creates a media sample with |media_data| for the current sample of
+  // |runs_| and passes it to |new_sample_cb_|.
+  bool EmitSample(const uint8_t* media_data);
+  // Reads the data of the current run from |input_file_|, after caching its
+  // auxiliary information if needed.
+  bool ReadRunData();
 
   void Reset();
 
@@ -101,6 +121,19 @@ class MP4MediaParser : public MediaParser {
   std::unique_ptr<Movie> moov_;
   std::unique_ptr<TrackRunIterator> runs_;
 
+  // Path of the media file, set by LoadMoov() if the file is seekable.
+  std::string seekable_file_path_;
+  // The media file, if the samples are read directly from it.
+  std::unique_ptr<File, FileCloser> input_file_;
+  // Data of the current run, if the samples are read directly. It points to
+  // the mapped bytes if |input_file_| supports ReadInPlace, otherwise to
+  // |run_buffer_|.
+  const uint8_t* run_data_ = nullptr;
+  std::vector<uint8_t> run_buffer_;
+  // Tracks whose samples are not needed. Their runs are skipped when reading
+  // the samples directly.
+  std::set<uint32_t> disabled_track_ids_;
+
   DISALLOW_COPY_AND_ASSIGN(MP4MediaParser);
 };
 
@@ -4,11 +4,15 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <gflags/gflags.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <limits>
+
 #include "packager/base/bind.h"
 #include "packager/base/logging.h"
+#include "packager/file/file.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/base/raw_key_source.h"
 #include "packager/media/base/stream_info.h"
@@ -16,6 +20,8 @@
 #include "packager/media/formats/mp4/mp4_media_parser.h"
 #include "packager/media/test/test_data_util.h"
 
+DECLARE_bool(mp4_random_access);
+
 using ::testing::_;
 using ::testing::DoAll;
 using ::testing::Return;
@@ -53,6 +59,11 @@ class MP4MediaParserTest : public testing::Test {
   std::unique_ptr<MP4MediaParser> parser_;
   size_t num_streams_;
   size_t num_samples_;
+  // Track and start time in seconds of the last run of samples.
+  uint32_t last_track_id_ = 0;
+  // The first samples may have negative timestamps.
+  double last_run_start_time_ = -std::numeric_limits<double>::infinity();
+  bool samples_in_time_order_ = true;
 
   bool AppendData(const uint8_t* data, size_t length) {
     return parser_->Parse(data, static_cast<int>(length));
@@ -87,6 +98,14 @@ class MP4MediaParserTest : public testing::Test {
     DVLOG(2) << "Track Id: " << track_id << " "
              << sample->ToString();
     ++num_samples_;
+    if (track_id != last_track_id_) {
+      const double time = static_cast<double>(sample->dts()) /
+                          stream_map_[track_id]->time_scale();
+      if (time < last_run_start_time_)
+        samples_in_time_order_ = false;
+      last_track_id_ = track_id;
+      last_run_start_time_ = time;
+    }
     return true;
   }
 
@@ -98,11 +117,29 @@ class MP4MediaParserTest : public testing::Test {
   }
 
   bool ParseMP4File(const std::string& filename, int append_bytes) {
+    return ParseMP4FileWithPrefix("", filename, append_bytes);
+  }
+
+  // Like ParseMP4File, with |file_prefix| prepended to the path passed to
+  // LoadMoov, e.g. to memory map the file.
+  bool ParseMP4FileWithPrefix(const std::string& file_prefix,
+                              const std::string& filename,
+                              int append_bytes) {
     InitializeParser(NULL);
-    if (!parser_->LoadMoov(GetTestDataFilePath(filename).AsUTF8Unsafe()))
+    if (!parser_->LoadMoov(file_prefix +
+                           GetTestDataFilePath(filename).AsUTF8Unsafe())) {
       return false;
+    }
     std::vector<uint8_t> buffer = ReadTestDataFile(filename);
-    return AppendDataInPieces(buffer.data(), buffer.size(), append_bytes);
+    if (!AppendDataInPieces(buffer.data(), buffer.size(), append_bytes))
+      return false;
+    // Read the samples directly from the file, like the Demuxer does.
+    bool eos = false;
+    while (parser_->ReadsInputDirectly() && !eos) {
+      if (!parser_->ParseDirectly(&eos))
+        return false;
+    }
+    return true;
   }
 };
 
@@ -231,9 +268,38 @@ TEST_F(MP4MediaParserTest, NoMoovAfterFlush) {
 }
 
 TEST_F(MP4MediaParserTest, NON_FRAGMENTED_MP4) {
+  FLAGS_mp4_random_access = true;
+  EXPECT_TRUE(ParseMP4File("bear-640x360.mp4", 512));
+  FLAGS_mp4_random_access = false;
+  EXPECT_EQ(2u, num_streams_);
+  EXPECT_EQ(201u, num_samples_);
+  EXPECT_TRUE(parser_->ReadsInputDirectly());
+  EXPECT_TRUE(samples_in_time_order_);
+}
+
+#if !defined(OS_WIN)
+// Mapped files are read in place, without --mp4_random_access.
+TEST_F(MP4MediaParserTest, NON_FRAGMENTED_MP4_MappedRead) {
+  EXPECT_TRUE(
+      ParseMP4FileWithPrefix(kMappedFilePrefix, "bear-640x360.mp4", 512));
+  EXPECT_EQ(2u, num_streams_);
+  EXPECT_EQ(201u, num_samples_);
+  EXPECT_TRUE(parser_->ReadsInputDirectly());
+  EXPECT_TRUE(samples_in_time_order_);
+}
+#endif  // !defined(OS_WIN)
+
+TEST_F(MP4MediaParserTest, NON_FRAGMENTED_MP4_SequentialRead) {
   EXPECT_TRUE(ParseMP4File("bear-640x360.mp4", 512));
   EXPECT_EQ(2u, num_streams_);
   EXPECT_EQ(201u, num_samples_);
+  EXPECT_FALSE(parser_->ReadsInputDirectly());
+}
+
+TEST_F(MP4MediaParserTest, FragmentedMP4IsReadSequentially) {
+  EXPECT_TRUE(ParseMP4File("bear-640x360-av_frag.mp4", 512));
+  EXPECT_EQ(201u, num_samples_);
+  EXPECT_FALSE(parser_->ReadsInputDirectly());
 }
 
 TEST_F(MP4MediaParserTest, CencWithoutDecryptionSource) {
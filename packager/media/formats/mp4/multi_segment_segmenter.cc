@@ -13,6 +13,7 @@
 #include "packager/file/file.h"
 #include "packager/file/file_closer.h"
 #include "packager/media/base/buffer_writer.h"
+#include "packager/media/base/gather_list.h"
 #include "packager/media/base/muxer_options.h"
 #include "packager/media/base/muxer_util.h"
 #include "packager/media/event/muxer_listener.h"
@@ -128,7 +129,6 @@ Status MultiSegmentSegmenter::WriteSegment() {
   const size_t segment_size = segment_header_size + fragment_buffer()->Size();
   DCHECK_NE(segment_size, 0u);
 
-  RETURN_IF_ERROR(buffer->WriteToFile(file.get()));
   if (muxer_listener()) {
     for (const KeyFrameInfo& key_frame_info : key_frame_infos()) {
       muxer_listener()->OnKeyFrame(
@@ -137,7 +137,11 @@ Status MultiSegmentSegmenter::WriteSegment() {
           key_frame_info.size);
     }
   }
-  RETURN_IF_ERROR(fragment_buffer()->WriteToFile(file.get()));
+  // The segment header and the fragments are written at once.
+  GatherList segment;
+  segment.AppendBuffer(buffer.get());
+  segment.AppendList(fragment_buffer());
+  RETURN_IF_ERROR(segment.WriteToFile(file.get()));
 
   // Close the file, which also does flushing, to make sure the file is written
   // before manifest is updated.
@@ -10,6 +10,7 @@
 
 #include "packager/base/logging.h"
 #include "packager/media/base/buffer_writer.h"
+#include "packager/media/base/gather_list.h"
 #include "packager/media/base/id3_tag.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/base/muxer_options.h"
@@ -43,7 +44,7 @@ Segmenter::Segmenter(const MuxerOptions& options,
       ftyp_(std::move(ftyp)),
       moov_(std::move(moov)),
       moof_(new MovieFragment()),
-      fragment_buffer_(new BufferWriter()),
+      fragment_buffer_(new GatherList()),
       sidx_(new SegmentIndex()) {}
 
 Segmenter::~Segmenter() {}
@@ -198,9 +199,12 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
 
   const uint64_t moof_start_offset = fragment_buffer_->Size();
 
-  // Write the fragment to buffer.
-  moof_->Write(fragment_buffer_.get());
-  mdat.WriteHeader(fragment_buffer_.get());
+  // Write the fragment to buffer. The sample data is referenced, not copied.
+  const size_t kFragmentHeaderReservedSize = 4096;
+  BufferWriter fragment_header(kFragmentHeaderReservedSize);
+  moof_->Write(&fragment_header);
+  mdat.WriteHeader(&fragment_header);
+  fragment_buffer_->AppendBuffer(&fragment_header);
 
   bool first_key_frame = true;
   for (const std::unique_ptr<Fragmenter>& fragmenter : fragmenters_) {
@@ -216,7 +220,7 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
           {key_frame_info.timestamp, moof_start_offset,
            fragment_buffer_->Size() - moof_start_offset + key_frame_info.size});
     }
-    fragment_buffer_->AppendBuffer(*fragmenter->data());
+    fragment_buffer_->AppendList(fragmenter->data());
   }
 
   // Increase sequence_number for next fragment.
@@ -11,6 +11,7 @@
 #include "packager/file/file.h"
 #include "packager/file/file_util.h"
 #include "packager/media/base/buffer_writer.h"
+#include "packager/media/base/gather_list.h"
 #include "packager/media/base/muxer_options.h"
 #include "packager/media/event/progress_listener.h"
 #include "packager/media/formats/mp4/box_definitions.h"
@@ -89,7 +90,7 @@ Status SingleSegmentSegmenter::DoFinalize() {
   DCHECK(moov());
   DCHECK(vod_sidx_);
 
-  // Close the temp file to prepare for reading later.
+  // Close the temp file to prepare for copying later.
   if (!temp_file_.release()->Close()) {
     return Status(
         error::FILE_FAILURE,
@@ -115,46 +116,24 @@ Status SingleSegmentSegmenter::DoFinalize() {
   Status status = buffer->WriteToFile(file.get());
   if (!status.ok())
     return status;
-
-  // Load the temp file and write to output file.
-  std::unique_ptr<File, FileCloser> temp_file(
-      File::Open(temp_file_name_.c_str(), "r"));
-  if (temp_file == NULL) {
-    return Status(error::FILE_FAILURE,
-                  "Cannot open file to read " + temp_file_name_);
-  }
-
-  // The target of 2nd stage of single segment segmentation.
-  const uint64_t re_segment_progress_target = progress_target() * 0.5;
-
-  const int kBufSize = 0x200000;  // 2MB.
-  std::unique_ptr<uint8_t[]> buf(new uint8_t[kBufSize]);
-  while (true) {
-    int64_t size = temp_file->Read(buf.get(), kBufSize);
-    if (size == 0) {
-      break;
-    } else if (size < 0) {
-      return Status(error::FILE_FAILURE,
-                    "Failed to read file " + temp_file_name_);
-    }
-    int64_t size_written = file->Write(buf.get(), size);
-    if (size_written != size) {
-      return Status(error::FILE_FAILURE,
-                    "Failed to write file " + options().output_file_name);
-    }
-    UpdateProgress(static_cast<double>(size) / temp_file->Size() *
-                   re_segment_progress_target);
-  }
-  if (!temp_file.release()->Close()) {
-    return Status(error::FILE_FAILURE, "Cannot close the temp file " +
-                                           temp_file_name_ + " after reading.");
-  }
   if (!file.release()->Close()) {
     return Status(
         error::FILE_FAILURE,
         "Cannot close file " + options().output_file_name +
             ", possibly file permission issue or running out of disk space.");
   }
+
+  // Append the subsegments in the temp file to the output file. This is done
+  // by the kernel if both are local files, without reading the temp file back
+  // into user space.
+  if (File::AppendFile(temp_file_name_.c_str(),
+                       options().output_file_name.c_str()) < 0) {
+    return Status(error::FILE_FAILURE,
+                  "Failed to copy the temp file " + temp_file_name_ + " to " +
+                      options().output_file_name);
+  }
+  // The target of 2nd stage of single segment segmentation.
+  UpdateProgress(progress_target() * 0.5);
   SetComplete();
   return Status::OK;
 }
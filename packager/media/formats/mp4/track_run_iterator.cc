@@ -440,6 +440,16 @@ void TrackRunIterator::AdvanceRun() {
   ResetRun();
 }
 
+void TrackRunIterator::OrderRunsByTime() {
+  std::stable_sort(runs_.begin(), runs_.end(),
+                   [](const TrackRunInfo& a, const TrackRunInfo& b) {
+                     return static_cast<double>(a.start_dts) / a.timescale <
+                            static_cast<double>(b.start_dts) / b.timescale;
+                   });
+  run_itr_ = runs_.begin();
+  ResetRun();
+}
+
 void TrackRunIterator::ResetRun() {
   if (!IsRunValid())
     return;
@@ -549,6 +559,19 @@ bool TrackRunIterator::is_video() const {
   return run_itr_->track_type == kVideo;
 }
 
+int64_t TrackRunIterator::data_offset() const {
+  DCHECK(IsRunValid());
+  return run_itr_->sample_start_offset;
+}
+
+int64_t TrackRunIterator::data_size() const {
+  DCHECK(IsRunValid());
+  int64_t size = 0;
+  for (const SampleInfo& sample : run_itr_->samples)
+    size += sample.size;
+  return size;
+}
+
 const AudioSampleEntry& TrackRunIterator::audio_description() const {
   DCHECK(is_audio());
   DCHECK(run_itr_->audio_description);
@@ -40,6 +40,12 @@ class TrackRunIterator {
   /// @return true on success, false otherwise.
   bool Init(const MovieFragment& moof);
 
+  /// Order the runs by start time instead of data offset, so the samples of
+  /// the different tracks are interleaved in time. The run data is then not
+  /// in stream order and needs to be read at random positions, i.e.
+  /// GetMaxClearOffset() is meaningless. Resets the iterator to the first run.
+  void OrderRunsByTime();
+
   /// @return true if the iterator points to a valid run, false if past the
   ///         last run.
   bool IsRunValid() const;
@@ -80,6 +86,11 @@ class TrackRunIterator {
   bool is_encrypted() const;
   bool is_audio() const;
   bool is_video() const;
+  /// Offset of the first sample of the run. The samples of a run are
+  /// contiguous.
+  int64_t data_offset() const;
+  /// Size of all the samples of the run.
+  int64_t data_size() const;
   /// @}
 
   /// Only valid if is_audio() is true.
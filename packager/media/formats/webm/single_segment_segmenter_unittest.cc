@@ -6,6 +6,8 @@
 
 #include <gtest/gtest.h>
 #include <memory>
+#include "packager/base/files/file_util.h"
+#include "packager/file/file.h"
 #include "packager/media/formats/webm/segmenter_test_base.h"
 
 namespace shaka {
@@ -194,6 +196,52 @@ TEST_F(SingleSegmentSegmenterTest, SplitsClustersOnSegment) {
   EXPECT_EQ(3u, parser.GetFrameCountForCluster(1));
 }
 
+TEST_F(SingleSegmentSegmenterTest, LocalFileWrittenInPlace) {
+  base::FilePath output_file_path;
+  ASSERT_TRUE(base::CreateTemporaryFile(&output_file_path));
+  MuxerOptions options = CreateMuxerOptions();
+  options.output_file_name = output_file_path.AsUTF8Unsafe();
+  ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(options));
+
+  // Write the samples to the Segmenter.
+  for (int i = 0; i < 8; i++) {
+    if (i == 5) {
+      ASSERT_OK(segmenter_->FinalizeSegment(0, 5 * kDuration, !kSubsegment));
+    }
+    std::shared_ptr<MediaSample> sample =
+        CreateSample(kKeyFrame, kDuration, kNoSideData);
+    ASSERT_OK(segmenter_->AddSample(*sample));
+  }
+  ASSERT_OK(
+      segmenter_->FinalizeSegment(5 * kDuration, 8 * kDuration, !kSubsegment));
+  ASSERT_OK(segmenter_->Finalize());
+
+  // The Cues are placed in the space reserved right after the header, which
+  // is followed by the Clusters.
+  uint64_t init_start = 0;
+  uint64_t init_end = 0;
+  ASSERT_TRUE(segmenter_->GetInitRangeStartAndEnd(&init_start, &init_end));
+  uint64_t index_start = 0;
+  uint64_t index_end = 0;
+  ASSERT_TRUE(segmenter_->GetIndexRangeStartAndEnd(&index_start, &index_end));
+  EXPECT_EQ(init_end + 1, index_start);
+  const std::vector<Range> ranges = segmenter_->GetSegmentRanges();
+  ASSERT_EQ(2u, ranges.size());
+  EXPECT_LT(index_end, ranges[0].start);
+  EXPECT_EQ(ranges[0].end + 1, ranges[1].start);
+  EXPECT_EQ(File::GetFileSize(options.output_file_name.c_str()),
+            static_cast<int64_t>(ranges[1].end + 1));
+
+  ClusterParser parser;
+  ASSERT_NO_FATAL_FAILURE(parser.PopulateFromSegment(options.output_file_name));
+  ASSERT_EQ(2u, parser.cluster_count());
+  EXPECT_EQ(5u, parser.GetFrameCountForCluster(0));
+  EXPECT_EQ(3u, parser.GetFrameCountForCluster(1));
+
+  segmenter_.reset();
+  base::DeleteFile(output_file_path, false);
+}
+
 TEST_F(SingleSegmentSegmenterTest, IgnoresSubsegment) {
   MuxerOptions options = CreateMuxerOptions();
   ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(options));
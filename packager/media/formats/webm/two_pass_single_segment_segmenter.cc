@@ -8,6 +8,7 @@
 
 #include <algorithm>
 
+#include "packager/file/file.h"
 #include "packager/file/file_util.h"
 #include "packager/media/base/media_sample.h"
 #include "packager/media/base/muxer_options.h"
@@ -15,11 +16,50 @@
 #include "packager/third_party/libwebm/src/mkvmuxer.hpp"
 #include "packager/third_party/libwebm/src/mkvmuxerutil.hpp"
 #include "packager/third_party/libwebm/src/webmids.hpp"
+#include "packager/status_macros.h"
 
 namespace shaka {
 namespace media {
 namespace webm {
 namespace {
+
+// Minimum size of a Void element: its ID and a one-byte size.
+const uint64_t kMinVoidSize = 2;
+// Estimated maximum size of a CuePoint and of the Cues header, used to reserve
+// space for the Cues before the clusters.
+const uint64_t kEstimatedCuePointSize = 32;
+const uint64_t kEstimatedCuesHeaderSize = 16;
+// Space reserved for the Cues if the duration is not known.
+const uint64_t kDefaultReservedCuesSize = 0x10000;  // 64KB.
+
+// Fills |size| bytes, which must not be less than kMinVoidSize, with Void
+// elements. libwebm writes nothing if a single Void element cannot be exactly
+// |size| bytes, e.g. for 128 bytes, which need a wider size field than the
+// payload does. Two smaller elements are written instead.
+bool WriteVoid(mkvmuxer::IMkvWriter* writer, uint64_t size) {
+  const int64_t position = writer->Position();
+  if (mkvmuxer::WriteVoidElement(writer, size) == size)
+    return true;
+  if (writer->Position() != position)
+    return false;
+  const uint64_t first_size = size / 2;
+  return size >= 2 * kMinVoidSize &&
+         mkvmuxer::WriteVoidElement(writer, first_size) == first_size &&
+         mkvmuxer::WriteVoidElement(writer, size - first_size) ==
+             size - first_size;
+}
+
+// Returns the number of bytes to reserve for the Cues for media of the given
+// duration, in WebM timecode (milliseconds), assuming that the clusters are
+// at least one second long.
+uint64_t EstimateCuesSize(uint64_t duration_in_ms) {
+  if (duration_in_ms == 0)
+    return kDefaultReservedCuesSize;
+  const uint64_t kMsPerSecond = 1000;
+  const uint64_t max_num_cue_points = duration_in_ms / kMsPerSecond + 1;
+  return kEstimatedCuesHeaderSize + max_num_cue_points * kEstimatedCuePointSize;
+}
+
 // Cues will be inserted before clusters. All clusters will be shifted down by
 // the size of cues. However, cluster positions affect the size of cues. This
 // function adjusts cues size iteratively until it is stable.
@@ -69,6 +109,22 @@ TwoPassSingleSegmentSegmenter::TwoPassSingleSegmentSegmenter(
 TwoPassSingleSegmentSegmenter::~TwoPassSingleSegmentSegmenter() {}
 
 Status TwoPassSingleSegmentSegmenter::DoInitialize() {
+  std::unique_ptr<MkvWriter> output(new MkvWriter);
+  RETURN_IF_ERROR(output->Open(options().output_file_name));
+  if (output->Seekable() &&
+      File::IsLocalRegularFile(options().output_file_name.c_str())) {
+    // Write the clusters to the output file directly, after space reserved for
+    // the Cues, so the output is written in a single pass.
+    set_writer(std::move(output));
+    RETURN_IF_ERROR(SingleSegmentSegmenter::DoInitialize());
+    reserved_cues_size_ = EstimateCuesSize(FromBmffTimestamp(duration()));
+    if (!WriteVoid(writer(), reserved_cues_size_))
+      return Status(error::FILE_FAILURE, "Error reserving space for Cues.");
+    seek_head()->set_cluster_pos(writer()->Position() - segment_payload_pos());
+    return Status::OK;
+  }
+  RETURN_IF_ERROR(output->Close());
+
   // Assume the amount of time to copy the temp file as the same amount
   // of time as to make it.
   set_progress_target(duration() * 2);
@@ -85,6 +141,9 @@ Status TwoPassSingleSegmentSegmenter::DoInitialize() {
 }
 
 Status TwoPassSingleSegmentSegmenter::DoFinalize() {
+  if (reserved_cues_size_ > 0)
+    return FinalizeInPlace();
+
   const uint64_t header_size = init_end() + 1;
   const uint64_t cues_pos = header_size - segment_payload_pos();
   const uint64_t cues_size = UpdateCues(cues());
@@ -137,6 +196,49 @@ Status TwoPassSingleSegmentSegmenter::DoFinalize() {
   return real_writer->Close();
 }
 
+Status TwoPassSingleSegmentSegmenter::FinalizeInPlace() {
+  // The cluster sizes have been patched in place when the clusters were
+  // finalized, as the output is seekable.
+  const uint64_t clusters_end = writer()->Position();
+  const uint64_t cues_start = init_end() + 1;
+  const uint64_t cues_size = cues()->Size();
+  // The rest of the reserved space, if any, needs to fit a Void element.
+  const bool cues_fit_in_reserved_space =
+      cues_size == reserved_cues_size_ ||
+      cues_size + kMinVoidSize <= reserved_cues_size_;
+  if (cues_fit_in_reserved_space) {
+    if (writer()->Position(cues_start) != 0)
+      return Status(error::FILE_FAILURE, "Error seeking to Cues.");
+  } else {
+    // The Cues are placed after the clusters instead, which is less efficient
+    // for players but still valid.
+    LOG(WARNING) << "Cues of " << cues_size << " bytes do not fit in the "
+                 << reserved_cues_size_ << " bytes reserved. Writing Cues "
+                 << "after the clusters.";
+  }
+
+  set_index_start(writer()->Position());
+  seek_head()->set_cues_pos(writer()->Position() - segment_payload_pos());
+  if (!cues()->Write(writer()))
+    return Status(error::FILE_FAILURE, "Error writing Cues data.");
+  set_index_end(writer()->Position() - 1);
+
+  uint64_t file_size = writer()->Position();
+  if (cues_fit_in_reserved_space) {
+    if (cues_size < reserved_cues_size_ &&
+        !WriteVoid(writer(), reserved_cues_size_ - cues_size)) {
+      return Status(error::FILE_FAILURE, "Error writing Void element.");
+    }
+    file_size = clusters_end;
+  }
+
+  if (writer()->Position(0) != 0)
+    return Status(error::FILE_FAILURE, "Error seeking to segment header.");
+  Status status = WriteSegmentHeader(file_size, writer());
+  status.Update(writer()->Close());
+  return status;
+}
+
 bool TwoPassSingleSegmentSegmenter::CopyFileWithClusterRewrite(
     File* source,
     MkvWriter* dest,
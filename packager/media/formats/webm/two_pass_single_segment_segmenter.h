@@ -21,8 +21,11 @@ struct MuxerOptions;
 
 namespace webm {
 
-/// An implementation of a Segmenter for a single-segment that performs two
-/// passes.  This does not use seeking and is used for non-seekable files.
+/// An implementation of a Segmenter for a single-segment with the Cues before
+/// the Clusters. If the output is a seekable local file, the Clusters are
+/// written to the output directly after space reserved for the Cues.
+/// Otherwise, it performs two passes, through a temporary file, which does not
+/// use seeking on the output.
 class TwoPassSingleSegmentSegmenter : public SingleSegmentSegmenter {
  public:
   explicit TwoPassSingleSegmentSegmenter(const MuxerOptions& options);
@@ -33,6 +36,10 @@ class TwoPassSingleSegmentSegmenter : public SingleSegmentSegmenter {
   Status DoFinalize() override;
 
  private:
+  // Writes the Cues to the reserved space, or after the Clusters if they do
+  // not fit, and updates the segment header.
+  Status FinalizeInPlace();
+
   /// Copies the data from source to destination while rewriting the Cluster
   /// sizes to the correct values.  This assumes that both @a source and
   /// @a dest are at the same position and that the headers have already
@@ -42,6 +49,9 @@ class TwoPassSingleSegmentSegmenter : public SingleSegmentSegmenter {
                                   uint64_t last_size);
 
   std::string temp_file_name_;
+  // Non-zero if the Clusters are written to the output file directly, in
+  // which case it is the number of bytes reserved for the Cues.
+  uint64_t reserved_cues_size_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(TwoPassSingleSegmentSegmenter);
 };
@@ -60,7 +60,20 @@ bool WebMMediaParser::Parse(const uint8_t* buf, int size) {
     return false;
 
   byte_queue_.Push(buf, size);
+  return ParseQueue();
+}
+
+bool WebMMediaParser::ParseInPlace(const uint8_t* buf, int size) {
+  DCHECK_NE(state_, kWaitingForInit);
+
+  if (state_ == kError)
+    return false;
+
+  byte_queue_.PushInPlace(buf, size);
+  return ParseQueue();
+}
 
+bool WebMMediaParser::ParseQueue() {
   int result = 0;
   int bytes_parsed = 0;
   const uint8_t* cur = NULL;
@@ -27,6 +27,7 @@ class WebMMediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   bool Flush() override WARN_UNUSED_RESULT;
   bool Parse(const uint8_t* buf, int size) override WARN_UNUSED_RESULT;
+  bool ParseInPlace(const uint8_t* buf, int size) override WARN_UNUSED_RESULT;
   /// @}
 
  private:
@@ -39,6 +40,9 @@ class WebMMediaParser : public MediaParser {
 
   void ChangeState(State new_state);
 
+  // Parses the data in |byte_queue_| as far as possible.
+  bool ParseQueue();
+
   // Parses WebM Header, Info, Tracks elements. It also skips other level 1
   // elements that are not used right now. Once the Info & Tracks elements have
   // been parsed, this method will transition the parser from PARSING_HEADERS to
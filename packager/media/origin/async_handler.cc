@@ -0,0 +1,83 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/origin/async_handler.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+const size_t kStreamIndex = 0;
+}  // namespace
+
+AsyncHandler::AsyncHandler(size_t queue_capacity) : queue_(queue_capacity) {}
+
+AsyncHandler::~AsyncHandler() = default;
+
+Status AsyncHandler::Run() {
+  Status status;
+  while (true) {
+    std::shared_ptr<StreamData> stream_data;
+    status = queue_.Pop(&stream_data, kInfiniteTimeout);
+    if (!status.ok())
+      break;
+
+    if (!stream_data) {
+      // A flush request is the last thing that comes from upstream.
+      status = FlushDownstream(kStreamIndex);
+      break;
+    }
+    // Move the content out of the queue entry, so the downstream handlers can
+    // be the sole owners of e.g. the media sample.
+    std::unique_ptr<StreamData> owned_stream_data(
+        new StreamData(std::move(*stream_data)));
+    stream_data.reset();
+    status = Dispatch(std::move(owned_stream_data));
+    if (!status.ok())
+      break;
+  }
+
+  if (!status.ok() && status.error_code() != error::STOPPED)
+    downstream_status_ = status;
+  queue_.Stop();
+  return status.error_code() == error::STOPPED ? Status::OK : status;
+}
+
+void AsyncHandler::Cancel() {
+  queue_.Stop();
+}
+
+Status AsyncHandler::InitializeInternal() {
+  if (num_input_streams() != 1 || next_output_stream_index() != 1) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Expects exactly one input and one output.");
+  }
+  return Status::OK;
+}
+
+Status AsyncHandler::Process(std::unique_ptr<StreamData> stream_data) {
+  DCHECK_EQ(kStreamIndex, stream_data->stream_index);
+  return Push(std::shared_ptr<StreamData>(std::move(stream_data)));
+}
+
+Status AsyncHandler::OnFlushRequest(size_t input_stream_index) {
+  DCHECK_EQ(kStreamIndex, input_stream_index);
+  return Push(nullptr);
+}
+
+Status AsyncHandler::Push(std::shared_ptr<StreamData> stream_data) {
+  Status status = queue_.Push(stream_data, kInfiniteTimeout);
+  if (status.ok())
+    return status;
+  // The queue is stopped, either because the handler is cancelled or because
+  // the downstream handlers failed.
+  if (!downstream_status_.ok())
+    return downstream_status_;
+  return Status(error::CANCELLED, "Asynchronous handler cancelled.");
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,60 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_ORIGIN_ASYNC_HANDLER_H_
+#define PACKAGER_MEDIA_ORIGIN_ASYNC_HANDLER_H_
+
+#include <memory>
+
+#include "packager/media/base/producer_consumer_queue.h"
+#include "packager/media/origin/origin_handler.h"
+
+namespace shaka {
+namespace media {
+
+// AsyncHandler is a single input single output handler which makes the edge
+// between its upstream and downstream handlers asynchronous. Stream data and
+// flush requests from upstream are pushed to a bounded queue, and |Run|, which
+// is expected to be run as a job, pops them and passes them downstream in the
+// same order. The downstream handlers therefore run on the job's thread, in
+// parallel with the upstream handlers.
+//
+// Upstream blocks when the queue is full, which keeps memory bounded. |Run|
+// returns after the flush request is passed downstream, or when an error is
+// encountered, in which case the error is returned to upstream on its next
+// push too.
+class AsyncHandler : public OriginHandler {
+ public:
+  // @param queue_capacity is the maximum number of stream data that can be
+  //        queued between upstream and downstream.
+  explicit AsyncHandler(size_t queue_capacity);
+  ~AsyncHandler() override;
+
+  Status Run() override;
+  void Cancel() override;
+
+ private:
+  AsyncHandler(const AsyncHandler&) = delete;
+  AsyncHandler& operator=(const AsyncHandler&) = delete;
+
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+
+  // Pushes |stream_data| to the queue. A null |stream_data| indicates a flush
+  // request.
+  Status Push(std::shared_ptr<StreamData> stream_data);
+
+  ProducerConsumerQueue<std::shared_ptr<StreamData>> queue_;
+  // The status of the downstream handlers. It is only set before |queue_| is
+  // stopped, so upstream can read it once a push fails.
+  Status downstream_status_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_ORIGIN_ASYNC_HANDLER_H_
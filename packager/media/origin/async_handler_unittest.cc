@@ -0,0 +1,115 @@
+// Copyright 2018 Google Inc. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/origin/async_handler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "packager/base/bind.h"
+#include "packager/media/base/closure_thread.h"
+#include "packager/media/base/media_handler_test_base.h"
+#include "packager/status_test_util.h"
+
+using ::testing::_;
+using ::testing::InSequence;
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kOneInput = 1;
+const size_t kOneOutput = 1;
+const size_t kStreamIndex = 0;
+const uint32_t kTimeScale = 1000;
+const int64_t kDuration = 1000;
+const bool kKeyFrame = true;
+const bool kEncrypted = true;
+
+}  // namespace
+
+class AsyncHandlerTest : public MediaHandlerTestBase {
+ protected:
+  void SetUpAndInitializeGraph(size_t queue_capacity) {
+    handler_ = std::make_shared<AsyncHandler>(queue_capacity);
+    ASSERT_OK(MediaHandlerTestBase::SetUpAndInitializeGraph(
+        handler_, kOneInput, kOneOutput));
+  }
+
+  Status DispatchStreamInfo() {
+    return Input(kStreamIndex)
+        ->Dispatch(StreamData::FromStreamInfo(
+            kStreamIndex, GetVideoStreamInfo(kTimeScale)));
+  }
+
+  Status DispatchSample(int64_t timestamp) {
+    return Input(kStreamIndex)
+        ->Dispatch(StreamData::FromMediaSample(
+            kStreamIndex, GetMediaSample(timestamp, kDuration, kKeyFrame)));
+  }
+
+  // Dispatches a stream info and |num_samples| samples followed by a flush.
+  void DispatchStream(int num_samples) {
+    ASSERT_OK(DispatchStreamInfo());
+    for (int i = 0; i < num_samples; ++i)
+      ASSERT_OK(DispatchSample(i * kDuration));
+    ASSERT_OK(Input(kStreamIndex)->FlushAllDownstreams());
+  }
+
+  std::shared_ptr<AsyncHandler> handler_;
+};
+
+TEST_F(AsyncHandlerTest, PassesStreamDataAndFlushInOrder) {
+  const size_t kQueueCapacity = 10;
+  SetUpAndInitializeGraph(kQueueCapacity);
+
+  {
+    InSequence s;
+    EXPECT_CALL(*Output(kStreamIndex),
+                OnProcess(IsStreamInfo(kStreamIndex, kTimeScale, !kEncrypted,
+                                       _)));
+    EXPECT_CALL(*Output(kStreamIndex),
+                OnProcess(IsMediaSample(kStreamIndex, 0, kDuration,
+                                        !kEncrypted, _)));
+    EXPECT_CALL(*Output(kStreamIndex),
+                OnProcess(IsMediaSample(kStreamIndex, kDuration, kDuration,
+                                        !kEncrypted, _)));
+    EXPECT_CALL(*Output(kStreamIndex), OnFlush(kStreamIndex));
+  }
+
+  DispatchStream(2);
+  ASSERT_OK(handler_->Run());
+}
+
+TEST_F(AsyncHandlerTest, BlocksUpstreamWhenQueueIsFull) {
+  const size_t kQueueCapacity = 1;
+  const int kNumSamples = 20;
+  SetUpAndInitializeGraph(kQueueCapacity);
+
+  EXPECT_CALL(*Output(kStreamIndex), OnProcess(_)).Times(kNumSamples + 1);
+  EXPECT_CALL(*Output(kStreamIndex), OnFlush(kStreamIndex));
+
+  ClosureThread upstream_thread(
+      "UpstreamThread", base::Bind(&AsyncHandlerTest::DispatchStream,
+                                   base::Unretained(this), kNumSamples));
+  upstream_thread.Start();
+  ASSERT_OK(handler_->Run());
+  upstream_thread.Join();
+}
+
+TEST_F(AsyncHandlerTest, Cancel) {
+  const size_t kQueueCapacity = 10;
+  SetUpAndInitializeGraph(kQueueCapacity);
+
+  EXPECT_CALL(*Output(kStreamIndex), OnProcess(_)).Times(0);
+
+  handler_->Cancel();
+  ASSERT_OK(handler_->Run());
+  EXPECT_EQ(error::CANCELLED, DispatchStreamInfo().error_code());
+}
+
+}  // namespace media
+}  // namespace shaka
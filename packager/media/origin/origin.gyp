@@ -13,6 +13,8 @@
       'target_name': 'origin',
       'type': '<(component)',
       'sources': [
+        'async_handler.cc',
+        'async_handler.h',
         'origin_handler.cc',
         'origin_handler.h',
       ],
@@ -20,5 +22,19 @@
         '../base/media_base.gyp:media_base',
       ],
     },
+    {
+      'target_name': 'origin_unittest',
+      'type': '<(gtest_target_type)',
+      'sources': [
+        'async_handler_unittest.cc',
+      ],
+      'dependencies': [
+        '../../testing/gtest.gyp:gtest',
+        '../../testing/gmock.gyp:gmock',
+        '../base/media_base.gyp:media_handler_test_base',
+        '../test/media_test.gyp:media_test_support',
+        'origin',
+      ]
+    },
   ],
 }
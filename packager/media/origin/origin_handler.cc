@@ -6,9 +6,17 @@
 
 #include "packager/media/origin/origin_handler.h"
 
+#include "packager/base/logging.h"
+
 namespace shaka {
 namespace media {
 
+Status OriginHandler::RunSlice(bool* done) {
+  DCHECK(done);
+  *done = true;
+  return Run();
+}
+
 // Origin handlers are always at the start of a pipeline (chain or handlers)
 // and therefore should never receive input via |Process|.
 Status OriginHandler::Process(std::unique_ptr<StreamData> stream_data) {
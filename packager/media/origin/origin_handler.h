@@ -26,6 +26,13 @@ class OriginHandler : public MediaHandler {
   // be used.
   virtual Status Run() = 0;
 
+  // Process a slice of the input and send messages down stream, so the
+  // caller can interleave the handler with other work on the same thread.
+  // |done| is set to true when there is no more input to process or an error
+  // occurred. The slice is expected to end at a sample or segment boundary.
+  // The default implementation processes all input in one call to |Run|.
+  virtual Status RunSlice(bool* done);
+
   // Non-blocking call to the handler, requesting that it exit the
   // current call to |Run|. The handler should stop processing data
   // as soon is convenient.
@@ -140,6 +140,24 @@ struct EncryptionParams {
   double crypto_period_duration_in_seconds = kNoKeyRotation;
   /// Enable/disable subsample encryption for VP9.
   bool vp9_subsample_encryption = true;
+  /// Number of worker threads, shared by all the streams, the encryption of
+  /// large samples is split across. Only applies to the 'cenc' protection
+  /// scheme. The output is the same as without workers. 0 means the samples
+  /// are encrypted on the threads processing the streams only.
+  uint32_t num_encryption_workers = 0;
+  /// Number of crypto periods after the current one whose keys are fetched in
+  /// the background when key rotation is enabled. Does not apply to Widevine,
+  /// which always fetches the keys ahead. 0 means the key of a crypto period
+  /// is fetched when the period starts.
+  uint32_t num_prefetched_crypto_periods = 0;
+  /// File the crypto period keys are saved to when key rotation is enabled,
+  /// and loaded from on start, so a restarted job does not fetch them again.
+  /// Note that the keys are saved in the clear. The saved keys are ignored if
+  /// the key source or the crypto period duration has changed.
+  std::string key_cache_file;
+  /// How long a crypto period key is served from the cache after it has been
+  /// fetched. The keys do not expire if it is 0.
+  double key_cache_ttl_in_seconds = 0;
 
   /// Encrypted stream information that is used to determine stream label.
   struct EncryptedStreamAttributes {
@@ -164,6 +164,17 @@ class RepresentationStateChangeListenerImpl
   DISALLOW_COPY_AND_ASSIGN(RepresentationStateChangeListenerImpl);
 };
 
+bool AddRepresentationXml(Representation* representation,
+                          xml::AdaptationSetXmlNode* adaptation_set) {
+  xml::scoped_xml_ptr<xmlNode> child(representation->GetXml());
+  return child && adaptation_set->AddChild(std::move(child));
+}
+
+bool AddRepresentationXml(Representation* representation,
+                          xml::XmlWriter* writer) {
+  return representation->WriteXml(writer);
+}
+
 }  // namespace
 
 AdaptationSet::AdaptationSet(const std::string& language,
@@ -217,16 +228,19 @@ void AdaptationSet::AddContentProtectionElement(
     const ContentProtectionElement& content_protection_element) {
   content_protection_elements_.push_back(content_protection_element);
   RemoveDuplicateAttributes(&content_protection_elements_.back());
+  xml_dirty_ = true;
 }
 
 void AdaptationSet::UpdateContentProtectionPssh(const std::string& drm_uuid,
                                                 const std::string& pssh) {
   UpdateContentProtectionPsshHelper(drm_uuid, pssh,
                                     &content_protection_elements_);
+  xml_dirty_ = true;
 }
 
 void AdaptationSet::AddRole(Role role) {
   roles_.insert(role);
+  xml_dirty_ = true;
 }
 
 // Creates a copy of <AdaptationSet> xml element, iterate thru all the
@@ -235,41 +249,41 @@ void AdaptationSet::AddRole(Role role) {
 // can be passed to Representation to avoid setting redundant attributes. For
 // example, if AdaptationSet@width is set, then Representation@width is
 // redundant and should not be set.
-xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
-  xml::AdaptationSetXmlNode adaptation_set;
+template <typename XmlElement>
+bool AdaptationSet::PopulateXml(XmlElement* adaptation_set) {
 
   bool suppress_representation_width = false;
   bool suppress_representation_height = false;
   bool suppress_representation_frame_rate = false;
 
   if (id_)
-    adaptation_set.SetId(id_.value());
-  adaptation_set.SetStringAttribute("contentType", content_type_);
+    adaptation_set->SetId(id_.value());
+  adaptation_set->SetStringAttribute("contentType", content_type_);
   if (!language_.empty() && language_ != "und") {
-    adaptation_set.SetStringAttribute("lang", language_);
+    adaptation_set->SetStringAttribute("lang", language_);
   }
 
   // Note that std::{set,map} are ordered, so the last element is the max value.
   if (video_widths_.size() == 1) {
     suppress_representation_width = true;
-    adaptation_set.SetIntegerAttribute("width", *video_widths_.begin());
+    adaptation_set->SetIntegerAttribute("width", *video_widths_.begin());
   } else if (video_widths_.size() > 1) {
-    adaptation_set.SetIntegerAttribute("maxWidth", *video_widths_.rbegin());
+    adaptation_set->SetIntegerAttribute("maxWidth", *video_widths_.rbegin());
   }
   if (video_heights_.size() == 1) {
     suppress_representation_height = true;
-    adaptation_set.SetIntegerAttribute("height", *video_heights_.begin());
+    adaptation_set->SetIntegerAttribute("height", *video_heights_.begin());
   } else if (video_heights_.size() > 1) {
-    adaptation_set.SetIntegerAttribute("maxHeight", *video_heights_.rbegin());
+    adaptation_set->SetIntegerAttribute("maxHeight", *video_heights_.rbegin());
   }
 
   if (video_frame_rates_.size() == 1) {
     suppress_representation_frame_rate = true;
-    adaptation_set.SetStringAttribute("frameRate",
-                                      video_frame_rates_.begin()->second);
+    adaptation_set->SetStringAttribute("frameRate",
+                                       video_frame_rates_.begin()->second);
   } else if (video_frame_rates_.size() > 1) {
-    adaptation_set.SetStringAttribute("maxFrameRate",
-                                      video_frame_rates_.rbegin()->second);
+    adaptation_set->SetStringAttribute("maxFrameRate",
+                                       video_frame_rates_.rbegin()->second);
   }
 
   // Note: must be checked before checking segments_aligned_ (below). So that
@@ -279,7 +293,7 @@ xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
   }
 
   if (segments_aligned_ == kSegmentAlignmentTrue) {
-    adaptation_set.SetStringAttribute(
+    adaptation_set->SetStringAttribute(
         mpd_options_.dash_profile == DashProfile::kOnDemand
             ? "subsegmentAlignment"
             : "segmentAlignment",
@@ -287,11 +301,11 @@ xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
   }
 
   if (picture_aspect_ratio_.size() == 1)
-    adaptation_set.SetStringAttribute("par", *picture_aspect_ratio_.begin());
+    adaptation_set->SetStringAttribute("par", *picture_aspect_ratio_.begin());
 
-  if (!adaptation_set.AddContentProtectionElements(
+  if (!adaptation_set->AddContentProtectionElements(
           content_protection_elements_)) {
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
 
   std::string trick_play_reference_ids;
@@ -302,7 +316,7 @@ xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
     trick_play_reference_ids += std::to_string(adaptation_set->id());
   }
   if (!trick_play_reference_ids.empty()) {
-    adaptation_set.AddEssentialProperty(
+    adaptation_set->AddEssentialProperty(
         "http://dashif.org/guidelines/trickmode", trick_play_reference_ids);
   }
 
@@ -314,12 +328,12 @@ xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
     switching_ids += std::to_string(adaptation_set->id());
   }
   if (!switching_ids.empty()) {
-    adaptation_set.AddSupplementalProperty(
+    adaptation_set->AddSupplementalProperty(
         "urn:mpeg:dash:adaptation-set-switching:2016", switching_ids);
   }
 
   for (AdaptationSet::Role role : roles_)
-    adaptation_set.AddRoleElement("urn:mpeg:dash:role:2011", RoleToText(role));
+    adaptation_set->AddRoleElement("urn:mpeg:dash:role:2011", RoleToText(role));
 
   for (const auto& representation_pair : representation_map_) {
     const auto& representation = representation_pair.second;
@@ -329,23 +343,44 @@ xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
       representation->SuppressOnce(Representation::kSuppressHeight);
     if (suppress_representation_frame_rate)
       representation->SuppressOnce(Representation::kSuppressFrameRate);
-    xml::scoped_xml_ptr<xmlNode> child(representation->GetXml());
-    if (!child || !adaptation_set.AddChild(std::move(child)))
-      return xml::scoped_xml_ptr<xmlNode>();
+    if (!AddRepresentationXml(representation.get(), adaptation_set))
+      return false;
   }
+  return true;
+}
 
+xml::scoped_xml_ptr<xmlNode> AdaptationSet::GetXml() {
+  xml::AdaptationSetXmlNode adaptation_set;
+  if (!PopulateXml(&adaptation_set))
+    return xml::scoped_xml_ptr<xmlNode>();
   return adaptation_set.PassScopedPtr();
 }
 
+bool AdaptationSet::WriteXml(xml::XmlWriter* writer) {
+  const bool result = writer->AddCachedElement(
+      IsXmlDirty(),
+      [this](xml::XmlWriter* fragment) {
+        fragment->StartElement("AdaptationSet");
+        const bool result = PopulateXml(fragment);
+        fragment->EndElement();
+        return result;
+      },
+      &xml_cache_);
+  xml_dirty_ = !result;
+  return result;
+}
+
 void AdaptationSet::ForceSetSegmentAlignment(bool segment_alignment) {
   segments_aligned_ =
       segment_alignment ? kSegmentAlignmentTrue : kSegmentAlignmentFalse;
   force_set_segment_alignment_ = true;
+  xml_dirty_ = true;
 }
 
 void AdaptationSet::AddAdaptationSetSwitching(
     const AdaptationSet* adaptation_set) {
   switchable_adaptation_sets_.push_back(adaptation_set);
+  xml_dirty_ = true;
 }
 
 // For dynamic MPD, storing all start_time and duration will out-of-memory
@@ -363,16 +398,19 @@ void AdaptationSet::OnNewSegmentForRepresentation(uint32_t representation_id,
     representation_segment_start_times_[representation_id].push_back(
         start_time);
   }
+  xml_dirty_ = true;
 }
 
 void AdaptationSet::OnSetFrameRateForRepresentation(uint32_t representation_id,
                                                     uint32_t frame_duration,
                                                     uint32_t timescale) {
   RecordFrameRate(frame_duration, timescale);
+  xml_dirty_ = true;
 }
 
 void AdaptationSet::AddTrickPlayReference(const AdaptationSet* adaptation_set) {
   trick_play_references_.push_back(adaptation_set);
+  xml_dirty_ = true;
 }
 
 const std::list<Representation*> AdaptationSet::GetRepresentations() const {
@@ -387,7 +425,18 @@ bool AdaptationSet::IsVideo() const {
   return content_type_ == "video";
 }
 
+bool AdaptationSet::IsXmlDirty() const {
+  if (xml_dirty_)
+    return true;
+  for (const auto& representation_pair : representation_map_) {
+    if (representation_pair.second->xml_dirty_)
+      return true;
+  }
+  return false;
+}
+
 void AdaptationSet::UpdateFromMediaInfo(const MediaInfo& media_info) {
+  xml_dirty_ = true;
   // For videos, record the width, height, and the frame rate to calculate the
   // max {width,height,framerate} required for DASH IOP.
   if (media_info.has_video_info()) {
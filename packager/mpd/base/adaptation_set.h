@@ -30,6 +30,7 @@ struct MpdOptions;
 
 namespace xml {
 class XmlNode;
+class XmlWriter;
 }  // namespace xml
 
 /// AdaptationSet class provides methods to add Representations and
@@ -106,6 +107,11 @@ class AdaptationSet {
   ///         NULL scoped_xml_ptr.
   xml::scoped_xml_ptr<xmlNode> GetXml();
 
+  /// Writes the AdaptationSet xml element with its child Representation and
+  /// ContentProtection elements to @a writer.
+  /// @return true on success, false otherwise.
+  bool WriteXml(xml::XmlWriter* writer);
+
   /// Forces the (sub)segmentAlignment field to be set to @a segment_alignment.
   /// Use this if you are certain that the (sub)segments are alinged/unaligned
   /// for the AdaptationSet.
@@ -125,7 +131,10 @@ class AdaptationSet {
 
   /// Set AdaptationSet@id.
   /// @param id is the new ID to be set.
-  void set_id(uint32_t id) { id_ = id; }
+  void set_id(uint32_t id) {
+    id_ = id;
+    xml_dirty_ = true;
+  }
 
   /// Notifies the AdaptationSet instance that a new (sub)segment was added to
   /// the Representation with @a representation_id.
@@ -186,6 +195,11 @@ class AdaptationSet {
   friend class Period;
   friend class AdaptationSetTest;
 
+  // Populates the attributes and children of |adaptation_set|, which is an
+  // xml::AdaptationSetXmlNode or an xml::XmlWriter.
+  template <typename XmlElement>
+  bool PopulateXml(XmlElement* adaptation_set);
+
   // kSegmentAlignmentUnknown means that it is uncertain if the
   // (sub)segments are aligned or not.
   // kSegmentAlignmentTrue means that it is certain that the all the (current)
@@ -229,6 +243,10 @@ class AdaptationSet {
   // Records the framerate of a Representation.
   void RecordFrameRate(uint32_t frame_duration, uint32_t timescale);
 
+  // Returns true if the XML of this AdaptationSet or of its Representations
+  // may have changed since it was last written to |xml_cache_|.
+  bool IsXmlDirty() const;
+
   std::list<ContentProtectionElement> content_protection_elements_;
   // representation_id => Representation map. It also keeps the representations_
   // sorted by default.
@@ -292,6 +310,12 @@ class AdaptationSet {
   // and HD videos in different AdaptationSets can share the same trick play
   // stream.
   std::vector<const AdaptationSet*> trick_play_references_;
+
+  // Set when the attributes or the children of this AdaptationSet, other than
+  // the Representations, may have changed since it was last written to
+  // |xml_cache_|.
+  bool xml_dirty_ = true;
+  std::unique_ptr<xml::XmlWriter> xml_cache_;
 };
 
 }  // namespace shaka
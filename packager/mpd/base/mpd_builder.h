@@ -31,6 +31,7 @@ class Period;
 
 namespace xml {
 class XmlNode;
+class XmlWriter;
 }  // namespace xml
 
 /// This class generates DASH MPDs (Media Presentation Descriptions).
@@ -88,19 +89,33 @@ class MpdBuilder {
   // On failure, this returns NULL.
   xmlDocPtr GenerateMpd();
 
+  // Writes the same document as GenerateMpd() to |writer|, without building a
+  // libxml2 document. Returns true on success, false otherwise.
+  bool WriteMpd(xml::XmlWriter* writer);
+
+  // Populates the attributes and children of |mpd|. XmlElement is
+  // xml::XmlNode or xml::XmlWriter, and so are the XmlElement parameters
+  // below.
+  template <typename XmlElement>
+  bool PopulateMpd(XmlElement* mpd);
+
   // Set MPD attributes common to all profiles. Uses non-zero |mpd_options_| to
   // set attributes for the MPD.
-  void AddCommonMpdInfo(xml::XmlNode* mpd_node);
+  template <typename XmlElement>
+  void AddCommonMpdInfo(XmlElement* mpd_node);
 
   // Adds 'static' MPD attributes and elements to |mpd_node|. This assumes that
   // the first child element is a Period element.
-  void AddStaticMpdInfo(xml::XmlNode* mpd_node);
+  template <typename XmlElement>
+  void AddStaticMpdInfo(XmlElement* mpd_node);
 
   // Same as AddStaticMpdInfo() but for 'dynamic' MPDs.
-  void AddDynamicMpdInfo(xml::XmlNode* mpd_node);
+  template <typename XmlElement>
+  void AddDynamicMpdInfo(XmlElement* mpd_node);
 
   // Add UTCTiming element if utc timing is provided.
-  void AddUtcTiming(xml::XmlNode* mpd_node);
+  template <typename XmlElement>
+  void AddUtcTiming(XmlElement* mpd_node);
 
   float GetStaticMpdDuration();
 
@@ -4,17 +4,22 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <gflags/gflags.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "packager/mpd/base/adaptation_set.h"
+#include "packager/mpd/base/content_protection_element.h"
 #include "packager/mpd/base/mpd_builder.h"
 #include "packager/mpd/base/period.h"
 #include "packager/mpd/base/representation.h"
 #include "packager/mpd/test/mpd_builder_test_helper.h"
 #include "packager/version/version.h"
 
+DECLARE_bool(mpd_use_libxml_dom);
+
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 namespace shaka {
 
@@ -48,9 +53,22 @@ class MpdBuilderTest : public ::testing::Test {
 
   MpdOptions* mutable_mpd_options() { return &mpd_.mpd_options_; }
 
+  // Generates the MPD with the direct writer and checks that it is identical
+  // to the MPD generated with libxml2.
+  void MpdToString(std::string* mpd_doc) {
+    FLAGS_mpd_use_libxml_dom = true;
+    std::string libxml_mpd_doc;
+    const bool libxml_result = mpd_.ToString(&libxml_mpd_doc);
+    FLAGS_mpd_use_libxml_dom = false;
+    ASSERT_TRUE(libxml_result);
+
+    ASSERT_TRUE(mpd_.ToString(mpd_doc));
+    ASSERT_EQ(libxml_mpd_doc, *mpd_doc);
+  }
+
   void CheckMpd(const std::string& expected_output_file) {
     std::string mpd_doc;
-    ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+    ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
     ASSERT_TRUE(ValidateMpdSchema(mpd_doc));
 
     ASSERT_NO_FATAL_FAILURE(
@@ -172,13 +190,25 @@ TEST_F(OnDemandMpdBuilderTest, CheckXmlTest) {
                      kPeriod1SegmentDurationSeconds, period);
 
   std::string mpd_doc;
-  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
   EXPECT_THAT(mpd_doc, HasSubstr("<Period id=\"0\">\n"));
   EXPECT_THAT(mpd_doc,
               HasSubstr("<SegmentBase indexRange=\"121-221\""
                         " timescale=\"1000\" presentationTimeOffset=\"200\">"));
 }
 
+TEST_F(OnDemandMpdBuilderTest, BaseUrlWithReferences) {
+  mpd_.AddBaseUrl("http://foo.bar/?a=1&amp;b=<2>&#x41;");
+  MediaInfo video_media_info = GetTestMediaInfo(kFileNameVideoMediaInfo1);
+  ASSERT_NO_FATAL_FAILURE(AddRepresentation(video_media_info));
+
+  std::string mpd_doc;
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc,
+              HasSubstr("<BaseURL>http://foo.bar/?a=1&amp;b=&lt;2&gt;A"
+                        "</BaseURL>\n"));
+}
+
 TEST_F(OnDemandMpdBuilderTest, MultiplePeriodTest) {
   const double kPeriodStartTimeSeconds = 1.0;
   Period* period = mpd_.GetOrCreatePeriod(kPeriodStartTimeSeconds);
@@ -226,7 +256,7 @@ TEST_F(OnDemandMpdBuilderTest, MultiplePeriodCheckXmlTest) {
                      kPeriod3SegmentDurationSeconds, period);
 
   std::string mpd_doc;
-  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
   EXPECT_THAT(mpd_doc, HasSubstr("<Period id=\"0\" duration=\"PT3S\">\n"));
   EXPECT_THAT(mpd_doc,
               HasSubstr("<SegmentBase indexRange=\"121-221\""
@@ -252,12 +282,117 @@ TEST_F(LiveMpdBuilderTest, MultiplePeriodCheckXmlTest) {
   mpd_.GetOrCreatePeriod(kPeriod3StartTimeSeconds);
 
   std::string mpd_doc;
-  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
   EXPECT_THAT(mpd_doc, HasSubstr("  <Period id=\"0\" start=\"PT0S\"/>\n"
                                  "  <Period id=\"1\" start=\"PT3.1S\"/>\n"
                                  "  <Period id=\"2\" start=\"PT8S\"/>\n"));
 }
 
+TEST_F(LiveMpdBuilderTest, ContentProtectionAndSegmentTimeline) {
+  const char kVideoMediaInfo[] =
+      "video_info {\n"
+      "  codec: 'avc1'\n"
+      "  width: 1280\n"
+      "  height: 720\n"
+      "  time_scale: 10\n"
+      "  frame_duration: 10\n"
+      "  pixel_width: 1\n"
+      "  pixel_height: 1\n"
+      "}\n"
+      "reference_time_scale: 1000\n"
+      "container_type: CONTAINER_MP4\n"
+      "init_segment_url: 'init.mp4'\n"
+      "segment_template_url: '$Number$.mp4'\n";
+  const MediaInfo media_info = ConvertToMediaInfo(kVideoMediaInfo);
+
+  const double kPeriodStartTimeSeconds = 0.0;
+  Period* period = mpd_.GetOrCreatePeriod(kPeriodStartTimeSeconds);
+  AdaptationSet* adaptation_set =
+      period->GetOrCreateAdaptationSet(media_info, true);
+  ContentProtectionElement content_protection;
+  content_protection.scheme_id_uri =
+      "urn:uuid:edef8ba9-79d6-4ace-a3c8-27dcd51d21ed";
+  content_protection.additional_attributes["cenc:default_KID"] =
+      "e5007e6e-9dcd-5ac0-9520-2ed3758382cd";
+  Element pssh;
+  pssh.name = "cenc:pssh";
+  pssh.content = "AAAAAA==";
+  content_protection.subelements.push_back(pssh);
+  adaptation_set->AddContentProtectionElement(content_protection);
+
+  Representation* representation =
+      adaptation_set->AddRepresentation(media_info);
+  const uint64_t kSize = 1000;
+  representation->AddNewSegment(0, 2000, kSize);
+  representation->AddNewSegment(2000, 2000, kSize);
+  representation->AddNewSegment(4000, 1000, kSize);
+
+  std::string mpd_doc;
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc, HasSubstr(" xmlns:cenc=\"urn:mpeg:cenc:2013\""));
+  EXPECT_THAT(mpd_doc, HasSubstr("<cenc:pssh>AAAAAA==</cenc:pssh>\n"));
+  EXPECT_THAT(mpd_doc, HasSubstr("<S t=\"0\" d=\"2000\" r=\"1\"/>\n"));
+}
+
+// Verify that the MPD is regenerated correctly when parts of it change
+// between the generations, as the unchanged parts are reused.
+TEST_F(LiveMpdBuilderTest, RegenerateAfterChanges) {
+  const char kVideoMediaInfo[] =
+      "video_info {\n"
+      "  codec: 'avc1'\n"
+      "  width: 1280\n"
+      "  height: 720\n"
+      "  time_scale: 10\n"
+      "  frame_duration: 10\n"
+      "  pixel_width: 1\n"
+      "  pixel_height: 1\n"
+      "}\n"
+      "reference_time_scale: 1000\n"
+      "container_type: CONTAINER_MP4\n"
+      "init_segment_url: 'init.mp4'\n"
+      "segment_template_url: '$Number$.mp4'\n";
+  const MediaInfo media_info = ConvertToMediaInfo(kVideoMediaInfo);
+  const uint64_t kSize = 1000;
+
+  Period* period1 = mpd_.GetOrCreatePeriod(0.0);
+  AdaptationSet* adaptation_set1 =
+      period1->GetOrCreateAdaptationSet(media_info, true);
+  ContentProtectionElement content_protection;
+  content_protection.scheme_id_uri =
+      "urn:uuid:edef8ba9-79d6-4ace-a3c8-27dcd51d21ed";
+  Element pssh;
+  pssh.name = "cenc:pssh";
+  pssh.content = "AAAAAA==";
+  content_protection.subelements.push_back(pssh);
+  adaptation_set1->AddContentProtectionElement(content_protection);
+  Representation* representation1 =
+      adaptation_set1->AddRepresentation(media_info);
+  representation1->AddNewSegment(0, 2000, kSize);
+
+  std::string mpd_doc;
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc, HasSubstr("<cenc:pssh>AAAAAA==</cenc:pssh>\n"));
+
+  Period* period2 = mpd_.GetOrCreatePeriod(2.0);
+  Representation* representation2 =
+      period2->GetOrCreateAdaptationSet(media_info, true)
+          ->AddRepresentation(media_info);
+  representation2->AddNewSegment(2000, 2000, kSize);
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc, HasSubstr("<Period id=\"1\" start=\"PT2S\">\n"));
+
+  representation2->AddNewSegment(4000, 1000, kSize);
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc, HasSubstr("<S t=\"2000\" d=\"2000\"/>\n"
+                                 "            <S t=\"4000\" d=\"1000\"/>\n"));
+
+  adaptation_set1->UpdateContentProtectionPssh(
+      "edef8ba9-79d6-4ace-a3c8-27dcd51d21ed", "AAAAAQ==");
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
+  // The pssh element is removed when it is updated.
+  EXPECT_THAT(mpd_doc, Not(HasSubstr("cenc:pssh")));
+}
+
 // Check whether the attributes are set correctly for dynamic <MPD> element.
 // This test must use ASSERT_EQ for comparison because XmlEqual() cannot
 // handle namespaces correctly yet.
@@ -289,7 +424,7 @@ TEST_F(LiveMpdBuilderTest, DynamicCheckMpdAttributes) {
        "http://foo.bar/my_body_is_the_current_date_and_time"},
       {"urn:mpeg:dash:utc:http-head:2014",
        "http://foo.bar/check_me_for_the_date_header"}};
-  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
   ASSERT_EQ(kExpectedOutput, mpd_doc);
 }
 
@@ -317,7 +452,7 @@ TEST_F(LiveMpdBuilderTest, StaticCheckMpdAttributes) {
       {"urn:mpeg:dash:utc:http-head:2014",
        "http://foo.bar/check_me_for_the_date_header"}};
 
-  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  ASSERT_NO_FATAL_FAILURE(MpdToString(&mpd_doc));
   ASSERT_EQ(kExpectedOutput, mpd_doc);
 }
 
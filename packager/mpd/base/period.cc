@@ -32,6 +32,16 @@ std::set<std::string> GetUUIDs(
   return uuids;
 }
 
+bool AddAdaptationSetXml(AdaptationSet* adaptation_set, xml::XmlNode* period) {
+  xml::scoped_xml_ptr<xmlNode> child(adaptation_set->GetXml());
+  return child && period->AddChild(std::move(child));
+}
+
+bool AddAdaptationSetXml(AdaptationSet* adaptation_set,
+                         xml::XmlWriter* writer) {
+  return adaptation_set->WriteXml(writer);
+}
+
 }  // namespace
 
 Period::Period(uint32_t period_id,
@@ -43,13 +53,17 @@ Period::Period(uint32_t period_id,
       mpd_options_(mpd_options),
       representation_counter_(representation_counter) {}
 
+Period::~Period() {}
+
 AdaptationSet* Period::GetOrCreateAdaptationSet(
     const MediaInfo& media_info,
     bool content_protection_in_adaptation_set) {
   // Set duration if it is not set. It may be updated later from duration
   // calculated from segments.
-  if (duration_seconds_ == 0)
+  if (duration_seconds_ == 0) {
     duration_seconds_ = media_info.media_duration_seconds();
+    xml_dirty_ = true;
+  }
 
   // AdaptationSets with the same key should only differ in ContentProtection,
   // which also means that if |content_protection_in_adaptation_set| is false,
@@ -93,10 +107,12 @@ AdaptationSet* Period::GetOrCreateAdaptationSet(
   AdaptationSet* adaptation_set_ptr = new_adaptation_set.get();
   adaptation_sets.push_back(adaptation_set_ptr);
   adaptation_sets_.emplace_back(std::move(new_adaptation_set));
+  xml_dirty_ = true;
   return adaptation_set_ptr;
 }
 
-xml::scoped_xml_ptr<xmlNode> Period::GetXml(bool output_period_duration) {
+template <typename XmlElement>
+bool Period::PopulateXml(bool output_period_duration, XmlElement* period) {
   adaptation_sets_.sort(
       [](const std::unique_ptr<AdaptationSet>& adaptation_set_a,
          const std::unique_ptr<AdaptationSet>& adaptation_set_b) {
@@ -107,27 +123,55 @@ xml::scoped_xml_ptr<xmlNode> Period::GetXml(bool output_period_duration) {
         return adaptation_set_a->id() < adaptation_set_b->id();
       });
 
-  xml::XmlNode period("Period");
-
   // Required for 'dynamic' MPDs.
-  period.SetId(id_);
+  period->SetId(id_);
   // Iterate thru AdaptationSets and add them to one big Period element.
   for (const auto& adaptation_set : adaptation_sets_) {
-    xml::scoped_xml_ptr<xmlNode> child(adaptation_set->GetXml());
-    if (!child || !period.AddChild(std::move(child)))
-      return nullptr;
+    if (!AddAdaptationSetXml(adaptation_set.get(), period))
+      return false;
   }
 
   if (output_period_duration) {
-    period.SetStringAttribute("duration",
-                              SecondsToXmlDuration(duration_seconds_));
+    period->SetStringAttribute("duration",
+                               SecondsToXmlDuration(duration_seconds_));
   } else if (mpd_options_.mpd_type == MpdType::kDynamic) {
-    period.SetStringAttribute("start",
-                              SecondsToXmlDuration(start_time_in_seconds_));
+    period->SetStringAttribute("start",
+                               SecondsToXmlDuration(start_time_in_seconds_));
   }
+  return true;
+}
+
+xml::scoped_xml_ptr<xmlNode> Period::GetXml(bool output_period_duration) {
+  xml::XmlNode period("Period");
+  if (!PopulateXml(output_period_duration, &period))
+    return nullptr;
   return period.PassScopedPtr();
 }
 
+bool Period::WriteXml(bool output_period_duration, xml::XmlWriter* writer) {
+  if (output_period_duration != xml_cache_output_period_duration_) {
+    xml_cache_output_period_duration_ = output_period_duration;
+    xml_dirty_ = true;
+  }
+  bool dirty = xml_dirty_;
+  for (const auto& adaptation_set : adaptation_sets_)
+    dirty = dirty || adaptation_set->IsXmlDirty();
+
+  // Only the changed AdaptationSets and Representations are written again,
+  // the others are added from their caches.
+  const bool result = writer->AddCachedElement(
+      dirty,
+      [this, output_period_duration](xml::XmlWriter* fragment) {
+        fragment->StartElement("Period");
+        const bool result = PopulateXml(output_period_duration, fragment);
+        fragment->EndElement();
+        return result;
+      },
+      &xml_cache_);
+  xml_dirty_ = !result;
+  return result;
+}
+
 const std::list<AdaptationSet*> Period::GetAdaptationSets() const {
   std::list<AdaptationSet*> adaptation_sets;
   for (const auto& adaptation_set : adaptation_sets_) {
@@ -11,6 +11,7 @@
 
 #include <list>
 #include <map>
+#include <memory>
 
 #include "packager/base/optional.h"
 #include "packager/mpd/base/adaptation_set.h"
@@ -23,13 +24,14 @@ struct MpdOptions;
 
 namespace xml {
 class XmlNode;
+class XmlWriter;
 }  // namespace xml
 
 /// Period class maps to <Period> element and provides methods to add
 /// AdaptationSets.
 class Period {
  public:
-  virtual ~Period() = default;
+  virtual ~Period();
 
   /// Check the existing AdaptationSets, if there is one matching the provided
   /// @a media_info, return it; otherwise a new AdaptationSet is created and
@@ -52,6 +54,11 @@ class Period {
   ///         NULL scoped_xml_ptr.
   xml::scoped_xml_ptr<xmlNode> GetXml(bool output_period_duration);
 
+  /// Writes <Period> xml element with its child AdaptationSet elements to
+  /// @a writer.
+  /// @return true on success, false otherwise.
+  bool WriteXml(bool output_period_duration, xml::XmlWriter* writer);
+
   /// @return The list of AdaptationSets in this Period.
   const std::list<AdaptationSet*> GetAdaptationSets() const;
 
@@ -64,6 +71,7 @@ class Period {
   /// Set period duration.
   void set_duration_seconds(double duration_seconds) {
     duration_seconds_ = duration_seconds;
+    xml_dirty_ = true;
   }
 
  protected:
@@ -84,6 +92,11 @@ class Period {
   friend class MpdBuilder;
   friend class PeriodTest;
 
+  // Populates the attributes and children of |period|, which is an
+  // xml::XmlNode or an xml::XmlWriter.
+  template <typename XmlElement>
+  bool PopulateXml(bool output_period_duration, XmlElement* period);
+
   // Calls AdaptationSet constructor. For mock injection.
   virtual std::unique_ptr<AdaptationSet> NewAdaptationSet(
       const std::string& lang,
@@ -110,6 +123,14 @@ class Period {
   const MpdOptions& mpd_options_;
   uint32_t* const representation_counter_;
   std::list<std::unique_ptr<AdaptationSet>> adaptation_sets_;
+
+  // Set when the attributes of the Period or its list of AdaptationSets may
+  // have changed since it was last written to |xml_cache_|, with
+  // |xml_cache_output_period_duration_|. A closed Period, which does not get
+  // new segments, is then written from |xml_cache_|.
+  bool xml_dirty_ = true;
+  std::unique_ptr<xml::XmlWriter> xml_cache_;
+  bool xml_cache_output_period_duration_ = false;
   // AdaptationSets grouped by a specific adaptation set grouping key.
   // AdaptationSets with the same key contain identical parameters except
   // ContentProtection parameters. A single AdaptationSet would be created
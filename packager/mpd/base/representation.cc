@@ -186,12 +186,14 @@ void Representation::AddContentProtectionElement(
     const ContentProtectionElement& content_protection_element) {
   content_protection_elements_.push_back(content_protection_element);
   RemoveDuplicateAttributes(&content_protection_elements_.back());
+  xml_dirty_ = true;
 }
 
 void Representation::UpdateContentProtectionPssh(const std::string& drm_uuid,
                                                  const std::string& pssh) {
   UpdateContentProtectionPsshHelper(drm_uuid, pssh,
                                     &content_protection_elements_);
+  xml_dirty_ = true;
 }
 
 void Representation::AddNewSegment(int64_t start_time,
@@ -212,6 +214,7 @@ void Representation::AddNewSegment(int64_t start_time,
 
   SlideWindow();
   DCHECK_GE(segment_infos_.size(), 1u);
+  xml_dirty_ = true;
 }
 
 void Representation::SetSampleDuration(uint32_t frame_duration) {
@@ -219,6 +222,7 @@ void Representation::SetSampleDuration(uint32_t frame_duration) {
   // Text is required to have exactly the same segment duration.
   if (media_info_.has_audio_info() || media_info_.has_video_info())
     frame_duration_ = frame_duration;
+  xml_dirty_ = true;
 
   if (media_info_.has_video_info()) {
     media_info_.mutable_video_info()->set_frame_duration(frame_duration);
@@ -239,10 +243,11 @@ const MediaInfo& Representation::GetMediaInfo() const {
 // AddVideoInfo() (possibly adds FramePacking elements), AddAudioInfo() (Adds
 // AudioChannelConfig elements), AddContentProtectionElements*(), and
 // AddVODOnlyInfo() (Adds segment info).
-xml::scoped_xml_ptr<xmlNode> Representation::GetXml() {
+template <typename XmlElement>
+bool Representation::PopulateXml(XmlElement* representation) {
   if (!HasRequiredMediaInfoFields()) {
     LOG(ERROR) << "MediaInfo missing required fields.";
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
 
   const uint64_t bandwidth = media_info_.has_bandwidth()
@@ -251,57 +256,84 @@ xml::scoped_xml_ptr<xmlNode> Representation::GetXml() {
 
   DCHECK(!(HasVODOnlyFields(media_info_) && HasLiveOnlyFields(media_info_)));
 
-  xml::RepresentationXmlNode representation;
   // Mandatory fields for Representation.
-  representation.SetId(id_);
-  representation.SetIntegerAttribute("bandwidth", bandwidth);
+  representation->SetId(id_);
+  representation->SetIntegerAttribute("bandwidth", bandwidth);
   if (!codecs_.empty())
-    representation.SetStringAttribute("codecs", codecs_);
-  representation.SetStringAttribute("mimeType", mime_type_);
+    representation->SetStringAttribute("codecs", codecs_);
+  representation->SetStringAttribute("mimeType", mime_type_);
 
   const bool has_video_info = media_info_.has_video_info();
   const bool has_audio_info = media_info_.has_audio_info();
 
   if (has_video_info &&
-      !representation.AddVideoInfo(
+      !representation->AddVideoInfo(
           media_info_.video_info(),
           !(output_suppression_flags_ & kSuppressWidth),
           !(output_suppression_flags_ & kSuppressHeight),
           !(output_suppression_flags_ & kSuppressFrameRate))) {
     LOG(ERROR) << "Failed to add video info to Representation XML.";
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
 
   if (has_audio_info &&
-      !representation.AddAudioInfo(media_info_.audio_info())) {
+      !representation->AddAudioInfo(media_info_.audio_info())) {
     LOG(ERROR) << "Failed to add audio info to Representation XML.";
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
 
-  if (!representation.AddContentProtectionElements(
+  if (!representation->AddContentProtectionElements(
           content_protection_elements_)) {
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
 
   if (HasVODOnlyFields(media_info_) &&
-      !representation.AddVODOnlyInfo(media_info_)) {
+      !representation->AddVODOnlyInfo(media_info_)) {
     LOG(ERROR) << "Failed to add VOD info.";
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
 
   if (HasLiveOnlyFields(media_info_) &&
-      !representation.AddLiveOnlyInfo(media_info_, segment_infos_,
-                                      start_number_)) {
+      !representation->AddLiveOnlyInfo(media_info_, segment_infos_,
+                                       start_number_)) {
     LOG(ERROR) << "Failed to add Live info.";
-    return xml::scoped_xml_ptr<xmlNode>();
+    return false;
   }
   // TODO(rkuroiwa): It is likely that all representations have the exact same
   // SegmentTemplate. Optimize and propagate the tag up to AdaptationSet level.
 
   output_suppression_flags_ = 0;
+  return true;
+}
+
+xml::scoped_xml_ptr<xmlNode> Representation::GetXml() {
+  xml::RepresentationXmlNode representation;
+  if (!PopulateXml(&representation))
+    return xml::scoped_xml_ptr<xmlNode>();
   return representation.PassScopedPtr();
 }
 
+bool Representation::WriteXml(xml::XmlWriter* writer) {
+  // The suppression flags are set by the parent AdaptationSet, so they are
+  // part of the cached state.
+  if (output_suppression_flags_ != xml_cache_suppression_flags_) {
+    xml_cache_suppression_flags_ = output_suppression_flags_;
+    xml_dirty_ = true;
+  }
+  const bool result = writer->AddCachedElement(
+      xml_dirty_,
+      [this](xml::XmlWriter* fragment) {
+        fragment->StartElement("Representation");
+        const bool result = PopulateXml(fragment);
+        fragment->EndElement();
+        return result;
+      },
+      &xml_cache_);
+  output_suppression_flags_ = 0;
+  xml_dirty_ = !result;
+  return result;
+}
+
 void Representation::SuppressOnce(SuppressFlag flag) {
   output_suppression_flags_ |= flag;
 }
@@ -312,6 +344,7 @@ void Representation::SetPresentationTimeOffset(
   if (pto <= 0)
     return;
   media_info_.set_presentation_time_offset(pto);
+  xml_dirty_ = true;
 }
 
 bool Representation::GetStartAndEndTimestamps(
@@ -27,6 +27,7 @@ struct MpdOptions;
 namespace xml {
 class XmlNode;
 class RepresentationXmlNode;
+class XmlWriter;
 }  // namespace xml
 
 class RepresentationStateChangeListener {
@@ -118,7 +119,12 @@ class Representation {
   /// @return Copy of <Representation>.
   xml::scoped_xml_ptr<xmlNode> GetXml();
 
-  /// By calling this methods, the next time GetXml() is
+  /// Writes <Representation> to @a writer. It is the streaming equivalent of
+  /// GetXml().
+  /// @return true on success, false otherwise.
+  bool WriteXml(xml::XmlWriter* writer);
+
+  /// By calling this methods, the next time GetXml() or WriteXml() is
   /// called, the corresponding attributes will not be set.
   /// For example, if SuppressOnce(kSuppressWidth) is called, then GetXml() will
   /// return a <Representation> element without a @width attribute.
@@ -145,7 +151,10 @@ class Representation {
   /// @return ID number for <Representation>.
   uint32_t id() const { return id_; }
 
-  void set_media_info(const MediaInfo& media_info) { media_info_ = media_info; }
+  void set_media_info(const MediaInfo& media_info) {
+    media_info_ = media_info;
+    xml_dirty_ = true;
+  }
 
  protected:
   /// @param media_info is a MediaInfo containing information on the media.
@@ -176,6 +185,11 @@ class Representation {
   friend class AdaptationSet;
   friend class RepresentationTest;
 
+  // Populates the attributes and children of |representation|, which is an
+  // xml::RepresentationXmlNode or an xml::XmlWriter.
+  template <typename XmlElement>
+  bool PopulateXml(XmlElement* representation);
+
   // Returns true if |media_info_| has required fields to generate a valid
   // Representation. Otherwise returns false.
   bool HasRequiredMediaInfoFields() const;
@@ -235,6 +249,12 @@ class Representation {
   // Bit vector for tracking witch attributes should not be output.
   int output_suppression_flags_ = 0;
 
+  // Set when the XML of the Representation may have changed since it was last
+  // written to |xml_cache_|, with |xml_cache_suppression_flags_|.
+  bool xml_dirty_ = true;
+  std::unique_ptr<xml::XmlWriter> xml_cache_;
+  int xml_cache_suppression_flags_ = 0;
+
   // When set to true, allows segments to have slightly different durations (up
   // to one sample).
   const bool allow_approximate_segment_timeline_ = false;
@@ -7,7 +7,9 @@
 #include "packager/mpd/base/xml/xml_node.h"
 
 #include <gflags/gflags.h>
+#include <string.h>
 
+#include <algorithm>
 #include <limits>
 #include <set>
 
@@ -27,6 +29,7 @@ DEFINE_bool(segment_template_constant_duration,
 namespace shaka {
 
 using xml::XmlNode;
+using xml::XmlWriter;
 typedef MediaInfo::AudioInfo AudioInfo;
 typedef MediaInfo::VideoInfo VideoInfo;
 
@@ -66,14 +69,327 @@ bool IsTimelineConstantDuration(const std::list<SegmentInfo>& segment_infos,
   return expected_last_segment_start_time == last_segment.start_time;
 }
 
+// Sets the ContentProtection attributes of |element|, which is an XmlNode or
+// an XmlWriter.
+template <typename XmlElement>
+void SetContentProtectionAttributes(
+    const ContentProtectionElement& content_protection_element,
+    XmlElement* element) {
+  // @value is an optional attribute.
+  if (!content_protection_element.value.empty())
+    element->SetStringAttribute("value", content_protection_element.value);
+  element->SetStringAttribute("schemeIdUri",
+                              content_protection_element.scheme_id_uri);
+
+  for (const auto& attribute :
+       content_protection_element.additional_attributes) {
+    element->SetStringAttribute(attribute.first.c_str(), attribute.second);
+  }
+}
+
+template <typename XmlElement>
+bool SetVideoInfoAttributes(const VideoInfo& video_info,
+                            bool set_width,
+                            bool set_height,
+                            bool set_frame_rate,
+                            XmlElement* element) {
+  if (!video_info.has_width() || !video_info.has_height()) {
+    LOG(ERROR) << "Missing width or height for adding a video info.";
+    return false;
+  }
+
+  if (video_info.has_pixel_width() && video_info.has_pixel_height()) {
+    element->SetStringAttribute(
+        "sar", base::IntToString(video_info.pixel_width()) + ":" +
+                   base::IntToString(video_info.pixel_height()));
+  }
+
+  if (set_width)
+    element->SetIntegerAttribute("width", video_info.width());
+  if (set_height)
+    element->SetIntegerAttribute("height", video_info.height());
+  if (set_frame_rate) {
+    element->SetStringAttribute(
+        "frameRate", base::IntToString(video_info.time_scale()) + "/" +
+                         base::IntToString(video_info.frame_duration()));
+  }
+
+  if (video_info.has_playback_rate()) {
+    element->SetStringAttribute("maxPlayoutRate",
+                                base::IntToString(video_info.playback_rate()));
+    // Since the trick play stream contains only key frames, there is no coding
+    // dependency on the main stream. Simply set the codingDependency to false.
+    // TODO(hmchen): propagate this attribute up to the AdaptationSet, since
+    // all are set to false.
+    element->SetStringAttribute("codingDependency", "false");
+  }
+  return true;
+}
+
+// Sets the schemeIdUri and value of the AudioChannelConfiguration element.
+template <typename XmlElement>
+void SetAudioChannelConfigurationAttributes(const AudioInfo& audio_info,
+                                            XmlElement* element) {
+  std::string audio_channel_config_scheme;
+  std::string audio_channel_config_value;
+
+  if (audio_info.codec() == kEC3Codec) {
+    // Convert EC3 channel map into string of hexadecimal digits. Spec: DASH-IF
+    // Interoperability Points v3.0 9.2.1.2.
+    const uint16_t ec3_channel_map =
+        base::HostToNet16(audio_info.codec_specific_data().ec3_channel_map());
+    audio_channel_config_value =
+        base::HexEncode(&ec3_channel_map, sizeof(ec3_channel_map));
+    audio_channel_config_scheme =
+        "tag:dolby.com,2014:dash:audio_channel_configuration:2011";
+  } else {
+    audio_channel_config_value = base::UintToString(audio_info.num_channels());
+    audio_channel_config_scheme =
+        "urn:mpeg:dash:23003:3:audio_channel_configuration:2011";
+  }
+
+  element->SetStringAttribute("schemeIdUri", audio_channel_config_scheme);
+  element->SetStringAttribute("value", audio_channel_config_value);
+}
+
+// MPD expects one number for sampling frequency, or if it is a range it should
+// be space separated.
+template <typename XmlElement>
+void SetAudioSamplingRateAttribute(const AudioInfo& audio_info,
+                                   XmlElement* element) {
+  if (audio_info.has_sampling_frequency()) {
+    element->SetIntegerAttribute("audioSamplingRate",
+                                 audio_info.sampling_frequency());
+  }
+}
+
+template <typename XmlElement>
+void SetSegmentBaseAttributes(const MediaInfo& media_info,
+                              XmlElement* element) {
+  if (media_info.has_index_range()) {
+    element->SetStringAttribute("indexRange",
+                                RangeToString(media_info.index_range()));
+  }
+
+  if (media_info.has_reference_time_scale()) {
+    element->SetIntegerAttribute("timescale",
+                                 media_info.reference_time_scale());
+  }
+
+  if (media_info.has_presentation_time_offset()) {
+    element->SetIntegerAttribute("presentationTimeOffset",
+                                 media_info.presentation_time_offset());
+  }
+}
+
+// Sets the SegmentTemplate attributes. Returns true if a SegmentTimeline is
+// needed.
+template <typename XmlElement>
+bool SetSegmentTemplateAttributes(const MediaInfo& media_info,
+                                  const std::list<SegmentInfo>& segment_infos,
+                                  uint32_t start_number,
+                                  XmlElement* element) {
+  if (media_info.has_reference_time_scale()) {
+    element->SetIntegerAttribute("timescale",
+                                 media_info.reference_time_scale());
+  }
+
+  if (media_info.has_presentation_time_offset()) {
+    element->SetIntegerAttribute("presentationTimeOffset",
+                                 media_info.presentation_time_offset());
+  }
+
+  if (media_info.has_init_segment_url()) {
+    element->SetStringAttribute("initialization",
+                                media_info.init_segment_url());
+  }
+
+  if (media_info.has_segment_template_url()) {
+    element->SetStringAttribute("media", media_info.segment_template_url());
+    element->SetIntegerAttribute("startNumber", start_number);
+  }
+
+  if (segment_infos.empty())
+    return false;
+  // Don't use SegmentTimeline if all segments except the last one are of the
+  // same duration.
+  if (IsTimelineConstantDuration(segment_infos, start_number)) {
+    element->SetIntegerAttribute("duration", segment_infos.front().duration);
+    return false;
+  }
+  return true;
+}
+
+template <typename XmlElement>
+void SetSegmentTimelineEntryAttributes(const SegmentInfo& segment_info,
+                                       XmlElement* element) {
+  element->SetIntegerAttribute("t", segment_info.start_time);
+  element->SetIntegerAttribute("d", segment_info.duration);
+  if (segment_info.repeat > 0)
+    element->SetIntegerAttribute("r", segment_info.repeat);
+}
+
+// Appends |value| escaped as done by libxml2 for attribute values.
+void AppendEscapedAttribute(const std::string& value, std::string* output) {
+  for (const char c : value) {
+    switch (c) {
+      case '<':
+        output->append("&lt;");
+        break;
+      case '>':
+        output->append("&gt;");
+        break;
+      case '&':
+        output->append("&amp;");
+        break;
+      case '"':
+        output->append("&quot;");
+        break;
+      case '\n':
+        output->append("&#10;");
+        break;
+      case '\r':
+        output->append("&#13;");
+        break;
+      case '\t':
+        output->append("&#9;");
+        break;
+      default:
+        output->push_back(c);
+        break;
+    }
+  }
+}
+
+// Appends |text| escaped as done by libxml2 for text nodes.
+void AppendEscapedText(const char* text, size_t length, std::string* output) {
+  for (size_t i = 0; i < length; ++i) {
+    switch (text[i]) {
+      case '<':
+        output->append("&lt;");
+        break;
+      case '>':
+        output->append("&gt;");
+        break;
+      case '&':
+        output->append("&amp;");
+        break;
+      case '\r':
+        output->append("&#13;");
+        break;
+      default:
+        output->push_back(text[i]);
+        break;
+    }
+  }
+}
+
+void AppendUtf8(uint32_t code_point, std::string* output) {
+  if (code_point < 0x80) {
+    output->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    output->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    output->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    output->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+int HexDigitValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Appends the element content |content| as written by libxml2 after
+// xmlNodeSetContent(), which parses entity and character references in the
+// content: the predefined entities and the character references are decoded,
+// other entities are kept as references. Malformed references are handled as
+// libxml2 does.
+void AppendContent(const std::string& content, std::string* output) {
+  // The decoded text which has not been written yet.
+  std::string text;
+  const char* cur = content.c_str();
+  const char* q = cur;
+  while (*cur != '\0') {
+    if (*cur != '&') {
+      ++cur;
+      continue;
+    }
+    text.append(q, cur);
+    uint32_t code_point = 0;
+    if (cur[1] == '#') {
+      const bool hex = cur[2] == 'x';
+      const uint32_t base = hex ? 16 : 10;
+      cur += hex ? 3 : 2;
+      while (*cur != ';') {
+        const int digit =
+            hex ? HexDigitValue(*cur)
+                : (*cur >= '0' && *cur <= '9' ? *cur - '0' : -1);
+        if (digit < 0) {
+          code_point = 0;
+          break;
+        }
+        code_point = std::min<uint32_t>(code_point * base + digit, 0x110000);
+        ++cur;
+      }
+      if (*cur == ';')
+        ++cur;
+      q = cur;
+      if (code_point != 0 && code_point < 0x110000)
+        AppendUtf8(code_point, &text);
+      continue;
+    }
+
+    ++cur;
+    q = cur;
+    while (*cur != '\0' && *cur != ';')
+      ++cur;
+    if (*cur == '\0') {
+      // Unterminated entity reference. The pending text is dropped.
+      return;
+    }
+    const std::string name(q, cur);
+    if (name == "lt") {
+      text.push_back('<');
+    } else if (name == "gt") {
+      text.push_back('>');
+    } else if (name == "amp") {
+      text.push_back('&');
+    } else if (name == "apos") {
+      text.push_back('\'');
+    } else if (name == "quot") {
+      text.push_back('"');
+    } else if (!name.empty()) {
+      AppendEscapedText(text.data(), text.size(), output);
+      text.clear();
+      output->push_back('&');
+      output->append(name[0] == '&' ? name.substr(1) : name);
+      output->push_back(';');
+    }
+    ++cur;
+    q = cur;
+  }
+  text.append(q, cur);
+  AppendEscapedText(text.data(), text.size(), output);
+}
+
 bool PopulateSegmentTimeline(const std::list<SegmentInfo>& segment_infos,
                              XmlNode* segment_timeline) {
   for (const SegmentInfo& segment_info : segment_infos) {
     XmlNode s_element("S");
-    s_element.SetIntegerAttribute("t", segment_info.start_time);
-    s_element.SetIntegerAttribute("d", segment_info.duration);
-    if (segment_info.repeat > 0)
-      s_element.SetIntegerAttribute("r", segment_info.repeat);
+    SetSegmentTimelineEntryAttributes(segment_info, &s_element);
 
     CHECK(segment_timeline->AddChild(s_element.PassScopedPtr()));
   }
@@ -255,25 +571,8 @@ void RepresentationBaseXmlNode::AddEssentialProperty(
 bool RepresentationBaseXmlNode::AddContentProtectionElement(
     const ContentProtectionElement& content_protection_element) {
   XmlNode content_protection_node("ContentProtection");
-
-  // @value is an optional attribute.
-  if (!content_protection_element.value.empty()) {
-    content_protection_node.SetStringAttribute(
-        "value", content_protection_element.value);
-  }
-  content_protection_node.SetStringAttribute(
-      "schemeIdUri", content_protection_element.scheme_id_uri);
-
-  typedef std::map<std::string, std::string> AttributesMapType;
-  const AttributesMapType& additional_attributes =
-      content_protection_element.additional_attributes;
-
-  AttributesMapType::const_iterator attributes_it =
-      additional_attributes.begin();
-  for (; attributes_it != additional_attributes.end(); ++attributes_it) {
-    content_protection_node.SetStringAttribute(attributes_it->first.c_str(),
-                                               attributes_it->second);
-  }
+  SetContentProtectionAttributes(content_protection_element,
+                                 &content_protection_node);
 
   if (!content_protection_node.AddElements(
           content_protection_element.subelements)) {
@@ -302,37 +601,8 @@ bool RepresentationXmlNode::AddVideoInfo(const VideoInfo& video_info,
                                          bool set_width,
                                          bool set_height,
                                          bool set_frame_rate) {
-  if (!video_info.has_width() || !video_info.has_height()) {
-    LOG(ERROR) << "Missing width or height for adding a video info.";
-    return false;
-  }
-
-  if (video_info.has_pixel_width() && video_info.has_pixel_height()) {
-    SetStringAttribute("sar", base::IntToString(video_info.pixel_width()) +
-                                  ":" +
-                                  base::IntToString(video_info.pixel_height()));
-  }
-
-  if (set_width)
-    SetIntegerAttribute("width", video_info.width());
-  if (set_height)
-    SetIntegerAttribute("height", video_info.height());
-  if (set_frame_rate) {
-    SetStringAttribute("frameRate",
-                       base::IntToString(video_info.time_scale()) + "/" +
-                           base::IntToString(video_info.frame_duration()));
-  }
-
-  if (video_info.has_playback_rate()) {
-    SetStringAttribute("maxPlayoutRate",
-                       base::IntToString(video_info.playback_rate()));
-    // Since the trick play stream contains only key frames, there is no coding
-    // dependency on the main stream. Simply set the codingDependency to false.
-    // TODO(hmchen): propagate this attribute up to the AdaptationSet, since
-    // all are set to false.
-    SetStringAttribute("codingDependency", "false");
-  }
-  return true;
+  return SetVideoInfoAttributes(video_info, set_width, set_height,
+                                set_frame_rate, this);
 }
 
 bool RepresentationXmlNode::AddAudioInfo(const AudioInfo& audio_info) {
@@ -358,20 +628,7 @@ bool RepresentationXmlNode::AddVODOnlyInfo(const MediaInfo& media_info) {
 
   if (need_segment_base) {
     XmlNode segment_base("SegmentBase");
-    if (media_info.has_index_range()) {
-      segment_base.SetStringAttribute("indexRange",
-                                      RangeToString(media_info.index_range()));
-    }
-
-    if (media_info.has_reference_time_scale()) {
-      segment_base.SetIntegerAttribute("timescale",
-                                       media_info.reference_time_scale());
-    }
-
-    if (media_info.has_presentation_time_offset()) {
-      segment_base.SetIntegerAttribute("presentationTimeOffset",
-                                       media_info.presentation_time_offset());
-    }
+    SetSegmentBaseAttributes(media_info, &segment_base);
 
     if (media_info.has_init_range()) {
       XmlNode initialization("Initialization");
@@ -394,77 +651,290 @@ bool RepresentationXmlNode::AddLiveOnlyInfo(
     const std::list<SegmentInfo>& segment_infos,
     uint32_t start_number) {
   XmlNode segment_template("SegmentTemplate");
-  if (media_info.has_reference_time_scale()) {
-    segment_template.SetIntegerAttribute("timescale",
-                                         media_info.reference_time_scale());
+  if (SetSegmentTemplateAttributes(media_info, segment_infos, start_number,
+                                   &segment_template)) {
+    XmlNode segment_timeline("SegmentTimeline");
+    if (!PopulateSegmentTimeline(segment_infos, &segment_timeline) ||
+        !segment_template.AddChild(segment_timeline.PassScopedPtr())) {
+      return false;
+    }
   }
+  return AddChild(segment_template.PassScopedPtr());
+}
 
-  if (media_info.has_presentation_time_offset()) {
-    segment_template.SetIntegerAttribute("presentationTimeOffset",
-                                         media_info.presentation_time_offset());
+bool RepresentationXmlNode::AddAudioChannelInfo(const AudioInfo& audio_info) {
+  XmlNode audio_channel_config("AudioChannelConfiguration");
+  SetAudioChannelConfigurationAttributes(audio_info, &audio_channel_config);
+  return AddChild(audio_channel_config.PassScopedPtr());
+}
+
+void RepresentationXmlNode::AddAudioSamplingRateInfo(
+    const AudioInfo& audio_info) {
+  SetAudioSamplingRateAttribute(audio_info, this);
+}
+
+XmlWriter::XmlWriter(size_t level) : level_(level) {}
+XmlWriter::~XmlWriter() {}
+
+void XmlWriter::AddDeclaration() {
+  DCHECK(output_.empty());
+  DCHECK_EQ(0u, level_);
+  output_.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+}
+
+void XmlWriter::AddComment(const std::string& comment) {
+  DCHECK_EQ(0u, num_open_elements_);
+  output_.append("<!--");
+  output_.append(comment);
+  output_.append("-->\n");
+}
+
+void XmlWriter::StartElement(const char* name) {
+  DCHECK(name);
+  if (num_open_elements_ == 0) {
+    AppendIndent(level());
+  } else {
+    OpenElement* parent = current_element();
+    parent->has_children = true;
+    if (parent->indent_children)
+      AppendIndent(level());
   }
+  CollectNamespace(name);
+
+  if (num_open_elements_ == open_elements_.size())
+    open_elements_.emplace_back();
+  OpenElement* element = &open_elements_[num_open_elements_];
+  const bool indent_children =
+      num_open_elements_ == 0 || current_element()->indent_children;
+  ++num_open_elements_;
+  element->name = name;
+  element->start = output_.size();
+  element->attributes.clear();
+  element->has_content = false;
+  element->has_children = false;
+  element->indent_children = indent_children;
+}
 
-  if (media_info.has_init_segment_url()) {
-    segment_template.SetStringAttribute("initialization",
-                                        media_info.init_segment_url());
+void XmlWriter::EndElement() {
+  DCHECK_GT(num_open_elements_, 0u);
+  OpenElement* element = current_element();
+  --num_open_elements_;
+
+  std::string start_tag;
+  start_tag.reserve(element->name.size() + element->attributes.size() + 4);
+  start_tag.push_back('<');
+  start_tag.append(element->name);
+  start_tag.append(element->attributes);
+  if (element->has_children) {
+    start_tag.push_back('>');
+    if (element->indent_children)
+      start_tag.push_back('\n');
+    output_.insert(element->start, start_tag);
+    if (element->indent_children)
+      AppendIndent(level());
+    output_.append("</");
+    output_.append(element->name);
+    output_.push_back('>');
+  } else {
+    start_tag.append("/>");
+    output_.insert(element->start, start_tag);
   }
 
-  if (media_info.has_segment_template_url()) {
-    segment_template.SetStringAttribute("media",
-                                        media_info.segment_template_url());
-    segment_template.SetIntegerAttribute("startNumber", start_number);
-  }
-
-  if (!segment_infos.empty()) {
-    // Don't use SegmentTimeline if all segments except the last one are of
-    // the same duration.
-    if (IsTimelineConstantDuration(segment_infos, start_number)) {
-      segment_template.SetIntegerAttribute("duration",
-                                           segment_infos.front().duration);
-    } else {
-      XmlNode segment_timeline("SegmentTimeline");
-      if (!PopulateSegmentTimeline(segment_infos, &segment_timeline) ||
-          !segment_template.AddChild(segment_timeline.PassScopedPtr())) {
-        return false;
-      }
-    }
+  if (num_open_elements_ == 0 || current_element()->indent_children)
+    output_.push_back('\n');
+}
+
+void XmlWriter::AddFragment(const XmlWriter& fragment) {
+  DCHECK_EQ(0u, fragment.num_open_elements_);
+  DCHECK_EQ(level(), fragment.level_);
+  if (num_open_elements_ > 0) {
+    OpenElement* parent = current_element();
+    DCHECK(parent->indent_children);
+    parent->has_children = true;
   }
-  return AddChild(segment_template.PassScopedPtr());
+  output_.append(fragment.output_);
+  referenced_namespaces_.insert(fragment.referenced_namespaces_.begin(),
+                                fragment.referenced_namespaces_.end());
 }
 
-bool RepresentationXmlNode::AddAudioChannelInfo(const AudioInfo& audio_info) {
-  std::string audio_channel_config_scheme;
-  std::string audio_channel_config_value;
+bool XmlWriter::AddElements(const std::vector<Element>& elements) {
+  for (const Element& element : elements) {
+    StartElement(element.name.c_str());
+    for (const auto& attribute : element.attributes)
+      SetStringAttribute(attribute.first.c_str(), attribute.second);
+    SetContent(element.content);
+    AddElements(element.subelements);
+    EndElement();
+  }
+  return true;
+}
 
-  if (audio_info.codec() == kEC3Codec) {
-    // Convert EC3 channel map into string of hexadecimal digits. Spec: DASH-IF
-    // Interoperability Points v3.0 9.2.1.2.
-    const uint16_t ec3_channel_map =
-        base::HostToNet16(audio_info.codec_specific_data().ec3_channel_map());
-    audio_channel_config_value =
-        base::HexEncode(&ec3_channel_map, sizeof(ec3_channel_map));
-    audio_channel_config_scheme =
-        "tag:dolby.com,2014:dash:audio_channel_configuration:2011";
-  } else {
-    audio_channel_config_value = base::UintToString(audio_info.num_channels());
-    audio_channel_config_scheme =
-        "urn:mpeg:dash:23003:3:audio_channel_configuration:2011";
+void XmlWriter::SetStringAttribute(const char* attribute_name,
+                                   const std::string& attribute) {
+  DCHECK(attribute_name);
+  CollectNamespace(attribute_name);
+  std::string* attributes = &current_element()->attributes;
+  // As with xmlSetProp(), an existing attribute keeps its position. The
+  // values are escaped so the search cannot match inside a value.
+  const std::string prefix = std::string(" ") + attribute_name + "=\"";
+  const size_t pos = attributes->find(prefix);
+  if (pos != std::string::npos) {
+    const size_t value_start = pos + prefix.size();
+    const size_t value_end = attributes->find('"', value_start);
+    std::string value;
+    AppendEscapedAttribute(attribute, &value);
+    attributes->replace(value_start, value_end - value_start, value);
+    return;
   }
+  attributes->append(prefix);
+  AppendEscapedAttribute(attribute, attributes);
+  attributes->push_back('"');
+}
 
-  XmlNode audio_channel_config("AudioChannelConfiguration");
-  audio_channel_config.SetStringAttribute("schemeIdUri",
-                                          audio_channel_config_scheme);
-  audio_channel_config.SetStringAttribute("value", audio_channel_config_value);
+void XmlWriter::SetIntegerAttribute(const char* attribute_name,
+                                    uint64_t number) {
+  SetStringAttribute(attribute_name, base::Uint64ToString(number));
+}
 
-  return AddChild(audio_channel_config.PassScopedPtr());
+void XmlWriter::SetFloatingPointAttribute(const char* attribute_name,
+                                          double number) {
+  SetStringAttribute(attribute_name, base::DoubleToString(number));
 }
 
-// MPD expects one number for sampling frequency, or if it is a range it should
-// be space separated.
-void RepresentationXmlNode::AddAudioSamplingRateInfo(
-    const AudioInfo& audio_info) {
-  if (audio_info.has_sampling_frequency())
-    SetIntegerAttribute("audioSamplingRate", audio_info.sampling_frequency());
+void XmlWriter::SetId(uint32_t id) {
+  SetIntegerAttribute("id", id);
+}
+
+void XmlWriter::SetContent(const std::string& content) {
+  OpenElement* element = current_element();
+  DCHECK(!element->has_children) << "Content must be set before children.";
+  const size_t size = output_.size();
+  AppendContent(content, &output_);
+  if (output_.size() > size) {
+    element->has_content = true;
+    element->has_children = true;
+    // libxml2 does not format the children of elements with text.
+    element->indent_children = false;
+  }
+}
+
+bool XmlWriter::AddContentProtectionElements(
+    const std::list<ContentProtectionElement>& content_protection_elements) {
+  for (const ContentProtectionElement& element : content_protection_elements)
+    AddContentProtectionElement(element);
+  return true;
+}
+
+void XmlWriter::AddSupplementalProperty(const std::string& scheme_id_uri,
+                                        const std::string& value) {
+  StartElement("SupplementalProperty");
+  SetStringAttribute("schemeIdUri", scheme_id_uri);
+  SetStringAttribute("value", value);
+  EndElement();
+}
+
+void XmlWriter::AddEssentialProperty(const std::string& scheme_id_uri,
+                                     const std::string& value) {
+  StartElement("EssentialProperty");
+  SetStringAttribute("schemeIdUri", scheme_id_uri);
+  SetStringAttribute("value", value);
+  EndElement();
+}
+
+void XmlWriter::AddRoleElement(const std::string& scheme_id_uri,
+                               const std::string& value) {
+  StartElement("Role");
+  SetStringAttribute("schemeIdUri", scheme_id_uri);
+  SetStringAttribute("value", value);
+  EndElement();
+}
+
+bool XmlWriter::AddVideoInfo(const VideoInfo& video_info,
+                             bool set_width,
+                             bool set_height,
+                             bool set_frame_rate) {
+  return SetVideoInfoAttributes(video_info, set_width, set_height,
+                                set_frame_rate, this);
+}
+
+bool XmlWriter::AddAudioInfo(const AudioInfo& audio_info) {
+  AddAudioChannelInfo(audio_info);
+  SetAudioSamplingRateAttribute(audio_info, this);
+  return true;
+}
+
+bool XmlWriter::AddVODOnlyInfo(const MediaInfo& media_info) {
+  if (media_info.has_media_file_url()) {
+    StartElement("BaseURL");
+    SetContent(media_info.media_file_url());
+    EndElement();
+  }
+
+  const bool need_segment_base = media_info.has_index_range() ||
+                                 media_info.has_init_range() ||
+                                 media_info.has_reference_time_scale();
+
+  if (need_segment_base) {
+    StartElement("SegmentBase");
+    SetSegmentBaseAttributes(media_info, this);
+    if (media_info.has_init_range()) {
+      StartElement("Initialization");
+      SetStringAttribute("range", RangeToString(media_info.init_range()));
+      EndElement();
+    }
+    EndElement();
+  }
+
+  return true;
+}
+
+bool XmlWriter::AddLiveOnlyInfo(const MediaInfo& media_info,
+                                const std::list<SegmentInfo>& segment_infos,
+                                uint32_t start_number) {
+  StartElement("SegmentTemplate");
+  if (SetSegmentTemplateAttributes(media_info, segment_infos, start_number,
+                                   this)) {
+    StartElement("SegmentTimeline");
+    for (const SegmentInfo& segment_info : segment_infos) {
+      StartElement("S");
+      SetSegmentTimelineEntryAttributes(segment_info, this);
+      EndElement();
+    }
+    EndElement();
+  }
+  EndElement();
+  return true;
+}
+
+void XmlWriter::AppendIndent(size_t level) {
+  // libxml2 limits the indentation to 30 levels.
+  const size_t kMaxIndentLevel = 30;
+  output_.append(2 * std::min(level, kMaxIndentLevel), ' ');
+}
+
+void XmlWriter::CollectNamespace(const char* name) {
+  const char* colon = strchr(name, ':');
+  if (colon)
+    referenced_namespaces_.emplace(name, colon - name);
+}
+
+XmlWriter::OpenElement* XmlWriter::current_element() {
+  DCHECK_GT(num_open_elements_, 0u);
+  return &open_elements_[num_open_elements_ - 1];
+}
+
+void XmlWriter::AddContentProtectionElement(
+    const ContentProtectionElement& content_protection_element) {
+  StartElement("ContentProtection");
+  SetContentProtectionAttributes(content_protection_element, this);
+  AddElements(content_protection_element.subelements);
+  EndElement();
+}
+
+void XmlWriter::AddAudioChannelInfo(const AudioInfo& audio_info) {
+  StartElement("AudioChannelConfiguration");
+  SetAudioChannelConfigurationAttributes(audio_info, this);
+  EndElement();
 }
 
 }  // namespace xml
@@ -6,6 +6,7 @@
 //
 // Classes to wrap XML operations. XmlNode is a generic wrapper class for
 // XmlNode in libxml2. There are also MPD XML specific classes as well.
+// XmlWriter writes the same XML directly to a string.
 
 #ifndef MPD_BASE_XML_XML_NODE_H_
 #define MPD_BASE_XML_XML_NODE_H_
@@ -14,7 +15,10 @@
 #include <stdint.h>
 
 #include <list>
+#include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "packager/base/macros.h"
 #include "packager/mpd/base/content_protection_element.h"
@@ -186,6 +190,146 @@ class RepresentationXmlNode : public RepresentationBaseXmlNode {
   DISALLOW_COPY_AND_ASSIGN(RepresentationXmlNode);
 };
 
+/// Writes XML directly to a string, without building a libxml2 tree. The
+/// output is identical to the output of libxml2 for the equivalent XmlNode
+/// tree, dumped with formatting as done by MpdBuilder.
+/// Elements are written in document order: StartElement() opens a child
+/// element of the current element, which is closed by EndElement(). As with
+/// XmlNode, the attributes of an element can be set after adding children.
+/// The other methods have the same semantics as the XmlNode methods of the
+/// same names, applied to the current element.
+/// An XmlWriter can also hold a fragment of a document, i.e. elements written
+/// at a given indentation level, to be added to another XmlWriter with
+/// AddFragment(). This allows caching the XML of unchanged elements.
+class XmlWriter {
+ public:
+  /// @param level is the indentation level of the top level elements. It is
+  ///        0 for a document and the level of the parent element plus 1 for a
+  ///        fragment.
+  explicit XmlWriter(size_t level = 0);
+  ~XmlWriter();
+
+  /// Adds the XML declaration. It must be added before anything else.
+  void AddDeclaration();
+
+  /// Adds a comment. Comments can only be added outside of the elements.
+  /// @param comment is the text of the comment.
+  void AddComment(const std::string& comment);
+
+  /// Opens an element, as a child of the current element if there is one.
+  /// @param name is the name of the element, which should not be NULL.
+  void StartElement(const char* name);
+
+  /// Closes the current element.
+  void EndElement();
+
+  /// Adds the elements written to @a fragment as children of the current
+  /// element. @a fragment must have been created with the level returned by
+  /// level() and all its elements must have been closed.
+  void AddFragment(const XmlWriter& fragment);
+
+  /// Adds an element from @a cache, which holds the element as previously
+  /// written, if any. If @a dirty is set or if the element was written at
+  /// another level, the element is written to a new @a cache first.
+  /// @param dirty indicates if the element has changed since it was cached.
+  /// @param write_element is called with the XmlWriter to write the element
+  ///        to. It returns true on success and false otherwise.
+  /// @param cache holds the cached element.
+  /// @return true on success, false if @a write_element fails.
+  template <typename WriteElement>
+  bool AddCachedElement(bool dirty,
+                        WriteElement write_element,
+                        std::unique_ptr<XmlWriter>* cache) {
+    if (dirty || !*cache || (*cache)->level_ != level()) {
+      cache->reset(new XmlWriter(level()));
+      if (!write_element(cache->get())) {
+        cache->reset();
+        return false;
+      }
+    }
+    AddFragment(**cache);
+    return true;
+  }
+
+  /// @return the indentation level of a child element of the current element.
+  size_t level() const { return level_ + num_open_elements_; }
+
+  /// @name Same as the XmlNode methods.
+  /// @{
+  bool AddElements(const std::vector<Element>& elements);
+  void SetStringAttribute(const char* attribute_name,
+                          const std::string& attribute);
+  void SetIntegerAttribute(const char* attribute_name, uint64_t number);
+  void SetFloatingPointAttribute(const char* attribute_name, double number);
+  void SetId(uint32_t id);
+  /// This must be called before adding children to the current element.
+  void SetContent(const std::string& content);
+  /// @}
+
+  /// @name Same as the RepresentationBaseXmlNode, AdaptationSetXmlNode and
+  ///       RepresentationXmlNode methods.
+  /// @{
+  bool AddContentProtectionElements(
+      const std::list<ContentProtectionElement>& content_protection_elements);
+  void AddSupplementalProperty(const std::string& scheme_id_uri,
+                               const std::string& value);
+  void AddEssentialProperty(const std::string& scheme_id_uri,
+                            const std::string& value);
+  void AddRoleElement(const std::string& scheme_id_uri,
+                      const std::string& value);
+  bool AddVideoInfo(const MediaInfo::VideoInfo& video_info,
+                    bool set_width,
+                    bool set_height,
+                    bool set_frame_rate);
+  bool AddAudioInfo(const MediaInfo::AudioInfo& audio_info);
+  bool AddVODOnlyInfo(const MediaInfo& media_info);
+  bool AddLiveOnlyInfo(const MediaInfo& media_info,
+                       const std::list<SegmentInfo>& segment_infos,
+                       uint32_t start_number);
+  /// @}
+
+  /// @return namespaces used in the elements written so far.
+  const std::set<std::string>& referenced_namespaces() const {
+    return referenced_namespaces_;
+  }
+
+  /// @return the XML written so far. All the elements must have been closed.
+  const std::string& output() const { return output_; }
+
+ private:
+  struct OpenElement {
+    std::string name;
+    // Offset of the start tag in |output_|. The start tag is inserted when
+    // the element is closed, as attributes can be set after the children.
+    size_t start = 0;
+    // The serialized attributes.
+    std::string attributes;
+    bool has_content = false;
+    bool has_children = false;
+    // Whether the children are indented, which libxml2 does only if the
+    // element and its ancestors have no text content.
+    bool indent_children = true;
+  };
+
+  void AppendIndent(size_t level);
+  void CollectNamespace(const char* name);
+  OpenElement* current_element();
+
+  void AddContentProtectionElement(
+      const ContentProtectionElement& content_protection_element);
+  void AddAudioChannelInfo(const MediaInfo::AudioInfo& audio_info);
+
+  const size_t level_;
+  std::string output_;
+  // The open elements, from the root. The entries past |num_open_elements_|
+  // are kept for reuse.
+  std::vector<OpenElement> open_elements_;
+  size_t num_open_elements_ = 0;
+  std::set<std::string> referenced_namespaces_;
+
+  DISALLOW_COPY_AND_ASSIGN(XmlWriter);
+};
+
 }  // namespace xml
 }  // namespace shaka
 #endif  // MPD_BASE_XML_XML_NODE_H_
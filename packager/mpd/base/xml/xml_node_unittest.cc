@@ -38,6 +38,18 @@ void AddAttribute(const std::string& name,
   attribute->set_value(value);
 }
 
+// Dumps |node| in a document as done by MpdBuilder.
+std::string DumpWithLibXml(XmlNode* node) {
+  scoped_xml_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST "1.0"));
+  xmlDocSetRootElement(doc.get(), node->Release());
+  int doc_str_size = 0;
+  xmlChar* doc_str = nullptr;
+  xmlDocDumpFormatMemoryEnc(doc.get(), &doc_str, &doc_str_size, "UTF-8", 1);
+  std::string output(doc_str, doc_str + doc_str_size);
+  xmlFree(doc_str);
+  return output;
+}
+
 }  // namespace
 
 // Make sure XmlEqual() is functioning correctly.
@@ -397,5 +409,200 @@ TEST_F(LiveSegmentTimelineTest, TwoSegmentInfoWithGap) {
                   "</Representation>"));
 }
 
+// Verify that XmlWriter writes the same XML as libxml2 does, including when
+// the attributes are set after the children and for element content.
+TEST(XmlWriterTest, MatchesLibXml) {
+  const char kContent[] = "a&amp;b<c>&#x41;&#66;&unknown;\r\n";
+  Element sub_element;
+  sub_element.name = "Sub";
+  sub_element.attributes["x"] = "1";
+  Element element;
+  element.name = "WithContent";
+  element.content = "text";
+  element.subelements.push_back(sub_element);
+
+  XmlNode root("Root");
+  XmlNode child("Child");
+  XmlNode grandchild("Grandchild");
+  grandchild.SetStringAttribute("quoted", "\"<&>\"\t\n");
+  child.AddChild(grandchild.PassScopedPtr());
+  child.SetIntegerAttribute("late", 1);
+  root.AddChild(child.PassScopedPtr());
+  XmlNode text("Text");
+  text.SetContent(kContent);
+  root.AddChild(text.PassScopedPtr());
+  XmlNode empty_text("EmptyText");
+  empty_text.SetContent("");
+  root.AddChild(empty_text.PassScopedPtr());
+  ASSERT_TRUE(root.AddElements({element}));
+  root.SetFloatingPointAttribute("float", 1.5);
+  root.SetStringAttribute("float", "replaced");
+
+  XmlWriter writer;
+  writer.AddDeclaration();
+  writer.StartElement("Root");
+  writer.StartElement("Child");
+  writer.StartElement("Grandchild");
+  writer.SetStringAttribute("quoted", "\"<&>\"\t\n");
+  writer.EndElement();
+  writer.SetIntegerAttribute("late", 1);
+  writer.EndElement();
+  writer.StartElement("Text");
+  writer.SetContent(kContent);
+  writer.EndElement();
+  writer.StartElement("EmptyText");
+  writer.SetContent("");
+  writer.EndElement();
+  ASSERT_TRUE(writer.AddElements({element}));
+  writer.SetFloatingPointAttribute("float", 1.5);
+  writer.SetStringAttribute("float", "replaced");
+  writer.EndElement();
+
+  EXPECT_EQ(DumpWithLibXml(&root), writer.output());
+}
+
+TEST(XmlWriterTest, Comment) {
+  XmlWriter writer;
+  writer.AddDeclaration();
+  writer.AddComment("comment");
+  writer.StartElement("MPD");
+  writer.EndElement();
+  EXPECT_EQ(
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<!--comment-->\n"
+      "<MPD/>\n",
+      writer.output());
+}
+
+TEST(XmlWriterTest, ReferencedNamespaces) {
+  XmlWriter writer;
+  writer.StartElement("MPD");
+  writer.StartElement("cenc:pssh");
+  writer.SetStringAttribute("xlink:href", "foo");
+  writer.EndElement();
+  writer.EndElement();
+  EXPECT_THAT(writer.referenced_namespaces(), ElementsAre("cenc", "xlink"));
+}
+
+// Verify that cached fragments are reused while not dirty and are written at
+// the indentation of the element they are added to.
+TEST(XmlWriterTest, CachedElement) {
+  std::unique_ptr<XmlWriter> cache;
+  int num_writes = 0;
+  auto write_child = [&num_writes](XmlWriter* writer) {
+    ++num_writes;
+    writer->StartElement("Child");
+    writer->StartElement("cenc:pssh");
+    writer->EndElement();
+    writer->EndElement();
+    return true;
+  };
+
+  XmlWriter writer;
+  writer.StartElement("Root");
+  ASSERT_TRUE(writer.AddCachedElement(true, write_child, &cache));
+  ASSERT_TRUE(writer.AddCachedElement(false, write_child, &cache));
+  EXPECT_EQ(1, num_writes);
+  // The fragment is written again when it is added at another level.
+  writer.StartElement("Nested");
+  ASSERT_TRUE(writer.AddCachedElement(false, write_child, &cache));
+  writer.EndElement();
+  writer.EndElement();
+  EXPECT_EQ(2, num_writes);
+
+  EXPECT_EQ(
+      "<Root>\n"
+      "  <Child>\n"
+      "    <cenc:pssh/>\n"
+      "  </Child>\n"
+      "  <Child>\n"
+      "    <cenc:pssh/>\n"
+      "  </Child>\n"
+      "  <Nested>\n"
+      "    <Child>\n"
+      "      <cenc:pssh/>\n"
+      "    </Child>\n"
+      "  </Nested>\n"
+      "</Root>\n",
+      writer.output());
+  EXPECT_THAT(writer.referenced_namespaces(), ElementsAre("cenc"));
+
+  // A failed write is not cached.
+  XmlWriter failed_writer;
+  failed_writer.StartElement("Root");
+  EXPECT_FALSE(failed_writer.AddCachedElement(
+      true, [](XmlWriter* writer) { return false; }, &cache));
+  EXPECT_FALSE(cache);
+}
+
+// Verify that the MPD specific methods of XmlWriter match the ones of
+// RepresentationXmlNode.
+TEST(XmlWriterTest, RepresentationMatchesLibXml) {
+  MediaInfo media_info;
+  media_info.set_media_file_url("media.mp4");
+  media_info.mutable_index_range()->set_begin(121);
+  media_info.mutable_index_range()->set_end(221);
+  media_info.mutable_init_range()->set_begin(0);
+  media_info.mutable_init_range()->set_end(120);
+  media_info.set_reference_time_scale(90000);
+  media_info.set_presentation_time_offset(200);
+  media_info.set_init_segment_url("init.mp4");
+  media_info.set_segment_template_url("$Number$.mp4");
+
+  MediaInfo::VideoInfo video_info;
+  video_info.set_width(1280);
+  video_info.set_height(720);
+  video_info.set_pixel_width(1);
+  video_info.set_pixel_height(1);
+  video_info.set_time_scale(30000);
+  video_info.set_frame_duration(1001);
+  video_info.set_playback_rate(4);
+
+  MediaInfo::AudioInfo audio_info;
+  audio_info.set_codec("ec-3");
+  audio_info.set_sampling_frequency(48000);
+  audio_info.mutable_codec_specific_data()->set_ec3_channel_map(0xF801);
+
+  const std::list<SegmentInfo> segment_infos = {
+      {0, 100, 2}, {300, 50, 0},
+  };
+
+  ContentProtectionElement content_protection;
+  content_protection.value = "cenc";
+  content_protection.scheme_id_uri = "urn:mpeg:dash:mp4protection:2011";
+  content_protection.additional_attributes["cenc:default_KID"] = "kid";
+  Element pssh;
+  pssh.name = "cenc:pssh";
+  pssh.content = "AAAAAA==";
+  content_protection.subelements.push_back(pssh);
+  const std::list<ContentProtectionElement> content_protections = {
+      content_protection};
+
+  RepresentationXmlNode representation;
+  representation.SetId(1);
+  ASSERT_TRUE(representation.AddContentProtectionElements(content_protections));
+  representation.AddSupplementalProperty("supplemental", "1");
+  representation.AddEssentialProperty("essential", "2");
+  ASSERT_TRUE(representation.AddVideoInfo(video_info, true, true, true));
+  ASSERT_TRUE(representation.AddAudioInfo(audio_info));
+  ASSERT_TRUE(representation.AddVODOnlyInfo(media_info));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info, segment_infos, 1));
+
+  XmlWriter writer;
+  writer.AddDeclaration();
+  writer.StartElement("Representation");
+  writer.SetId(1);
+  ASSERT_TRUE(writer.AddContentProtectionElements(content_protections));
+  writer.AddSupplementalProperty("supplemental", "1");
+  writer.AddEssentialProperty("essential", "2");
+  ASSERT_TRUE(writer.AddVideoInfo(video_info, true, true, true));
+  ASSERT_TRUE(writer.AddAudioInfo(audio_info));
+  ASSERT_TRUE(writer.AddVODOnlyInfo(media_info));
+  ASSERT_TRUE(writer.AddLiveOnlyInfo(media_info, segment_infos, 1));
+  writer.EndElement();
+
+  EXPECT_EQ(DumpWithLibXml(&representation), writer.output());
+}
+
 }  // namespace xml
 }  // namespace shaka
@@ -44,6 +44,7 @@
 #include "packager/media/formats/webvtt/webvtt_parser.h"
 #include "packager/media/formats/webvtt/webvtt_text_output_handler.h"
 #include "packager/media/formats/webvtt/webvtt_to_mp4_handler.h"
+#include "packager/media/origin/async_handler.h"
 #include "packager/media/replicator/replicator.h"
 #include "packager/media/trick_play/trick_play_handler.h"
 #include "packager/mpd/base/media_info.pb.h"
@@ -79,6 +80,7 @@ MuxerOptions CreateMuxerOptions(const StreamDescriptor& stream,
   options.bandwidth = stream.bandwidth;
   options.output_file_name = stream.output;
   options.segment_template = stream.segment_template;
+  options.udp_output = stream.udp_output;
 
   return options;
 }
@@ -243,6 +245,18 @@ Status ValidateStreamDescriptor(bool dump_stream_info,
     }
   }
 
+  if (!stream.udp_output.empty()) {
+    if (output_format != CONTAINER_MPEG2TS) {
+      return Status(error::INVALID_ARGUMENT,
+                    "'udp_output' is only supported for MPEG2-TS output.");
+    }
+    if (!base::StartsWith(stream.udp_output, kUdpFilePrefix,
+                          base::CompareCase::SENSITIVE)) {
+      return Status(error::INVALID_ARGUMENT,
+                    "'udp_output' must be of the form udp://ip:port.");
+    }
+  }
+
   if (stream.output.find('$') != std::string::npos) {
     if (output_format == CONTAINER_WEBVTT) {
       return Status(
@@ -443,6 +457,22 @@ std::shared_ptr<MediaHandler> CreateEncryptionHandler(
   return std::make_shared<EncryptionHandler>(encryption_params, key_source);
 }
 
+// Creates an asynchronous edge, which is run as its own job, if asynchronous
+// pipeline is enabled. Returns nullptr otherwise, which is skipped in
+// MediaHandler::Chain.
+std::shared_ptr<MediaHandler> CreateAsyncHandler(
+    const PackagingParams& packaging_params,
+    const std::string& job_name,
+    JobManager* job_manager) {
+  if (!packaging_params.async_pipeline)
+    return nullptr;
+  // Limits the number of stream data in flight on every asynchronous edge.
+  const size_t kAsyncQueueCapacity = 32;
+  auto handler = std::make_shared<AsyncHandler>(kAsyncQueueCapacity);
+  job_manager->Add(job_name, handler);
+  return handler;
+}
+
 std::unique_ptr<TextChunker> CreateTextChunker(
     const ChunkingParams& chunking_params) {
   const float segment_length_in_seconds =
@@ -637,6 +667,17 @@ Status CreateTextJobs(
   return Status::OK;
 }
 
+// Returns the key of the demuxer reading |stream|. Streams from the same input
+// share a demuxer, unless every stream of a local input is demuxed on its own.
+std::string GetDemuxerKey(const StreamDescriptor& stream,
+                          const PackagingParams& packaging_params) {
+  if (packaging_params.parallel_demuxing &&
+      File::IsLocalRegularFile(stream.input.c_str())) {
+    return stream.input + ":" + stream.stream_selector;
+  }
+  return stream.input;
+}
+
 Status CreateAudioVideoJobs(
     const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
     const PackagingParams& packaging_params,
@@ -655,14 +696,14 @@ Status CreateAudioVideoJobs(
   std::map<std::string, std::shared_ptr<MediaHandler>> cue_aligners;
 
   for (const StreamDescriptor& stream : streams) {
-    bool seen_input_before = sources.find(stream.input) != sources.end();
+    const std::string key = GetDemuxerKey(stream, packaging_params);
+    bool seen_input_before = sources.find(key) != sources.end();
     if (seen_input_before) {
       continue;
     }
 
-    RETURN_IF_ERROR(
-        CreateDemuxer(stream, packaging_params, &sources[stream.input]));
-    cue_aligners[stream.input] =
+    RETURN_IF_ERROR(CreateDemuxer(stream, packaging_params, &sources[key]));
+    cue_aligners[key] =
         sync_points ? std::make_shared<CueAlignmentHandler>(sync_points)
                     : nullptr;
   }
@@ -680,8 +721,9 @@ Status CreateAudioVideoJobs(
 
   for (const StreamDescriptor& stream : streams) {
     // Get the demuxer for this stream.
-    auto& demuxer = sources[stream.input];
-    auto& cue_aligner = cue_aligners[stream.input];
+    const std::string key = GetDemuxerKey(stream, packaging_params);
+    auto& demuxer = sources[key];
+    auto& cue_aligner = cue_aligners[key];
 
     const bool new_input_file = stream.input != previous_input;
     const bool new_stream =
@@ -709,15 +751,24 @@ Status CreateAudioVideoJobs(
       auto encryptor = CreateEncryptionHandler(packaging_params, stream,
                                                encryption_key_source);
 
+      // Cue aligner is shared by all the streams from the same input, so the
+      // asynchronous edge, if any, goes after it.
+      auto async_handler =
+          CreateAsyncHandler(packaging_params, "StreamJob", job_manager);
+
       // TODO(vaage) : Create a nicer way to connect handlers to demuxers.
       if (sync_points) {
-        RETURN_IF_ERROR(
-            MediaHandler::Chain({cue_aligner, chunker, encryptor, replicator}));
+        RETURN_IF_ERROR(MediaHandler::Chain(
+            {cue_aligner, async_handler, chunker, encryptor, replicator}));
         RETURN_IF_ERROR(
             demuxer->SetHandler(stream.stream_selector, cue_aligner));
       } else {
-        RETURN_IF_ERROR(MediaHandler::Chain({chunker, encryptor, replicator}));
-        RETURN_IF_ERROR(demuxer->SetHandler(stream.stream_selector, chunker));
+        RETURN_IF_ERROR(MediaHandler::Chain(
+            {async_handler, chunker, encryptor, replicator}));
+        RETURN_IF_ERROR(demuxer->SetHandler(
+            stream.stream_selector,
+            async_handler ? async_handler
+                          : std::shared_ptr<MediaHandler>(chunker)));
       }
     }
 
@@ -740,7 +791,11 @@ Status CreateAudioVideoJobs(
             ? std::make_shared<TrickPlayHandler>(stream.trick_play_factor)
             : nullptr;
 
-    RETURN_IF_ERROR(MediaHandler::Chain({replicator, trick_play, muxer}));
+    std::shared_ptr<MediaHandler> async_handler =
+        CreateAsyncHandler(packaging_params, "OutputJob", job_manager);
+
+    RETURN_IF_ERROR(
+        MediaHandler::Chain({replicator, async_handler, trick_play, muxer}));
   }
 
   return Status::OK;
@@ -911,7 +966,14 @@ Status Packager::Initialize(
     sync_points.reset(
         new SyncPointQueue(packaging_params.ad_cue_generator_params));
   }
-  internal->job_manager.reset(new JobManager(std::move(sync_points)));
+  // Jobs connected through asynchronous edges wait for each other, so each
+  // of them needs a worker of its own, which is what 0 means to JobManager.
+  // Jobs also get a worker each by default, as a job reading a live input
+  // blocks its worker until data arrives.
+  const size_t max_num_workers =
+      packaging_params.async_pipeline ? 0 : packaging_params.max_num_workers;
+  internal->job_manager.reset(
+      new JobManager(std::move(sync_points), max_num_workers));
 
   std::vector<StreamDescriptor> streams_for_jobs;
 
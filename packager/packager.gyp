@@ -22,6 +22,8 @@
         'app/libcrypto_threading.h',
         'app/packager_util.cc',
         'app/packager_util.h',
+        'app/work_stealing_executor.cc',
+        'app/work_stealing_executor.h',
         'packager.cc',
         'packager.h',
       ],
@@ -138,6 +140,32 @@
         'testing/gtest.gyp:gtest_main',
       ],
     },
+    {
+      'target_name': 'packager_benchmarks',
+      'type': 'executable',
+      'sources': [
+        'benchmarks/benchmark.cc',
+        'benchmarks/benchmark.h',
+        'benchmarks/benchmark_main.cc',
+        'benchmarks/box_benchmark.cc',
+        'benchmarks/codecs_benchmark.cc',
+        'benchmarks/crypto_benchmark.cc',
+        'benchmarks/manifest_benchmark.cc',
+        'benchmarks/packager_benchmark.cc',
+      ],
+      'dependencies': [
+        'base/base.gyp:base',
+        'file/file.gyp:file',
+        'hls/hls.gyp:hls_builder',
+        'libpackager',
+        'media/base/media_base.gyp:media_base',
+        'media/codecs/codecs.gyp:codecs',
+        'media/demuxer/demuxer.gyp:demuxer',
+        'media/formats/mp4/mp4.gyp:mp4',
+        'mpd/mpd.gyp:mpd_builder',
+        'third_party/gflags/gflags.gyp:gflags',
+      ],
+    },
     {
       'target_name': 'packager_test_py_copy',
       'type': 'none',
@@ -184,6 +212,20 @@
         'testing/gtest.gyp:gtest_main',
       ]
     },
+    {
+      'target_name': 'work_stealing_executor_unittest',
+      'type': '<(gtest_target_type)',
+      'sources': [
+        'app/work_stealing_executor.cc',
+        'app/work_stealing_executor.h',
+        'app/work_stealing_executor_unittest.cc',
+      ],
+      'dependencies': [
+        'base/base.gyp:base',
+        'testing/gtest.gyp:gtest',
+        'testing/gtest.gyp:gtest_main',
+      ]
+    },
     {
       'target_name': 'packager_builder_tests',
       'type': 'none',
@@ -202,10 +244,12 @@
         'media/formats/webm/webm.gyp:webm_unittest',
         'media/formats/webvtt/webvtt.gyp:webvtt_unittest',
         'media/formats/wvm/wvm.gyp:wvm_unittest',
+        'media/origin/origin.gyp:origin_unittest',
         'media/trick_play/trick_play.gyp:trick_play_unittest',
         'mpd/mpd.gyp:mpd_unittest',
         'packager_test',
         'status_unittest',
+        'work_stealing_executor_unittest',
       ],
     },
   ],
@@ -65,6 +65,25 @@ struct PackagingParams {
   /// Buffer callback params.
   BufferCallbackParams buffer_callback_params;
 
+  /// Process every stream, and every output of a stream, in its own job,
+  /// connected to the upstream handlers through a bounded queue. This allows
+  /// e.g. encryption and muxing of the different outputs from the same input
+  /// to run on separate cores.
+  bool async_pipeline = false;
+
+  /// Demux every stream selected from a local input with a demuxer of its
+  /// own, so the streams of a single input are demuxed, encrypted and muxed
+  /// in parallel. Each demuxer of a non-fragmented MP4 input only reads the
+  /// chunks of its own track. Other inputs are read once per stream.
+  bool parallel_demuxing = false;
+
+  /// Maximum number of worker threads running the packaging jobs. Every job
+  /// runs on its own thread if it is 0, which is the default. Should not be
+  /// set below the number of live inputs, e.g. UDP, as a job waiting for live
+  /// data blocks its worker. It does not apply if ad cues are specified or if
+  /// async_pipeline is set, as every job then runs on its own thread.
+  uint32_t max_num_workers = 0;
+
   // Parameters for testing. Do not use in production.
   TestParams test_params;
 };
@@ -87,6 +106,10 @@ struct StreamDescriptor {
   /// Optional value which specifies output container format, e.g. "mp4". If not
   /// specified, will detect from output / segment template name.
   std::string output_format;
+  /// Optional UDP destination, of the form udp://ip:port[?options], to which
+  /// the stream is also sent, paced in real time. Only supported for MPEG2-TS
+  /// output, in addition to the segments.
+  std::string udp_output;
   /// If set to true, the stream will not be encrypted. This is useful, e.g. to
   /// encrypt only video streams.
   bool skip_encryption = false;
@@ -7,6 +7,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <map>
+#include <mutex>
+
 #include "packager/packager.h"
 
 using testing::_;
@@ -178,6 +181,37 @@ TEST_F(PackagerTest, WriteOutputToBuffer) {
   ASSERT_EQ(Status::OK, packager.Run());
 }
 
+TEST_F(PackagerTest, ParallelDemuxingProducesSameOutput) {
+  // Runs the packager and returns the media outputs.
+  auto package = [this](bool parallel_demuxing) {
+    auto packaging_params = SetupPackagingParams();
+    packaging_params.encryption_params.key_provider = KeyProvider::kNone;
+    packaging_params.test_params.inject_fake_clock = true;
+    packaging_params.parallel_demuxing = parallel_demuxing;
+
+    std::mutex mutex;
+    std::map<std::string, std::string> outputs;
+    packaging_params.buffer_callback_params.write_func =
+        [&mutex, &outputs](const std::string& name, const void* buffer,
+                           uint64_t length) {
+          std::lock_guard<std::mutex> lock(mutex);
+          outputs[name].append(static_cast<const char*>(buffer), length);
+          return static_cast<int64_t>(length);
+        };
+
+    Packager packager;
+    EXPECT_EQ(Status::OK,
+              packager.Initialize(packaging_params, SetupStreamDescriptors()));
+    EXPECT_EQ(Status::OK, packager.Run());
+    outputs.erase(GetFullPath(kOutputMpd));
+    return outputs;
+  };
+
+  const std::map<std::string, std::string> outputs = package(false);
+  EXPECT_EQ(2u, outputs.size());
+  EXPECT_EQ(outputs, package(true));
+}
+
 TEST_F(PackagerTest, ReadFromBuffer) {
   auto packaging_params = SetupPackagingParams();
 